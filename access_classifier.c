@@ -0,0 +1,350 @@
+/************************************************************
+
+   This file contains the online access-pattern classifier.
+
+   Each table entry describes one 4KB region (64 cache lines).
+   Deltas are measured in cache lines between successive misses
+   in the region, and are counted in a histogram with the
+   following bins:
+
+      bin:    0      1       2    3    4     5       6
+      delta: <-4   -4..-2   -1    0   +1   +2..+4   >+4
+
+   A region is classified as follows, in order:
+     - pointer chasing, if most of its misses were on addresses
+       that had just been loaded as values;
+     - sequential, if the last delta is +1 or -1 and the stride
+       confidence is at least 2 (the delta repeated twice), or if
+       at least half of the deltas are +1 or -1;
+     - strided, if another non-zero delta has repeated twice;
+     - random otherwise.
+
+   When a miss is the first in a region, the region is looked up
+   in the table under its neighbors. If the region below (above)
+   holds an ascending (descending) stream, the new entry takes over
+   its delta and confidence, so streams that cross a region boundary
+   stay classified. Otherwise, a region with a single miss has no
+   pattern yet, and the miss is counted as random.
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "access_classifier.h"
+
+#define ACCESS_CLASSIFIER_LINE_SHIFT 6
+#define ACCESS_CLASSIFIER_LINES_PER_REGION (1 << (ACCESS_CLASSIFIER_REGION_SHIFT - ACCESS_CLASSIFIER_LINE_SHIFT))
+
+#define ACCESS_CLASSIFIER_NUM_DELTA_BINS 7
+#define ACCESS_CLASSIFIER_MAX_CONFIDENCE 3
+#define ACCESS_CLASSIFIER_CONFIDENT 2
+
+//Number of recently loaded values kept for pointer detection.
+#define ACCESS_CLASSIFIER_LOAD_HISTORY 8
+
+/***************************************************
+This struct defines one entry of the region table.
+  last_line: line number (within the region) of the last
+             miss. It can be outside of 0..63 when the
+             entry was seeded from a neighboring region.
+  last_delta: delta (in lines) between the last two misses.
+****************************************************/
+
+typedef struct {
+  BOOL valid;
+  uint32_t region;
+  uint32_t lru_stamp;
+  int32_t last_line;
+  int32_t last_delta;
+  BOOL has_last_line;
+  uint8_t stride_confidence;
+  uint32_t misses;
+  uint32_t pointer_misses;
+  uint32_t delta_histogram[ACCESS_CLASSIFIER_NUM_DELTA_BINS];
+} ACCESS_CLASSIFIER_ENTRY;
+
+BOOL access_classifier_enabled = FALSE;
+
+ACCESS_CLASSIFIER_ENTRY access_classifier_table[ACCESS_CLASSIFIER_TABLE_ENTRIES];
+uint32_t access_classifier_clock;
+
+uint32_t access_classifier_loads[ACCESS_CLASSIFIER_LOAD_HISTORY];
+uint32_t access_classifier_next_load;
+
+uint64_t access_classifier_misses_by_class[ACCESS_CLASSIFIER_NUM_CLASSES];
+uint64_t access_classifier_region_evictions;
+
+static const char *access_class_names[ACCESS_CLASSIFIER_NUM_CLASSES] =
+  {"unknown", "sequential", "strided", "pointer-chasing", "random"};
+
+
+/************************************************
+            access_classifier_initialize()
+
+This procedure empties the region table, clears the
+statistics and enables the classifier.
+************************************************/
+
+void access_classifier_initialize()
+{
+    for (int i = 0; i < ACCESS_CLASSIFIER_TABLE_ENTRIES; i++)
+        access_classifier_table[i].valid = FALSE;
+    for (int i = 0; i < ACCESS_CLASSIFIER_LOAD_HISTORY; i++)
+        access_classifier_loads[i] = ~0;
+    for (int i = 0; i < ACCESS_CLASSIFIER_NUM_CLASSES; i++)
+        access_classifier_misses_by_class[i] = 0;
+    access_classifier_clock = 0;
+    access_classifier_next_load = 0;
+    access_classifier_region_evictions = 0;
+    access_classifier_enabled = TRUE;
+}
+
+
+/************************************************************
+
+            access_classifier_note_load()
+
+This procedure records (the cache line of) a loaded value.
+
+************************************************************/
+
+void access_classifier_note_load(uint32_t value)
+{
+    access_classifier_loads[access_classifier_next_load] = value >> ACCESS_CLASSIFIER_LINE_SHIFT;
+    access_classifier_next_load = (access_classifier_next_load + 1) % ACCESS_CLASSIFIER_LOAD_HISTORY;
+}
+
+
+static ACCESS_CLASSIFIER_ENTRY *access_classifier_lookup(uint32_t region)
+{
+    for (int i = 0; i < ACCESS_CLASSIFIER_TABLE_ENTRIES; i++) {
+        if (access_classifier_table[i].valid && (access_classifier_table[i].region == region))
+            return &access_classifier_table[i];
+    }
+    return NULL;
+}
+
+
+static int access_classifier_delta_bin(int32_t delta)
+{
+    if (delta < -4) return 0;
+    if (delta < -1) return 1;
+    if (delta == -1) return 2;
+    if (delta == 0) return 3;
+    if (delta == 1) return 4;
+    if (delta <= 4) return 5;
+    return 6;
+}
+
+
+static uint8_t access_classifier_classify(ACCESS_CLASSIFIER_ENTRY *entry)
+{
+    uint32_t num_deltas = 0;
+    for (int bin = 0; bin < ACCESS_CLASSIFIER_NUM_DELTA_BINS; bin++)
+        num_deltas += entry->delta_histogram[bin];
+
+    if (entry->pointer_misses * 2 > entry->misses)
+        return ACCESS_CLASS_POINTER_CHASING;
+    if ((entry->stride_confidence >= ACCESS_CLASSIFIER_CONFIDENT) && (entry->last_delta != 0)) {
+        if ((entry->last_delta == 1) || (entry->last_delta == -1))
+            return ACCESS_CLASS_SEQUENTIAL;
+        return ACCESS_CLASS_STRIDED;
+    }
+    if (num_deltas == 0)
+        return ACCESS_CLASS_UNKNOWN;
+    if ((entry->delta_histogram[2] + entry->delta_histogram[4]) * 2 >= num_deltas)
+        return ACCESS_CLASS_SEQUENTIAL;
+    return ACCESS_CLASS_RANDOM;
+}
+
+
+//Allocates an entry for a region that is not in the table,
+//replacing the least recently used entry if the table is full.
+
+static ACCESS_CLASSIFIER_ENTRY *access_classifier_allocate(uint32_t region)
+{
+    ACCESS_CLASSIFIER_ENTRY *victim = &access_classifier_table[0];
+    for (int i = 0; i < ACCESS_CLASSIFIER_TABLE_ENTRIES; i++) {
+        if (!access_classifier_table[i].valid) {
+            victim = &access_classifier_table[i];
+            break;
+        }
+        if (access_classifier_table[i].lru_stamp < victim->lru_stamp)
+            victim = &access_classifier_table[i];
+    }
+    if (victim->valid)
+        access_classifier_region_evictions++;
+
+    victim->valid = TRUE;
+    victim->region = region;
+    victim->has_last_line = FALSE;
+    victim->last_delta = 0;
+    victim->stride_confidence = 0;
+    victim->misses = 0;
+    victim->pointer_misses = 0;
+    for (int bin = 0; bin < ACCESS_CLASSIFIER_NUM_DELTA_BINS; bin++)
+        victim->delta_histogram[bin] = 0;
+
+  //Continue a stream from the neighboring region, if there is one.
+
+    ACCESS_CLASSIFIER_ENTRY *below = access_classifier_lookup(region - 1);
+    ACCESS_CLASSIFIER_ENTRY *above = access_classifier_lookup(region + 1);
+    ACCESS_CLASSIFIER_ENTRY *neighbor = NULL;
+    int32_t offset = 0;
+    if (below && (below != victim) && below->has_last_line && (below->last_delta > 0) &&
+        (below->stride_confidence >= ACCESS_CLASSIFIER_CONFIDENT)) {
+        neighbor = below;
+        offset = -ACCESS_CLASSIFIER_LINES_PER_REGION;
+    }
+    else if (above && (above != victim) && above->has_last_line && (above->last_delta < 0) &&
+             (above->stride_confidence >= ACCESS_CLASSIFIER_CONFIDENT)) {
+        neighbor = above;
+        offset = ACCESS_CLASSIFIER_LINES_PER_REGION;
+    }
+    if (neighbor) {
+        victim->has_last_line = TRUE;
+        victim->last_line = neighbor->last_line + offset;
+        victim->last_delta = neighbor->last_delta;
+        victim->stride_confidence = neighbor->stride_confidence;
+    }
+    return victim;
+}
+
+
+/************************************************************
+
+            access_classifier_miss()
+
+This procedure updates the classifier with an L1 miss and
+returns the class the miss was counted as.
+
+************************************************************/
+
+uint8_t access_classifier_miss(uint32_t address)
+{
+    uint32_t region = address >> ACCESS_CLASSIFIER_REGION_SHIFT;
+    int32_t line = (address >> ACCESS_CLASSIFIER_LINE_SHIFT) & (ACCESS_CLASSIFIER_LINES_PER_REGION - 1);
+
+    ACCESS_CLASSIFIER_ENTRY *entry = access_classifier_lookup(region);
+    if (entry == NULL)
+        entry = access_classifier_allocate(region);
+    entry->lru_stamp = ++access_classifier_clock;
+    entry->misses++;
+
+  //Was the address of this miss just loaded as a value?
+
+    BOOL pointer_miss = FALSE;
+    for (int i = 0; i < ACCESS_CLASSIFIER_LOAD_HISTORY; i++) {
+        if (access_classifier_loads[i] == (address >> ACCESS_CLASSIFIER_LINE_SHIFT)) {
+            pointer_miss = TRUE;
+            break;
+        }
+    }
+    if (pointer_miss)
+        entry->pointer_misses++;
+
+  //Update the delta histogram and the stride confidence.
+
+    if (entry->has_last_line) {
+        int32_t delta = line - entry->last_line;
+        entry->delta_histogram[access_classifier_delta_bin(delta)]++;
+        if (delta == entry->last_delta) {
+            if (entry->stride_confidence < ACCESS_CLASSIFIER_MAX_CONFIDENCE)
+                entry->stride_confidence++;
+        }
+        else {
+            if (entry->stride_confidence > 0)
+                entry->stride_confidence--;
+            entry->last_delta = delta;
+        }
+    }
+    entry->last_line = line;
+    entry->has_last_line = TRUE;
+
+    uint8_t access_class = pointer_miss ? ACCESS_CLASS_POINTER_CHASING : access_classifier_classify(entry);
+    if (access_class == ACCESS_CLASS_UNKNOWN)
+        access_class = ACCESS_CLASS_RANDOM;
+    access_classifier_misses_by_class[access_class]++;
+    return access_class;
+}
+
+
+/************************************************************
+
+            access_classifier_region_class()
+
+This procedure returns the current class of a region.
+
+************************************************************/
+
+uint8_t access_classifier_region_class(uint32_t address)
+{
+    ACCESS_CLASSIFIER_ENTRY *entry = access_classifier_lookup(address >> ACCESS_CLASSIFIER_REGION_SHIFT);
+    if (entry == NULL)
+        return ACCESS_CLASS_UNKNOWN;
+    return access_classifier_classify(entry);
+}
+
+
+/************************************************************
+
+            access_classifier_class_misses()
+
+This procedure returns the number of misses of a class.
+
+************************************************************/
+
+uint64_t access_classifier_class_misses(uint8_t access_class)
+{
+    return access_classifier_misses_by_class[access_class];
+}
+
+
+/************************************************************
+
+            access_classifier_report()
+
+This procedure prints the classification of each region in
+the table and the share of the misses of each class.
+
+************************************************************/
+
+void access_classifier_report()
+{
+    uint64_t total_misses = 0;
+    for (int c = 0; c < ACCESS_CLASSIFIER_NUM_CLASSES; c++)
+        total_misses += access_classifier_misses_by_class[c];
+
+    printf("Access classifier: %llu L1 misses, %llu region replacements\n",
+           (unsigned long long) total_misses, (unsigned long long) access_classifier_region_evictions);
+    for (int c = ACCESS_CLASS_SEQUENTIAL; c < ACCESS_CLASSIFIER_NUM_CLASSES; c++) {
+        printf("  %-15s %6.2f%% of misses\n", access_class_names[c],
+               total_misses ? 100.0 * access_classifier_misses_by_class[c] / total_misses : 0.0);
+    }
+
+    printf("  Regions in the table (most recent first):\n");
+    uint32_t printed_stamp = ~0;
+    for (int n = 0; n < ACCESS_CLASSIFIER_TABLE_ENTRIES; n++) {
+
+      //find the most recent entry older than the last one printed
+
+        ACCESS_CLASSIFIER_ENTRY *next = NULL;
+        for (int i = 0; i < ACCESS_CLASSIFIER_TABLE_ENTRIES; i++) {
+            ACCESS_CLASSIFIER_ENTRY *entry = &access_classifier_table[i];
+            if (entry->valid && (entry->lru_stamp < printed_stamp) &&
+                ((next == NULL) || (entry->lru_stamp > next->lru_stamp)))
+                next = entry;
+        }
+        if (next == NULL)
+            break;
+        printed_stamp = next->lru_stamp;
+
+        printf("    0x%08x: %-15s %6u misses, last delta %+d lines, confidence %u\n",
+               next->region << ACCESS_CLASSIFIER_REGION_SHIFT,
+               access_class_names[access_classifier_classify(next)],
+               next->misses, next->last_delta, next->stride_confidence);
+    }
+}
@@ -0,0 +1,105 @@
+/************************************************************
+
+    Online access-pattern classifier.
+
+The classifier watches the stream of L1 misses and classifies each
+4KB region of memory as sequential, strided, pointer-chasing or
+random. It keeps a small table of the most recently missed regions
+(with LRU replacement). For each region, it keeps a histogram of the
+deltas between successive missed lines, the last delta and a stride
+confidence counter that is incremented when a delta repeats.
+
+Pointer chasing is detected from the data: a miss whose line
+address was returned as a value by one of the last few loads
+is a miss on a pointer that was just followed.
+
+Each miss is counted towards the class of its region at the time
+of the miss, which gives the share of the misses of each class.
+
+************************************************************/
+
+#define ACCESS_CLASS_UNKNOWN 0
+#define ACCESS_CLASS_SEQUENTIAL 1
+#define ACCESS_CLASS_STRIDED 2
+#define ACCESS_CLASS_POINTER_CHASING 3
+#define ACCESS_CLASS_RANDOM 4
+#define ACCESS_CLASSIFIER_NUM_CLASSES 5
+
+//The table holds this many regions of 4KB (2^12 bytes).
+#define ACCESS_CLASSIFIER_TABLE_ENTRIES 64
+#define ACCESS_CLASSIFIER_REGION_SHIFT 12
+
+//Set to TRUE by access_classifier_initialize().
+extern BOOL access_classifier_enabled;
+
+
+/************************************************
+            access_classifier_initialize()
+
+This procedure empties the region table, clears the
+statistics and enables the classifier.
+************************************************/
+
+void access_classifier_initialize();
+
+
+/************************************************************
+
+            access_classifier_note_load()
+
+This procedure records a value returned by a load, so that a
+subsequent miss on that address can be recognized as pointer
+chasing.
+
+************************************************************/
+
+void access_classifier_note_load(uint32_t value);
+
+
+/************************************************************
+
+            access_classifier_miss()
+
+This procedure updates the classifier with an L1 miss on the
+specified address. It returns the class the miss was counted as.
+
+************************************************************/
+
+uint8_t access_classifier_miss(uint32_t address);
+
+
+/************************************************************
+
+            access_classifier_region_class()
+
+This procedure returns the current class of the region containing
+the specified address, or ACCESS_CLASS_UNKNOWN if the region is
+not in the table.
+
+************************************************************/
+
+uint8_t access_classifier_region_class(uint32_t address);
+
+
+/************************************************************
+
+            access_classifier_class_misses()
+
+This procedure returns the number of misses counted towards
+the specified class.
+
+************************************************************/
+
+uint64_t access_classifier_class_misses(uint8_t access_class);
+
+
+/************************************************************
+
+            access_classifier_report()
+
+This procedure prints the classification of each region in the
+table and the share of the misses of each class.
+
+************************************************************/
+
+void access_classifier_report();
@@ -0,0 +1,132 @@
+/************************************************************
+
+   This file contains the checkpoints of the memory subsystem
+   (see checkpoint.h).
+
+   A checkpoint file is a CHECKPOINT_HEADER, followed by the L1
+   entries, the L2 sets and the pages of main memory it holds,
+   in the format of l1_write_changes(), l2_write_changes() and
+   main_memory_write_changes().
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "memory_subsystem_constants.h"
+#include "main_memory.h"
+#include "l1_cache.h"
+#include "l2_cache.h"
+#include "store_buffer.h"
+#include "compressed_memory.h"
+#include "ship.h"
+#include "prefetch.h"
+#include "memory_subsystem.h"
+#include "checkpoint.h"
+
+extern uint32_t num_l1_misses;
+extern uint32_t num_l2_misses;
+extern uint32_t main_memory_size_in_bytes;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t chain;             //identifies the chain
+  uint32_t sequence;          //position in the chain, 0 if full
+  uint32_t memory_size_in_bytes;
+  uint32_t num_l1_misses;
+  uint32_t num_l2_misses;
+  uint64_t memory_cycles;
+} CHECKPOINT_HEADER;
+
+//The current chain, and the position of its next checkpoint
+//(0 if no chain has been started).
+uint32_t checkpoint_chain;
+uint32_t checkpoint_next_sequence = 0;
+uint32_t checkpoint_chains_started = 0;
+
+
+uint32_t checkpoint_write(FILE *file, BOOL full)
+{
+    if (!full && (checkpoint_next_sequence == 0)) {
+        printf("Error: a delta checkpoint needs a previous checkpoint\n");
+        exit(1);
+    }
+    if (store_buffer_enabled)
+        store_buffer_drain();
+    if (full)
+        checkpoint_chain = ((uint32_t) time(NULL) << 8) + ++checkpoint_chains_started;
+
+    CHECKPOINT_HEADER header = {CHECKPOINT_MAGIC, CHECKPOINT_VERSION, checkpoint_chain,
+                                full ? 0 : checkpoint_next_sequence, main_memory_size_in_bytes,
+                                num_l1_misses, num_l2_misses, memory_cycles};
+    fwrite(&header, sizeof(header), 1, file);
+    l1_write_changes(file, full);
+    l2_write_changes(file, full);
+    main_memory_write_changes(file, full);
+    if (ferror(file)) {
+        printf("Error: could not write the checkpoint\n");
+        exit(1);
+    }
+
+  //The next delta starts from here.
+
+    l1_clear_changes();
+    l2_clear_changes();
+    main_memory_clear_changes();
+    checkpoint_next_sequence = header.sequence + 1;
+    return header.sequence;
+}
+
+
+void checkpoint_restore(FILE *files[], int num_files)
+{
+    CHECKPOINT_HEADER header;
+    uint32_t chain = 0;
+
+    for (int i = 0; i < num_files; i++) {
+        if ((fread(&header, sizeof(header), 1, files[i]) != 1) ||
+            (header.magic != CHECKPOINT_MAGIC) || (header.version != CHECKPOINT_VERSION)) {
+            printf("Error: not a checkpoint file\n");
+            exit(1);
+        }
+        if ((header.sequence != (uint32_t) i) || (i && (header.chain != chain))) {
+            printf("Error: checkpoint %d is number %u of %s chain\n", i, header.sequence,
+                   (i && (header.chain != chain)) ? "another" : "its");
+            exit(1);
+        }
+        chain = header.chain;
+        if (header.memory_size_in_bytes != main_memory_size_in_bytes) {
+            printf("Error: the checkpoint is of a %u-byte memory\n", header.memory_size_in_bytes);
+            exit(1);
+        }
+        l1_read_changes(files[i]);
+        l2_read_changes(files[i]);
+        main_memory_read_changes(files[i], i == 0);
+    }
+    if (num_files == 0)
+        return;
+
+    num_l1_misses = header.num_l1_misses;
+    num_l2_misses = header.num_l2_misses;
+    memory_cycles = header.memory_cycles;
+    if (store_buffer_enabled)
+        store_buffer_initialize(store_buffer_entries);
+    if (l1i_enabled)
+        l1i_clear();
+    if (ship_enabled)
+        ship_clear_lines();
+    if (prefetch_enabled)
+        prefetch_clear();
+    if (compressed_memory_enabled)
+        compressed_memory_initialize(main_memory_size_in_bytes, compressed_memory_pool_size_in_bytes,
+                                     compressed_memory_inactive_epochs, compressed_memory_epoch_length);
+
+    l1_clear_changes();
+    l2_clear_changes();
+    main_memory_clear_changes();
+    checkpoint_chain = chain;
+    checkpoint_next_sequence = header.sequence + 1;
+}
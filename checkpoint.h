@@ -0,0 +1,64 @@
+/************************************************************
+
+    Incremental checkpoints of the memory subsystem.
+
+A checkpoint holds the contents of the L1 cache, the L2 cache and
+main memory, along with the miss counters and memory_cycles. The
+first checkpoint of a chain is a full checkpoint; each following
+one is a delta that only holds the L1 entries, L2 sets and pages of
+main memory (MAIN_MEMORY_PAGE_SIZE bytes, see main_memory.h)
+changed since the previous checkpoint of the chain, so that writing
+it takes time proportional to what changed rather than to the size
+of the caches and memory. A full checkpoint leaves out pages of
+main memory that are all zeros. Changes are only tracked once a
+checkpoint has been written or restored, so that a simulation that
+takes none doesn't pay for them, and an L1 write hit is never
+tracked: a delta holds every dirty L1 entry instead.
+
+The state at any checkpoint of a chain is reconstructed by
+restoring the full checkpoint, followed by each delta up to it, in
+order. The chain can then be continued from that point, e.g. to
+run several trace segments from the same warmed state.
+
+Only the caches, main memory and the counters are checkpointed. The
+state of the optional features (prefetchers, dead-block prediction,
+SHiP, the working set, page map, access classifier, memory channels
+and tiers) is not, and neither is the L1 instruction cache, which is
+emptied on a restore, or the compressed memory tier, whose pages are
+all left uncompressed on a restore.
+Pending stores are drained from the store buffer before a
+checkpoint is written.
+
+************************************************************/
+
+#define CHECKPOINT_MAGIC 0x4b505043    //"CPPK"
+#define CHECKPOINT_VERSION 2
+
+
+/************************************************
+
+       checkpoint_write()
+
+This procedure writes a checkpoint of the memory subsystem to the
+specified file: a full checkpoint, which starts a new chain, if
+full is TRUE, or else a delta from the previous checkpoint written
+or restored. It returns the position of the checkpoint in its
+chain (0 for the full checkpoint).
+
+***********************************************/
+
+uint32_t checkpoint_write(FILE *file, BOOL full);
+
+
+/************************************************
+
+       checkpoint_restore()
+
+This procedure restores the state at the last of the specified
+checkpoint files, which must be a full checkpoint followed by the
+deltas of its chain, in order, and of a memory of the current size.
+Following calls to checkpoint_write() continue the chain from there.
+
+***********************************************/
+
+void checkpoint_restore(FILE *files[], int num_files);
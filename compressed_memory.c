@@ -0,0 +1,200 @@
+/************************************************************
+
+   This file contains the compressed memory tier
+   (see compressed_memory.h).
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "lz.h"
+#include "main_memory.h"
+#include "compressed_memory.h"
+
+BOOL compressed_memory_enabled = FALSE;
+uint32_t compressed_memory_pool_size_in_bytes;
+uint32_t compressed_memory_inactive_epochs;
+uint32_t compressed_memory_epoch_length;
+
+//Per page: the epoch of its last access plus 1 (0 if it has never
+//been accessed), and its compressed data (NULL if it is not
+//compressed) and size.
+uint32_t compressed_memory_num_pages;
+uint32_t *compressed_memory_last_access;
+uint8_t **compressed_memory_data;
+uint16_t *compressed_memory_size;
+
+uint32_t compressed_memory_epoch;
+uint32_t compressed_memory_epoch_accesses;
+
+//The pages currently compressed, and the bytes they take in the pool.
+uint32_t compressed_memory_pages;
+uint64_t compressed_memory_pool_bytes;
+
+uint64_t compressed_memory_compressions;
+uint64_t compressed_memory_incompressible;
+uint64_t compressed_memory_decompressions;
+uint64_t compressed_memory_bytes_in;
+uint64_t compressed_memory_bytes_out;
+
+
+void compressed_memory_initialize(uint32_t memory_size_in_bytes, uint32_t pool_size_in_bytes,
+				  uint32_t inactive_epochs, uint32_t epoch_length)
+{
+    if ((inactive_epochs == 0) || (epoch_length == 0)) {
+        printf("Error: the inactivity and the epoch length must not be 0\n");
+        exit(1);
+    }
+    for (uint32_t page = 0; page < compressed_memory_num_pages; page++)
+        free(compressed_memory_data[page]);
+    free(compressed_memory_last_access);
+    free(compressed_memory_data);
+    free(compressed_memory_size);
+
+    compressed_memory_pool_size_in_bytes = pool_size_in_bytes;
+    compressed_memory_inactive_epochs = inactive_epochs;
+    compressed_memory_epoch_length = epoch_length;
+    compressed_memory_num_pages = (memory_size_in_bytes + COMPRESSED_MEMORY_PAGE_SIZE - 1) >> COMPRESSED_MEMORY_PAGE_SHIFT;
+    compressed_memory_last_access = calloc(compressed_memory_num_pages, sizeof(uint32_t));
+    compressed_memory_data = calloc(compressed_memory_num_pages, sizeof(uint8_t *));
+    compressed_memory_size = calloc(compressed_memory_num_pages, sizeof(uint16_t));
+
+    compressed_memory_epoch = 0;
+    compressed_memory_epoch_accesses = 0;
+    compressed_memory_pages = 0;
+    compressed_memory_pool_bytes = 0;
+    compressed_memory_compressions = 0;
+    compressed_memory_incompressible = 0;
+    compressed_memory_decompressions = 0;
+    compressed_memory_bytes_in = 0;
+    compressed_memory_bytes_out = 0;
+    compressed_memory_enabled = TRUE;
+}
+
+
+BOOL compressed_memory_is_compressed(uint32_t address)
+{
+    uint32_t page = address >> COMPRESSED_MEMORY_PAGE_SHIFT;
+    return (page < compressed_memory_num_pages) && (compressed_memory_data[page] != NULL);
+}
+
+
+//Compresses a page into the pool, if it compresses well enough
+//and there is room. Returns FALSE if the pool is full.
+
+static BOOL compressed_memory_compress(uint32_t page)
+{
+    static uint32_t contents[COMPRESSED_MEMORY_PAGE_SIZE / 4];
+    static uint8_t buffer[COMPRESSED_MEMORY_PAGE_SIZE];
+    uint32_t capacity = (uint32_t) (COMPRESSED_MEMORY_PAGE_SIZE * COMPRESSED_MEMORY_MAX_RATIO);
+
+    main_memory_read_page(page, contents);
+    uint32_t size = lz_compress((uint8_t *) contents, COMPRESSED_MEMORY_PAGE_SIZE, buffer, capacity);
+
+  //A page that does not compress well enough is not tried
+  //again until it has been inactive for as long again.
+
+    if (size == 0) {
+        compressed_memory_incompressible++;
+        compressed_memory_last_access[page] = compressed_memory_epoch + 1;
+        return TRUE;
+    }
+    if (compressed_memory_pool_bytes + size > compressed_memory_pool_size_in_bytes)
+        return FALSE;
+    compressed_memory_data[page] = malloc(size);
+    memcpy(compressed_memory_data[page], buffer, size);
+    compressed_memory_size[page] = size;
+    compressed_memory_pages++;
+    compressed_memory_pool_bytes += size;
+    compressed_memory_compressions++;
+    compressed_memory_bytes_in += COMPRESSED_MEMORY_PAGE_SIZE;
+    compressed_memory_bytes_out += size;
+    return TRUE;
+}
+
+
+//Rebuilds the contents of a compressed page from its compressed
+//data, and frees its space in the pool.
+
+static void compressed_memory_decompress(uint32_t page)
+{
+    static uint32_t contents[COMPRESSED_MEMORY_PAGE_SIZE / 4];
+
+    if (lz_decompress(compressed_memory_data[page], compressed_memory_size[page], (uint8_t *) contents,
+                      COMPRESSED_MEMORY_PAGE_SIZE) != COMPRESSED_MEMORY_PAGE_SIZE) {
+        printf("Error: compressed page %u is corrupt\n", page);
+        exit(1);
+    }
+    main_memory_write_page(page, contents);
+    free(compressed_memory_data[page]);
+    compressed_memory_data[page] = NULL;
+    compressed_memory_pages--;
+    compressed_memory_pool_bytes -= compressed_memory_size[page];
+    compressed_memory_decompressions++;
+}
+
+
+//Ends the epoch: the pages accessed, but not during the last
+//inactive_epochs epochs, are compressed.
+
+static void compressed_memory_end_epoch()
+{
+    compressed_memory_epoch++;
+    compressed_memory_epoch_accesses = 0;
+    if (compressed_memory_epoch < compressed_memory_inactive_epochs)
+        return;
+
+    uint32_t inactive_since = compressed_memory_epoch - compressed_memory_inactive_epochs;
+    for (uint32_t page = 0; page < compressed_memory_num_pages; page++) {
+        uint32_t last_access = compressed_memory_last_access[page];
+        if (last_access && (last_access - 1 < inactive_since) && (compressed_memory_data[page] == NULL)) {
+            if (!compressed_memory_compress(page))
+                return;
+        }
+    }
+}
+
+
+uint32_t compressed_memory_access(uint32_t address, uint8_t control)
+{
+    uint32_t page = address >> COMPRESSED_MEMORY_PAGE_SHIFT;
+    uint32_t delay = 0;
+
+    if (page >= compressed_memory_num_pages)
+        return 0;
+    if (compressed_memory_data[page]) {
+        compressed_memory_decompress(page);
+        if (control & READ_ENABLE_MASK)
+            delay = COMPRESSED_MEMORY_DECOMPRESS_LATENCY;
+    }
+    compressed_memory_last_access[page] = compressed_memory_epoch + 1;
+    if (++compressed_memory_epoch_accesses == compressed_memory_epoch_length)
+        compressed_memory_end_epoch();
+    return delay;
+}
+
+
+uint64_t compressed_memory_saved()
+{
+    return (uint64_t) compressed_memory_pages * COMPRESSED_MEMORY_PAGE_SIZE - compressed_memory_pool_bytes;
+}
+
+
+void compressed_memory_report()
+{
+    printf("Compressed memory: %u pages (%llu KB) compressed into %llu KB of a %u KB pool, %llu KB saved\n",
+           compressed_memory_pages,
+           (unsigned long long) compressed_memory_pages * COMPRESSED_MEMORY_PAGE_SIZE >> 10,
+           (unsigned long long) compressed_memory_pool_bytes >> 10, compressed_memory_pool_size_in_bytes >> 10,
+           (unsigned long long) compressed_memory_saved() >> 10);
+    printf("  %llu compressions, compression ratio = %.2f, %llu pages did not compress, %llu decompressions\n",
+           (unsigned long long) compressed_memory_compressions,
+           compressed_memory_bytes_out ? (double) compressed_memory_bytes_in / compressed_memory_bytes_out : 0.0,
+           (unsigned long long) compressed_memory_incompressible,
+           (unsigned long long) compressed_memory_decompressions);
+}
@@ -0,0 +1,91 @@
+/************************************************************
+
+    Compressed memory tier, in the style of zswap.
+
+Main memory is divided into pages of COMPRESSED_MEMORY_PAGE_SIZE
+bytes. Time is divided into epochs of epoch_length main memory
+accesses (cache line reads and writes). At the end of each epoch,
+the pages that have not been accessed for inactive_epochs epochs are
+compressed with the LZ codec (see lz.h), on their actual contents,
+into a compressed pool of at most pool_size_in_bytes bytes. A page
+that does not compress to COMPRESSED_MEMORY_MAX_RATIO of its size
+or less is left uncompressed.
+
+The next access to a compressed page decompresses it: its contents
+are rebuilt from the compressed data, and its space in the pool is
+freed. With the latency model (see memory_subsystem.h), a read of a
+compressed page takes COMPRESSED_MEMORY_DECOMPRESS_LATENCY more
+cycles. Compression itself is done in the background, and write-backs
+don't delay the access that caused them.
+
+************************************************************/
+
+#define COMPRESSED_MEMORY_PAGE_SHIFT 12
+#define COMPRESSED_MEMORY_PAGE_SIZE (1 << COMPRESSED_MEMORY_PAGE_SHIFT)
+
+//Pages must compress to 3/4 of their size or less.
+#define COMPRESSED_MEMORY_MAX_RATIO 0.75
+
+#define COMPRESSED_MEMORY_DECOMPRESS_LATENCY 2000
+
+//Set by compressed_memory_initialize().
+extern BOOL compressed_memory_enabled;
+extern uint32_t compressed_memory_pool_size_in_bytes;
+extern uint32_t compressed_memory_inactive_epochs;
+extern uint32_t compressed_memory_epoch_length;
+
+
+/************************************************
+
+       compressed_memory_initialize()
+
+This procedure frees the compressed pages of a main memory of
+memory_size_in_bytes bytes (their contents are still in main memory),
+sets the parameters, clears the statistics and enables compression.
+
+***********************************************/
+
+void compressed_memory_initialize(uint32_t memory_size_in_bytes, uint32_t pool_size_in_bytes,
+				  uint32_t inactive_epochs, uint32_t epoch_length);
+
+
+/************************************************
+
+       compressed_memory_access()
+
+This procedure is called for every cache line read from
+(control = READ_ENABLE_MASK) or written to main memory, before the
+line is accessed. It decompresses the page if it is compressed,
+and returns the cycles a read takes beyond MAIN_MEMORY_LATENCY.
+
+***********************************************/
+
+uint32_t compressed_memory_access(uint32_t address, uint8_t control);
+
+
+/************************************************
+
+       compressed_memory_is_compressed()
+
+This procedure returns TRUE if the page containing the specified
+address is compressed.
+
+***********************************************/
+
+BOOL compressed_memory_is_compressed(uint32_t address);
+
+
+/************************************************
+
+       compressed_memory_saved(), compressed_memory_report()
+
+compressed_memory_saved() returns the number of bytes of memory
+currently saved by compression: the size of the compressed pages
+less the size of their compressed data. compressed_memory_report()
+prints the pages compressed and decompressed, the pages that did
+not compress well enough, the compression ratio and the memory saved.
+
+***********************************************/
+
+uint64_t compressed_memory_saved();
+void compressed_memory_report();
@@ -0,0 +1,206 @@
+/************************************************************
+
+   This file contains the sampling dead-block predictor (see
+   dead_block.h).
+
+   Since a line predicted dead is bypassed or evicted first from
+   the L2 cache, the sampler only keeps one in DEAD_BLOCK_DEAD_SAMPLING
+   of the lines predicted dead (the others would otherwise push out
+   lines that are actually reused). Those are enough to notice when
+   a signature stops being dead.
+
+   The accuracy of the predictor is measured on the sampler:
+   when a sampler entry whose last access was predicted dead is
+   hit, the prediction was wrong, and when it is evicted, the
+   prediction was right. The coverage is the fraction of the lines
+   evicted from the sampler without reuse that were predicted dead,
+   counting each sampled dead prediction DEAD_BLOCK_DEAD_SAMPLING
+   times.
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "l2_cache.h"
+#include "memory_request.h"
+#include "dead_block.h"
+
+//The sampler models every (L2_NUM_CACHE_SETS / DEAD_BLOCK_SAMPLER_SETS)th set.
+#define DEAD_BLOCK_SAMPLER_STRIDE (L2_NUM_CACHE_SETS / DEAD_BLOCK_SAMPLER_SETS)
+
+#define DEAD_BLOCK_COUNTER_MAX 3
+
+#define DEAD_BLOCK_DEAD_SAMPLING 16
+
+/***************************************************
+This struct defines an entry of the sampler. It has
+the following fields:
+  line: the line address (address / 64).
+  signature: the signature of the last access.
+  predicted_dead: the prediction made for the last access.
+  last_use: for LRU replacement.
+****************************************************/
+
+typedef struct {
+  BOOL valid;
+  uint32_t line;
+  uint16_t signature;
+  BOOL predicted_dead;
+  uint64_t last_use;
+} DEAD_BLOCK_SAMPLER_ENTRY;
+
+DEAD_BLOCK_SAMPLER_ENTRY dead_block_sampler[DEAD_BLOCK_SAMPLER_SETS][L2_LINES_PER_SET];
+uint8_t dead_block_counters[DEAD_BLOCK_TABLE_ENTRIES];
+uint64_t dead_block_time;
+uint32_t dead_block_dead_misses;
+
+BOOL dead_block_enabled = FALSE;
+uint8_t dead_block_mode;
+
+uint64_t dead_block_fills;
+uint64_t dead_block_fills_predicted_dead;
+uint64_t dead_block_correct;
+uint64_t dead_block_wrong;
+uint64_t dead_block_dead_evictions;
+
+
+void dead_block_initialize(uint8_t mode)
+{
+    for (int set = 0; set < DEAD_BLOCK_SAMPLER_SETS; set++) {
+        for (int way = 0; way < L2_LINES_PER_SET; way++)
+            dead_block_sampler[set][way].valid = FALSE;
+    }
+    for (int i = 0; i < DEAD_BLOCK_TABLE_ENTRIES; i++)
+        dead_block_counters[i] = 0;
+    dead_block_time = 0;
+    dead_block_dead_misses = 0;
+
+    dead_block_fills = 0;
+    dead_block_fills_predicted_dead = 0;
+    dead_block_correct = 0;
+    dead_block_wrong = 0;
+    dead_block_dead_evictions = 0;
+
+    dead_block_mode = mode;
+    dead_block_enabled = TRUE;
+}
+
+
+static uint16_t dead_block_signature(uint32_t address, const MEMORY_REQUEST_INFO *info)
+{
+    uint32_t key = (info && info->pc) ? info->pc >> 2 : address >> DEAD_BLOCK_REGION_SHIFT;
+    return ((key * 0x9e3779b1) >> 16) % DEAD_BLOCK_TABLE_ENTRIES;
+}
+
+
+/************************************************
+
+       dead_block_access()
+
+This procedure trains the predictor with a demand read of the
+L2 cache and returns the prediction for it.
+
+***********************************************/
+
+BOOL dead_block_access(uint32_t address, const MEMORY_REQUEST_INFO *info)
+{
+    uint16_t signature = dead_block_signature(address, info);
+    BOOL predicted_dead = dead_block_counters[signature] >= DEAD_BLOCK_THRESHOLD;
+
+    uint32_t set_index = (address / BYTES_PER_CACHE_LINE) % L2_NUM_CACHE_SETS;
+    if (set_index % DEAD_BLOCK_SAMPLER_STRIDE)
+        return predicted_dead;
+
+    DEAD_BLOCK_SAMPLER_ENTRY *set = dead_block_sampler[set_index / DEAD_BLOCK_SAMPLER_STRIDE];
+    uint32_t line = address / BYTES_PER_CACHE_LINE;
+    DEAD_BLOCK_SAMPLER_ENTRY *entry = NULL;
+    dead_block_time++;
+
+    for (int way = 0; way < L2_LINES_PER_SET; way++) {
+        if (set[way].valid && (set[way].line == line)) {
+            entry = &set[way];
+            break;
+        }
+    }
+
+    if (entry) {
+
+      //The previous access to the line was not the last one.
+
+        if (entry->predicted_dead)
+            dead_block_wrong++;
+        if (dead_block_counters[entry->signature] > 0)
+            dead_block_counters[entry->signature]--;
+    }
+    else {
+        if (predicted_dead && (dead_block_dead_misses++ % DEAD_BLOCK_DEAD_SAMPLING))
+            return predicted_dead;
+
+      //Replace the least recently used entry, whose last access
+      //was the last one before its eviction.
+
+        entry = &set[0];
+        for (int way = 0; way < L2_LINES_PER_SET; way++) {
+            if (!set[way].valid) {
+                entry = &set[way];
+                break;
+            }
+            if (set[way].last_use < entry->last_use)
+                entry = &set[way];
+        }
+        if (entry->valid) {
+            if (entry->predicted_dead) {
+                dead_block_correct++;
+                dead_block_dead_evictions += DEAD_BLOCK_DEAD_SAMPLING;
+            }
+            else {
+                dead_block_dead_evictions++;
+            }
+            if (dead_block_counters[entry->signature] < DEAD_BLOCK_COUNTER_MAX)
+                dead_block_counters[entry->signature]++;
+        }
+        entry->valid = TRUE;
+        entry->line = line;
+    }
+
+    entry->signature = signature;
+    entry->predicted_dead = predicted_dead;
+    entry->last_use = dead_block_time;
+    return predicted_dead;
+}
+
+
+void dead_block_note_fill(BOOL predicted_dead)
+{
+    dead_block_fills++;
+    if (predicted_dead)
+        dead_block_fills_predicted_dead++;
+}
+
+
+/************************************************
+
+       dead_block_report()
+
+This procedure prints the dead-block prediction statistics.
+
+***********************************************/
+
+void dead_block_report()
+{
+    uint64_t predictions = dead_block_correct + dead_block_wrong;
+
+    printf("Dead-block prediction (%s): %llu of %llu L2 fills predicted dead\n",
+           dead_block_mode == DEAD_BLOCK_BYPASS ? "bypass" : "low-priority insertion",
+           (unsigned long long) dead_block_fills_predicted_dead, (unsigned long long) dead_block_fills);
+    printf("  on the %d sampled sets: accuracy = %.4f (%llu of %llu dead predictions), "
+           "coverage = %.4f (of an estimated %llu dead lines)\n",
+           DEAD_BLOCK_SAMPLER_SETS,
+           predictions ? (double) dead_block_correct / predictions : 0.0,
+           (unsigned long long) dead_block_correct, (unsigned long long) predictions,
+           dead_block_dead_evictions ? (double) dead_block_correct * DEAD_BLOCK_DEAD_SAMPLING / dead_block_dead_evictions : 0.0,
+           (unsigned long long) dead_block_dead_evictions);
+}
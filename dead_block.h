@@ -0,0 +1,93 @@
+/************************************************************
+
+    Sampling dead-block predictor for the L2 cache.
+
+A line is dead from its last access until it is evicted. The
+predictor learns, for each signature, whether an access with that
+signature tends to be the last access to its line. The signature of
+an access is the region of memory (of 2^DEAD_BLOCK_REGION_SHIFT
+bytes) it falls in, hashed into a table of 2-bit saturating counters.
+
+The predictor is trained by a sampler: a separate tag array that
+models DEAD_BLOCK_SAMPLER_SETS sets of the L2 cache (with LRU
+replacement), independently of what the L2 cache actually does
+with predicted-dead lines. Each sampler entry remembers the
+signature of the last access to its line. When an entry is hit, the
+counter of that signature is decremented (the access was not the
+last one), and when an entry is evicted without a further access,
+it is incremented.
+
+An access is predicted to be the last one to its line if the counter
+of its signature is at least DEAD_BLOCK_THRESHOLD. A line predicted
+dead is marked in the L2 cache (see l2_set_dead()), so that it is
+evicted first. A fill predicted dead either bypasses the L2 cache
+(DEAD_BLOCK_BYPASS) or is inserted marked dead, i.e. at the lowest
+priority (DEAD_BLOCK_LOW_PRIORITY).
+
+************************************************************/
+
+//What to do with a fill predicted dead.
+#define DEAD_BLOCK_LOW_PRIORITY 0
+#define DEAD_BLOCK_BYPASS 1
+
+#define DEAD_BLOCK_SAMPLER_SETS 64
+#define DEAD_BLOCK_TABLE_ENTRIES 4096
+#define DEAD_BLOCK_THRESHOLD 2
+#define DEAD_BLOCK_REGION_SHIFT 16
+
+//Set to TRUE by dead_block_initialize().
+extern BOOL dead_block_enabled;
+extern uint8_t dead_block_mode;
+
+
+/************************************************
+
+       dead_block_initialize()
+
+This procedure clears the sampler, the counters and the
+statistics, and enables the predictor with the specified
+mode (DEAD_BLOCK_LOW_PRIORITY or DEAD_BLOCK_BYPASS).
+
+***********************************************/
+
+void dead_block_initialize(uint8_t mode);
+
+
+/************************************************
+
+       dead_block_access()
+
+This procedure is called on each demand read of the L2 cache. It
+trains the predictor (if the address falls in a sampled set) and
+returns TRUE if the access is predicted to be the last one to its
+line. If the request carries a PC (see memory_request.h), the PC is
+used as the signature instead of the memory region.
+
+***********************************************/
+
+BOOL dead_block_access(uint32_t address, const MEMORY_REQUEST_INFO *info);
+
+
+/************************************************
+
+       dead_block_note_fill()
+
+This procedure is called on each fill of the L2 cache on a demand
+read, with whether it was predicted dead, for the statistics.
+
+***********************************************/
+
+void dead_block_note_fill(BOOL predicted_dead);
+
+
+/************************************************
+
+       dead_block_report()
+
+This procedure prints the number of fills predicted dead and
+the accuracy and coverage of the predictions, as measured on
+the sampled sets.
+
+***********************************************/
+
+void dead_block_report();
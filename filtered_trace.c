@@ -0,0 +1,188 @@
+/************************************************************
+
+   This file contains the L1-filtered traces (see filtered_trace.h).
+
+   An event is replayed with the same procedures of
+   memory_subsystem.c that handle it in a full simulation, short of
+   the L1 side, so that the L2 side behaves exactly as it did.
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "l1i_cache.h"
+#include "filtered_trace.h"
+
+//These are defined in memory_subsystem.c. They handle the L2 side
+//of an L1 miss, a write-back from L1, a software prefetch into L2
+//and an evict hint.
+void memory_read_l2_line(uint32_t address, BOOL software_prefetch,
+			 const MEMORY_REQUEST_INFO *info, uint32_t read_data[]);
+void memory_write_back_l1_line(uint32_t address, uint32_t data[]);
+void memory_prefetch_into_l2(uint32_t address);
+void memory_evict_from_l2(uint32_t address, uint32_t l1_data[]);
+
+extern uint32_t num_l1_misses;
+extern uint32_t main_memory_size_in_bytes;
+
+typedef struct {
+  uint32_t magic;
+  uint32_t version;
+  uint32_t memory_size_in_bytes;
+} FILTERED_TRACE_HEADER;
+
+BOOL filtered_trace_recording = FALSE;
+uint64_t filtered_trace_events;
+
+//The trace being recorded.
+FILE *filtered_trace_file;
+
+//The trace being replayed is read a block at a time, rather than
+//with a call to fread() for each word or line, which would take
+//longer than performing most events.
+#define FILTERED_TRACE_BLOCK_WORDS 16384
+uint32_t filtered_trace_block[FILTERED_TRACE_BLOCK_WORDS];
+uint32_t filtered_trace_block_next;
+uint32_t filtered_trace_block_words;
+
+
+void filtered_trace_start(FILE *trace)
+{
+    FILTERED_TRACE_HEADER header = {FILTERED_TRACE_MAGIC, FILTERED_TRACE_VERSION, main_memory_size_in_bytes};
+
+    fwrite(&header, sizeof(header), 1, trace);
+    filtered_trace_file = trace;
+    filtered_trace_events = 0;
+    filtered_trace_recording = TRUE;
+}
+
+
+uint64_t filtered_trace_finish()
+{
+    filtered_trace_recording = FALSE;
+    if (fflush(filtered_trace_file) || ferror(filtered_trace_file)) {
+        printf("Error: could not write the filtered trace\n");
+        exit(1);
+    }
+    return filtered_trace_events;
+}
+
+
+void filtered_trace_note(uint8_t kind, uint32_t address, const MEMORY_REQUEST_INFO *info,
+			 const uint32_t data[])
+{
+    uint32_t event = (address & ~(BYTES_PER_CACHE_LINE - 1)) | kind;
+
+  //An instruction fetch is only told apart when it goes to the L1I,
+  //since it is otherwise an L1 miss like any other.
+
+    if (info && info->pc)
+        event |= FILTERED_TRACE_PC_FLAG;
+    if (info && l1i_enabled && (info->access_type == MEMORY_ACCESS_INSTRUCTION))
+        event |= FILTERED_TRACE_INSTRUCTION_FLAG;
+    if (data)
+        event |= FILTERED_TRACE_DATA_FLAG;
+
+    fwrite(&event, sizeof(event), 1, filtered_trace_file);
+    if (event & FILTERED_TRACE_PC_FLAG)
+        fwrite(&info->pc, sizeof(info->pc), 1, filtered_trace_file);
+    if (data)
+        fwrite(data, sizeof(uint32_t), WORDS_PER_CACHE_LINE, filtered_trace_file);
+    filtered_trace_events++;
+}
+
+
+//Reads the specified number of words of the trace being replayed,
+//and returns FALSE if it ends first.
+
+static BOOL filtered_trace_read(FILE *trace, uint32_t words[], uint32_t num_words)
+{
+    for (uint32_t i = 0; i < num_words; i++) {
+        if (filtered_trace_block_next == filtered_trace_block_words) {
+            filtered_trace_block_words = fread(filtered_trace_block, sizeof(uint32_t),
+                                               FILTERED_TRACE_BLOCK_WORDS, trace);
+            filtered_trace_block_next = 0;
+            if (filtered_trace_block_words == 0)
+                return FALSE;
+        }
+        words[i] = filtered_trace_block[filtered_trace_block_next++];
+    }
+    return TRUE;
+}
+
+
+uint64_t filtered_trace_replay(FILE *trace)
+{
+    FILTERED_TRACE_HEADER header;
+    uint32_t event;
+    uint32_t data[WORDS_PER_CACHE_LINE];
+    uint32_t read_data[WORDS_PER_CACHE_LINE];
+    MEMORY_REQUEST_INFO info = {0, 0, MEMORY_ACCESS_DATA, 0};
+    BOOL cut_short = FALSE;
+
+    if (filtered_trace_recording) {
+        printf("Error: a filtered trace cannot be replayed while one is recorded\n");
+        exit(1);
+    }
+    if ((fread(&header, sizeof(header), 1, trace) != 1) ||
+        (header.magic != FILTERED_TRACE_MAGIC) || (header.version != FILTERED_TRACE_VERSION)) {
+        printf("Error: not a filtered trace\n");
+        exit(1);
+    }
+    if (header.memory_size_in_bytes != main_memory_size_in_bytes) {
+        printf("Error: the filtered trace is of a %u-byte memory\n", header.memory_size_in_bytes);
+        exit(1);
+    }
+
+    filtered_trace_events = 0;
+    filtered_trace_block_next = 0;
+    filtered_trace_block_words = 0;
+    while (filtered_trace_read(trace, &event, 1)) {
+        uint32_t address = event & ~(BYTES_PER_CACHE_LINE - 1);
+        info.pc = 0;
+        if (((event & FILTERED_TRACE_PC_FLAG) && !filtered_trace_read(trace, &info.pc, 1)) ||
+            ((event & FILTERED_TRACE_DATA_FLAG) && !filtered_trace_read(trace, data, WORDS_PER_CACHE_LINE))) {
+            cut_short = TRUE;
+            break;
+        }
+        info.access_type = (event & FILTERED_TRACE_INSTRUCTION_FLAG) ? MEMORY_ACCESS_INSTRUCTION : MEMORY_ACCESS_DATA;
+
+        switch (event & FILTERED_TRACE_KIND_MASK) {
+        case FILTERED_TRACE_FILL:
+            if (!(event & FILTERED_TRACE_INSTRUCTION_FLAG))
+                num_l1_misses += 1;
+            memory_read_l2_line(address, FALSE, (event & FILTERED_TRACE_PC_FLAG) ? &info : NULL, read_data);
+            break;
+        case FILTERED_TRACE_SW_PREFETCH_L1:
+            memory_read_l2_line(address, TRUE, NULL, read_data);
+            break;
+        case FILTERED_TRACE_SW_PREFETCH_L2:
+            memory_prefetch_into_l2(address);
+            break;
+        case FILTERED_TRACE_WRITEBACK:
+            memory_write_back_l1_line(address, data);
+            break;
+        case FILTERED_TRACE_EVICT:
+            memory_evict_from_l2(address, (event & FILTERED_TRACE_DATA_FLAG) ? data : NULL);
+            break;
+        case FILTERED_TRACE_CLOCK:
+            memory_handle_clock_interrupt();
+            break;
+        default:
+            printf("Error: event %llu of the filtered trace is of unknown kind %u\n",
+                   (unsigned long long) filtered_trace_events, event & FILTERED_TRACE_KIND_MASK);
+            exit(1);
+        }
+        filtered_trace_events++;
+    }
+    if (cut_short || ferror(trace)) {
+        printf("Error: the filtered trace is cut short after %llu events\n",
+               (unsigned long long) filtered_trace_events);
+        exit(1);
+    }
+    return filtered_trace_events;
+}
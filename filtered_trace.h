@@ -0,0 +1,116 @@
+/************************************************************
+
+    L1-filtered traces, for fast L2 studies.
+
+While the L1 cache stays the same, the stream of requests it sends
+to L2 stays the same too, whatever the L2 side of the memory
+subsystem does (its prefetchers, dead-block prediction, SHiP, the
+mini-sim, main memory and its channels, tiers and compression). An
+L1-filtered trace records that stream once, from a full simulation,
+and filtered_trace_replay() then runs it on the L2 side alone, as
+many times as needed, without simulating the L1 hits, which are the
+vast majority of the accesses.
+
+The stream is made of the events below, each recorded where the
+memory subsystem hands it to L2:
+  FILTERED_TRACE_FILL: an L1 (or L1I) miss, in memory_handle_l1_miss().
+  FILTERED_TRACE_SW_PREFETCH_L1: a software prefetch into L1 that
+                                 missed in L1, also in
+                                 memory_handle_l1_miss().
+  FILTERED_TRACE_SW_PREFETCH_L2: a software prefetch into L2 only
+                                 that missed in L1.
+  FILTERED_TRACE_WRITEBACK: a dirty line evicted or demoted from L1,
+                            with its data.
+  FILTERED_TRACE_EVICT: an evict hint, with the data of the L1 copy
+                        if it was dirty.
+  FILTERED_TRACE_CLOCK: a clock interrupt, which clears the L2 r bits.
+
+A filtered trace is a binary file: a header (FILTERED_TRACE_MAGIC,
+FILTERED_TRACE_VERSION and the size of main memory), followed by
+the events. Each event is a 32-bit word holding the address of the
+line (whose low 6 bits are free) with the kind of event in bits 0-2
+and the flags below in bits 3-5, followed by the PC of the request,
+if FILTERED_TRACE_PC_FLAG is set, and the 16 words of the line, if
+FILTERED_TRACE_DATA_FLAG is set.
+
+Replaying a trace gives the same L2 misses, L2 state and main memory
+contents as the simulation it was recorded from, with any L2-side
+feature enabled or not, since the policies that use the request
+metadata only use its PC. num_l1_misses counts the (L1D) misses
+replayed. The L1 hits are not in the trace, so the latency model
+(memory_cycles) is not replayed, and neither are the statistics of
+the L1 side (e.g. the demotes and the software prefetches that hit
+in L1, see memory_cache_hint_report()).
+
+************************************************************/
+
+#include "memory_request.h"
+
+#define FILTERED_TRACE_MAGIC 0x5446314c    //"L1FT"
+#define FILTERED_TRACE_VERSION 1
+
+//Kinds of events.
+#define FILTERED_TRACE_FILL 0
+#define FILTERED_TRACE_SW_PREFETCH_L1 1
+#define FILTERED_TRACE_SW_PREFETCH_L2 2
+#define FILTERED_TRACE_WRITEBACK 3
+#define FILTERED_TRACE_EVICT 4
+#define FILTERED_TRACE_CLOCK 5
+
+//The bits of the first word of an event.
+#define FILTERED_TRACE_KIND_MASK 0x7
+#define FILTERED_TRACE_PC_FLAG 0x8             //followed by the PC
+#define FILTERED_TRACE_INSTRUCTION_FLAG 0x10   //an instruction fetch
+#define FILTERED_TRACE_DATA_FLAG 0x20          //followed by the line
+
+//TRUE while a trace is being recorded (see filtered_trace_start()).
+extern BOOL filtered_trace_recording;
+
+//The number of events recorded or replayed.
+extern uint64_t filtered_trace_events;
+
+
+/************************************************
+
+       filtered_trace_start(), filtered_trace_finish()
+
+filtered_trace_start() writes the header of a filtered trace to the
+specified file, which must be open for binary writing, and starts
+recording the events of the memory subsystem into it.
+filtered_trace_finish() stops recording and returns the number of
+events recorded; the file is left open, for the caller to close.
+
+***********************************************/
+
+void filtered_trace_start(FILE *trace);
+uint64_t filtered_trace_finish();
+
+
+/************************************************
+
+       filtered_trace_note()
+
+This procedure records an event of the specified kind, on the line
+containing the specified address, with the metadata of the request
+(or NULL) and the data of the line (or NULL). It is called by
+memory_subsystem.c while filtered_trace_recording is TRUE.
+
+***********************************************/
+
+void filtered_trace_note(uint8_t kind, uint32_t address, const MEMORY_REQUEST_INFO *info,
+			 const uint32_t data[]);
+
+
+/************************************************
+
+       filtered_trace_replay()
+
+This procedure performs each event of the specified filtered trace
+on the L2 side of the memory subsystem, which must have been
+initialized, with the size of main memory the trace was recorded
+with. It returns the number of events replayed. A trace that is
+not a filtered trace, or is cut short, is an error.
+
+***********************************************/
+
+uint64_t filtered_trace_replay(FILE *trace);
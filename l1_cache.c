@@ -29,14 +29,17 @@
 
    Each L1 cache entry is structured as follows:
 
-    1 1    14       16            
-   -------------------------------------------------
-   |v|d|reserved|  tag  |  16-word cache line data  |
-   -------------------------------------------------
-
-  where "v" is the valid bit and "d" is the dirty bit.
-  The 14-bit "reserved" field is an artifact of using
-  C, it wouldn't be in the actual cache hardware.
+    1 1 1    13       16            
+   ---------------------------------------------------
+   |v|d|p|reserved|  tag  |  16-word cache line data  |
+   ---------------------------------------------------
+
+  where "v" is the valid bit, "d" is the dirty bit and "p"
+  is set on a line brought in by a software prefetch until
+  its first use. The 13-bit "reserved" field is an artifact
+  of using C, it wouldn't be in the actual cache hardware.
+  The v_d_tag words and the cache line data of the entries
+  are stored in two separate arrays (see l1_cache.h).
 
 ************************************************************/
 
@@ -46,40 +49,32 @@
 
 #include "memory_subsystem_constants.h"
 #include "l1_cache.h"
-
-
-//number of cache entries (2^11)
-#define L1_NUM_CACHE_ENTRIES (1<<11)
-
-/***************************************************
-This struct defines the structure of a single cache
-entry in the L1 cache. It has the following fields:
-  v_d_tag: 32-bit unsigned word containing the 
-           valid (v) bit at bit 31 (leftmost bit),
-           the dirty bit (d) at bit 30, and the tag 
-           in bits 0 through 15 (the 16 rightmost bits)
-  cache_line: an array of 16 words, constituting a single
-              cache line.
-****************************************************/
-typedef struct {
-  uint32_t v_d_tag;
-  uint32_t cache_line[WORDS_PER_CACHE_LINE];
-} L1_CACHE_ENTRY;
-
-
-//the valid bit is bit 31 (leftmost bit) of v_d_tag word
-//The mask is 1 shifted left by 31
-#define L1_VBIT_MASK (0x1 << 31)
-
-//dirty bit is bit 30 (second to leftmost bit) of v_d_tag word
-//The mask is 1 shifted left by 30
-#define L1_DIRTYBIT_MASK (0x1 << 30)
-
-//tag is lowest 16 bits of v_d_tag word, so the mask is FFFF hex
-#define L1_ENTRY_TAG_MASK 0xffff
-
-//The L1 cache is just an array cache entries
-L1_CACHE_ENTRY l1_cache[L1_NUM_CACHE_ENTRIES];
+#include "line_kernels.h"
+
+
+//The L1 cache is just the v_d_tag words and the cache lines of its
+//entries. The address masks are in l1_cache.h, since the L1 hit fast
+//path is inlined into its callers.
+uint32_t l1_tags[L1_NUM_CACHE_ENTRIES];
+uint32_t l1_lines[L1_NUM_CACHE_ENTRIES][WORDS_PER_CACHE_LINE] __attribute__((aligned(BYTES_PER_CACHE_LINE)));
+
+//One bit per cache entry, set whenever the entry changes (other
+//than by a write hit), so that an incremental checkpoint only saves
+//the entries changed since the previous one (see checkpoint.h).
+//Nothing is tracked until the first checkpoint.
+uint32_t l1_changed_entries[L1_NUM_CACHE_ENTRIES / 32];
+BOOL l1_tracking_changes = FALSE;
+#define L1_MARK_CHANGED(entry_index) \
+    do { \
+        if (l1_tracking_changes) \
+            l1_changed_entries[(entry_index) >> 5] |= 1u << ((entry_index) & 31); \
+    } while (0)
+
+//A dirty entry may have been written by a write hit since the last
+//checkpoint, so it counts as changed.
+#define L1_CHANGED(entry_index) \
+    ((l1_changed_entries[(entry_index) >> 5] & (1u << ((entry_index) & 31))) || \
+     (l1_tags[entry_index] & L1_DIRTYBIT_MASK))
 
 
 /************************************************
@@ -96,37 +91,12 @@ void l1_initialize()
   //v_d_tag field, since that's more efficient (no masking/shifting)
 
     for (int entry = 0; entry < L1_NUM_CACHE_ENTRIES; entry++) {
-        l1_cache[entry].v_d_tag = 0;
+        l1_tags[entry] = 0;
+        L1_MARK_CHANGED(entry);
     }
 }
 
 
-//The upper 16 bits (bits 16-31) of an address are used as the tag bits.
-//So the mask is 16 ones (so FFFF hex) shifted left by 20 bits.
-#define L1_ADDRESS_TAG_MASK (0xffff << 16)
-#define L1_ADDRESS_TAG_SHIFT 16
-
-//Bits 6-15 (so 10 bits in total) of an address specifies the index of the
-//cache line within the L1 cache.
-//The value of the mask is 10 ones (so 3FF hex) shifted left by 6 bits,
-//and the shift is 6.
-#define L1_ADDRESS_INDEX_MASK (0x3ff << 6)
-#define L1_ADDRESS_INDEX_SHIFT 6
-
-
-//Bits 2-5 of an address specifies the 4-bit offset of the addressed
-//word within the 16-word cache line.
-// So the mask is 4 ones (so F hex) shifted left by 2.
-//
-#define L1_ADDRESS_WORD_OFFSET_MASK (0xF << 2)
-
-//After masking to extract the word offset, it needs
-//to be shifted to the right by 2.
-#define L1_ADDRESS_WORD_OFFSET_SHIFT 2
-
-
-#define L1_HIT_STATUS_MASK 0x1
-
 /**********************************************************
 
              l1_cache_access()
@@ -169,53 +139,15 @@ void l1_cache_access(uint32_t address, uint32_t write_data,
 		     uint8_t control, uint32_t *read_data, uint8_t *status)
 {
 
-  //Extract from the address the index of the cache entry in the cache.
-  //Use the L1_ADDRESS_INDEX_MASK mask to mask out the appropriate
-  //bits of the address and L1_ADDRESS_INDEX_SHIFT
-  //to shift the appropriate amount.
-
-    uint32_t entry_index = (address & L1_ADDRESS_INDEX_MASK) >> L1_ADDRESS_INDEX_SHIFT;
-
-  //Extract from the address the tag bits.
-  //Use the L1_ADDRESS_TAG_MASK mask to mask out the appropriate
-  //bits of the address and L1_ADDRESS_TAG_SHIFT
-  //to shift the appropriate amount.
+  //The lookup itself is done by l1_cache_access_hit() in l1_cache.h,
+  //which callers on the hot path use directly. Here, its result
+  //is just reported in the low bit of the status byte.
 
-    uint32_t tag = (address & L1_ADDRESS_TAG_MASK) >> L1_ADDRESS_TAG_SHIFT;
-  
-  //Extract from the address the word offset within the cache line.
-  //Use the L1_ADDRESS_WORD_OFFSET_MASK to mask out the appropriate bits of
-  //the address and L1_ADDRESS_WORD_OFFSET_SHIFT to shift the bits the 
-  //appropriate amount.
-
-    uint32_t word_offset = (address & L1_ADDRESS_WORD_OFFSET_MASK) >> L1_ADDRESS_WORD_OFFSET_SHIFT;
-  
-  //if the cache entry at the computed index has a zero valid bit or 
-  //if the entry's tag does not match the tag bits of
-  //the address, then it is a cache miss: Set the
-  //low bit of the status byte appropriately. There's nothing
-  //more to do in this case, the function can return.
-
-    if (((l1_cache[entry_index].v_d_tag & L1_VBIT_MASK) == 0) || ((l1_cache[entry_index].v_d_tag & L1_ENTRY_TAG_MASK) != tag)) {
-        *status &= ~(0x1);
-        return;
-    }
-
-  //Otherwise, it's a cache hit:
-  //If a read operation was specified, the appropriate word (as specified by
-  //the word offset extracted from the address) of the entry's 
-  //cache line data should be written to read_data.
-  //If a write operation was specified, the value of write_data should be
-  //written to the appropriate word of the entry's cache line data and 
-  //the entry's dirty bit should be set.
-
-    *status |= (0x1);
-    if (control & READ_ENABLE_MASK) {
-        *read_data = l1_cache[entry_index].cache_line[word_offset];
+    if (l1_cache_access_hit(address, write_data, control, read_data)) {
+        *status |= (0x1);
     }
-    if (control & WRITE_ENABLE_MASK) {
-        l1_cache[entry_index].cache_line[word_offset] = write_data;
-        l1_cache[entry_index].v_d_tag |= L1_DIRTYBIT_MASK;
+    else {
+        *status &= ~(0x1);
     }
 }
 
@@ -285,11 +217,9 @@ void l1_insert_line(uint32_t address, uint32_t write_data[],
   //The lowest bit of the status byte should be set to 1 to indicate that
   //the write-back is needed.
 
-    if ((l1_cache[entry_index].v_d_tag & L1_VBIT_MASK) && (l1_cache[entry_index].v_d_tag & L1_DIRTYBIT_MASK)) {
-        *evicted_writeback_address = (l1_cache[entry_index].v_d_tag << L1_ADDRESS_TAG_SHIFT) | (entry_index << L1_ADDRESS_INDEX_SHIFT);
-        for (int i = 0; i < WORDS_PER_CACHE_LINE; i++) {
-            evicted_writeback_data[i] = l1_cache[entry_index].cache_line[i];
-        }
+    if ((l1_tags[entry_index] & L1_VBIT_MASK) && (l1_tags[entry_index] & L1_DIRTYBIT_MASK)) {
+        *evicted_writeback_address = (l1_tags[entry_index] << L1_ADDRESS_TAG_SHIFT) | (entry_index << L1_ADDRESS_INDEX_SHIFT);
+        line_copy(evicted_writeback_data, l1_lines[entry_index]);
         *status |= (0x1);
     }
 
@@ -300,17 +230,166 @@ void l1_insert_line(uint32_t address, uint32_t write_data[],
         *status &= ~(0x1);
     }
 
+  //Report the eviction of a software-prefetched line that was never used.
+
+    if ((l1_tags[entry_index] & L1_VBIT_MASK) && (l1_tags[entry_index] & L1_SW_PREFETCH_MASK)) {
+        *status |= L1_UNUSED_SW_PREFETCH_STATUS_MASK;
+    }
+    else {
+        *status &= ~L1_UNUSED_SW_PREFETCH_STATUS_MASK;
+    }
+
   // Now (for both cases, write-back or not), write the incoming cache line
   // in write_data to the selected cache entry.
   
-    for (int i = 0; i < WORDS_PER_CACHE_LINE; i++) {
-        l1_cache[entry_index].cache_line[i] = write_data[i];
-    }
+    line_copy(l1_lines[entry_index], write_data);
   
   //set the valid bit, clear the dirty bit, and write the tag
 
   //CODE HERE
-    l1_cache[entry_index].v_d_tag = tag;
-    l1_cache[entry_index].v_d_tag &= (~(L1_DIRTYBIT_MASK));
-    l1_cache[entry_index].v_d_tag |= L1_VBIT_MASK;
-} 
\ No newline at end of file
+    l1_tags[entry_index] = tag;
+    l1_tags[entry_index] &= (~(L1_DIRTYBIT_MASK));
+    l1_tags[entry_index] |= L1_VBIT_MASK;
+    L1_MARK_CHANGED(entry_index);
+} 
+
+
+//Returns the index of the L1 cache entry holding the specified
+//address, or -1 if the address is not in the L1 cache.
+
+static int l1_find_line(uint32_t address)
+{
+    uint32_t entry_index = (address & L1_ADDRESS_INDEX_MASK) >> L1_ADDRESS_INDEX_SHIFT;
+    uint32_t tag = (address & L1_ADDRESS_TAG_MASK) >> L1_ADDRESS_TAG_SHIFT;
+    if ((l1_tags[entry_index] & (L1_VBIT_MASK | L1_ENTRY_TAG_MASK)) == (L1_VBIT_MASK | tag))
+        return entry_index;
+    return -1;
+}
+
+
+/************************************************
+
+       l1_probe()
+
+This procedure returns TRUE if the cache line containing the
+specified address is in the L1 cache.
+
+***********************************************/
+
+BOOL l1_probe(uint32_t address)
+{
+    return l1_find_line(address) >= 0;
+}
+
+
+/************************************************
+
+       l1_set_sw_prefetch(), l1_use_sw_prefetch()
+
+These procedures set and clear the software prefetch bit
+of the line containing the specified address.
+
+***********************************************/
+
+void l1_set_sw_prefetch(uint32_t address)
+{
+    int entry = l1_find_line(address);
+    if (entry >= 0) {
+        l1_tags[entry] |= L1_SW_PREFETCH_MASK;
+        L1_MARK_CHANGED(entry);
+    }
+}
+
+
+BOOL l1_use_sw_prefetch(uint32_t address)
+{
+    int entry = l1_find_line(address);
+    if ((entry >= 0) && (l1_tags[entry] & L1_SW_PREFETCH_MASK)) {
+        l1_tags[entry] &= ~L1_SW_PREFETCH_MASK;
+        L1_MARK_CHANGED(entry);
+        return TRUE;
+    }
+    return FALSE;
+}
+
+
+/************************************************
+
+       l1_invalidate_line()
+
+This procedure removes the cache line containing the
+specified address from the L1 cache, returning its
+data if it has to be written back.
+
+***********************************************/
+
+void l1_invalidate_line(uint32_t address, uint32_t evicted_writeback_data[],
+			uint8_t *status)
+{
+    int entry = l1_find_line(address);
+
+    *status &= ~(0x1);
+    if (entry < 0)
+        return;
+    if (l1_tags[entry] & L1_DIRTYBIT_MASK) {
+        line_copy(evicted_writeback_data, l1_lines[entry]);
+        *status |= (0x1);
+    }
+    l1_tags[entry] = 0;
+    L1_MARK_CHANGED(entry);
+}
+
+
+/************************************************
+
+       l1_write_changes(), l1_read_changes(),
+       l1_clear_changes()
+
+A checkpoint holds the number of entries, followed by the index,
+v_d_tag word and cache line of each entry.
+
+***********************************************/
+
+uint32_t l1_write_changes(FILE *file, BOOL all)
+{
+    uint32_t count = 0;
+    for (uint32_t entry = 0; entry < L1_NUM_CACHE_ENTRIES; entry++) {
+        if (all || L1_CHANGED(entry))
+            count++;
+    }
+    fwrite(&count, sizeof(count), 1, file);
+    for (uint32_t entry = 0; entry < L1_NUM_CACHE_ENTRIES; entry++) {
+        if (all || L1_CHANGED(entry)) {
+            fwrite(&entry, sizeof(entry), 1, file);
+            fwrite(&l1_tags[entry], sizeof(uint32_t), 1, file);
+            fwrite(l1_lines[entry], BYTES_PER_CACHE_LINE, 1, file);
+        }
+    }
+    return count;
+}
+
+
+void l1_read_changes(FILE *file)
+{
+    uint32_t count, entry;
+    if (fread(&count, sizeof(count), 1, file) != 1) {
+        printf("Error: truncated L1 checkpoint\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if ((fread(&entry, sizeof(entry), 1, file) != 1) || (entry >= L1_NUM_CACHE_ENTRIES) ||
+            (fread(&l1_tags[entry], sizeof(uint32_t), 1, file) != 1) ||
+            (fread(l1_lines[entry], BYTES_PER_CACHE_LINE, 1, file) != 1)) {
+            printf("Error: truncated L1 checkpoint\n");
+            exit(1);
+        }
+    }
+}
+
+
+void l1_clear_changes()
+{
+    for (int i = 0; i < L1_NUM_CACHE_ENTRIES / 32; i++)
+        l1_changed_entries[i] = 0;
+    l1_tracking_changes = TRUE;
+}
@@ -1,3 +1,123 @@
+#ifndef L1_CACHE_H
+#define L1_CACHE_H
+
+//number of cache entries (2^10), one per index (see below)
+#define L1_NUM_CACHE_ENTRIES (1<<10)
+
+/***************************************************
+Each cache entry of the L1 cache is made of:
+  a v_d_tag word: 32-bit unsigned word containing the
+           valid (v) bit at bit 31 (leftmost bit),
+           the dirty bit (d) at bit 30, the software
+           prefetch bit (p) at bit 29, and the tag 
+           in bits 0 through 15 (the 16 rightmost bits)
+  a cache line: an array of 16 words.
+
+The v_d_tag words and the cache lines are kept in two separate
+arrays, rather than in an array of entries, so that the tags are
+dense (16 to a host cache line) and each 64-byte cache line is
+aligned on a host cache line, rather than straddling two.
+****************************************************/
+
+
+//the valid bit is bit 31 (leftmost bit) of v_d_tag word
+//The mask is 1 shifted left by 31
+#define L1_VBIT_MASK (0x1 << 31)
+
+//dirty bit is bit 30 (second to leftmost bit) of v_d_tag word
+//The mask is 1 shifted left by 30
+#define L1_DIRTYBIT_MASK (0x1 << 30)
+
+//software prefetch bit is bit 29 of v_d_tag word. It is set on a line
+//brought in by a software prefetch, until the line is first used.
+#define L1_SW_PREFETCH_MASK (0x1 << 29)
+
+//tag is lowest 16 bits of v_d_tag word, so the mask is FFFF hex
+#define L1_ENTRY_TAG_MASK 0xffff
+
+//The L1 cache is just the array of v_d_tag words and the array of
+//cache lines (see l1_cache.c).
+extern uint32_t l1_tags[L1_NUM_CACHE_ENTRIES];
+extern uint32_t l1_lines[L1_NUM_CACHE_ENTRIES][WORDS_PER_CACHE_LINE]
+    __attribute__((aligned(BYTES_PER_CACHE_LINE)));
+
+
+//The upper 16 bits (bits 16-31) of an address are used as the tag bits.
+//So the mask is 16 ones (so FFFF hex) shifted left by 20 bits.
+#define L1_ADDRESS_TAG_MASK (0xffff << 16)
+#define L1_ADDRESS_TAG_SHIFT 16
+
+//Bits 6-15 (so 10 bits in total) of an address specifies the index of the
+//cache line within the L1 cache.
+//The value of the mask is 10 ones (so 3FF hex) shifted left by 6 bits,
+//and the shift is 6.
+#define L1_ADDRESS_INDEX_MASK (0x3ff << 6)
+#define L1_ADDRESS_INDEX_SHIFT 6
+
+
+//Bits 2-5 of an address specifies the 4-bit offset of the addressed
+//word within the 16-word cache line.
+// So the mask is 4 ones (so F hex) shifted left by 2.
+//
+#define L1_ADDRESS_WORD_OFFSET_MASK (0xF << 2)
+
+//After masking to extract the word offset, it needs
+//to be shifted to the right by 2.
+#define L1_ADDRESS_WORD_OFFSET_SHIFT 2
+
+
+
+#define L1_HIT_STATUS_MASK 0x1
+
+//Set by l1_insert_line() if the evicted line was brought in by a
+//software prefetch and never used.
+#define L1_UNUSED_SW_PREFETCH_STATUS_MASK 0x2
+
+
+/**********************************************************
+
+             l1_cache_access_hit()
+
+This is the L1 hit fast path. It is defined here, rather than in
+l1_cache.c, so that it is inlined into memory_access() and an L1 hit
+costs no procedure calls and no round trip through a status byte.
+
+The parameters are the same as for l1_cache_access(), below. On a
+hit, the read or write is performed and TRUE is returned. On a miss,
+FALSE is returned and there is no other effect.
+
+**********************************************************/
+
+static inline BOOL l1_cache_access_hit(uint32_t address, uint32_t write_data,
+				       uint8_t control, uint32_t *read_data)
+{
+  //Extract the index, tag and word offset from the address,
+  //see l1_cache.c.
+
+    uint32_t entry_index = (address & L1_ADDRESS_INDEX_MASK) >> L1_ADDRESS_INDEX_SHIFT;
+    uint32_t tag = (address & L1_ADDRESS_TAG_MASK) >> L1_ADDRESS_TAG_SHIFT;
+    uint32_t word_offset = (address & L1_ADDRESS_WORD_OFFSET_MASK) >> L1_ADDRESS_WORD_OFFSET_SHIFT;
+
+  //It's a hit if the valid bit is set and the tag matches,
+  //which can be checked with a single comparison. The first use
+  //of a software-prefetched line is also reported as a miss, so
+  //that it can be counted (see l1_use_sw_prefetch()).
+
+    if ((l1_tags[entry_index] & (L1_VBIT_MASK | L1_SW_PREFETCH_MASK | L1_ENTRY_TAG_MASK)) != (L1_VBIT_MASK | tag)) {
+        return FALSE;
+    }
+
+    if (control & READ_ENABLE_MASK) {
+        *read_data = l1_lines[entry_index][word_offset];
+    }
+    if (control & WRITE_ENABLE_MASK) {
+        l1_lines[entry_index][word_offset] = write_data;
+        l1_tags[entry_index] |= L1_DIRTYBIT_MASK;
+    }
+    return TRUE;
+}
+
+
 
 /************************************************
             l2_initialize()
@@ -85,6 +205,8 @@ status: this in an 8-bit output parameter (thus, a pointer to it is
         written back to memory or not, as follows:
             0: no write-back required
             1: evicted cache line needs to be written back.
+        Bit 1 is set if the evicted line was brought in by a
+        software prefetch and never used.
 
 *********************************************************/
 
@@ -105,3 +227,72 @@ cache. It should be called periodically to support the the NRU algorithm.
 ***********************************************/
 
 void l1_clear_r_bits();
+
+
+/************************************************
+
+       l1_probe()
+
+This procedure returns TRUE if the cache line containing the
+specified address is in the L1 cache (whether or not it has been
+used since it was prefetched). It has no effect on the cache.
+
+***********************************************/
+
+BOOL l1_probe(uint32_t address);
+
+
+/************************************************
+
+       l1_set_sw_prefetch(), l1_use_sw_prefetch()
+
+l1_set_sw_prefetch() marks the (resident) cache line containing
+the specified address as brought in by a software prefetch.
+
+l1_use_sw_prefetch() is called before a demand access. If the line
+is resident and marked, the mark is cleared, so that the access hits,
+and TRUE is returned.
+
+***********************************************/
+
+void l1_set_sw_prefetch(uint32_t address);
+BOOL l1_use_sw_prefetch(uint32_t address);
+
+
+/************************************************
+
+       l1_invalidate_line()
+
+This procedure removes the cache line containing the specified
+address from the L1 cache, if it is there. If the line is dirty,
+its data is copied to evicted_writeback_data and bit 0 of the
+status byte is set, otherwise bit 0 is cleared.
+
+***********************************************/
+
+void l1_invalidate_line(uint32_t address, uint32_t evicted_writeback_data[],
+			uint8_t *status);
+
+
+/************************************************
+
+       l1_write_changes(), l1_read_changes(),
+       l1_clear_changes()
+
+l1_write_changes() writes the cache entries changed since the last
+l1_clear_changes() (or every entry, if all is TRUE) to a checkpoint
+file, and returns the number of entries written. l1_read_changes()
+reads them back into the cache. See checkpoint.h.
+
+Changes are only tracked from the first l1_clear_changes() on, and
+a write hit (see l1_cache_access_hit()) is never tracked, so that the
+fast path doesn't pay for checkpoints: every dirty entry counts as
+changed instead.
+
+***********************************************/
+
+uint32_t l1_write_changes(FILE *file, BOOL all);
+void l1_read_changes(FILE *file);
+void l1_clear_changes();
+
+#endif
@@ -0,0 +1,145 @@
+/************************************************************
+
+   This file contains the L1 instruction cache (see l1i_cache.h).
+
+   Each entry keeps the line address (address / 64) as its tag, and
+   a stamp for replacement: the time of its last access (LRU) or of
+   its insertion (FIFO).
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "l1i_cache.h"
+#include "line_kernels.h"
+
+/***************************************************
+This struct defines an entry of the L1I. It has the
+following fields:
+  line: the line address (address / 64).
+  stamp: for replacement.
+  cache_line: the 16 words of the line.
+****************************************************/
+
+typedef struct {
+  BOOL valid;
+  uint32_t line;
+  uint64_t stamp;
+  uint32_t cache_line[WORDS_PER_CACHE_LINE];
+} L1I_CACHE_ENTRY;
+
+L1I_CACHE_ENTRY *l1i_cache = NULL;
+uint32_t l1i_num_sets;
+uint32_t l1i_lines_per_set;
+uint8_t l1i_policy;
+uint64_t l1i_time;
+
+BOOL l1i_enabled = FALSE;
+
+uint64_t l1i_accesses;
+uint64_t l1i_misses;
+
+
+void l1i_initialize(uint32_t size_in_bytes, uint32_t lines_per_set, uint8_t policy)
+{
+    uint32_t num_lines = size_in_bytes / BYTES_PER_CACHE_LINE;
+    uint32_t num_sets = lines_per_set ? num_lines / lines_per_set : 0;
+
+    if ((num_sets == 0) || (num_sets * lines_per_set != num_lines) || (num_sets & (num_sets - 1))) {
+        printf("Error: an L1I of %u bytes cannot have %u lines per set\n", size_in_bytes, lines_per_set);
+        exit(1);
+    }
+    if ((policy != L1I_POLICY_LRU) && (policy != L1I_POLICY_FIFO)) {
+        printf("Error: unknown L1I replacement policy %u\n", policy);
+        exit(1);
+    }
+
+    free(l1i_cache);
+    l1i_cache = malloc(num_lines * sizeof(L1I_CACHE_ENTRY));
+    if (l1i_cache == NULL) {
+        printf("Error: cannot allocate the L1I\n");
+        exit(1);
+    }
+    l1i_num_sets = num_sets;
+    l1i_lines_per_set = lines_per_set;
+    l1i_policy = policy;
+    l1i_clear();
+    l1i_enabled = TRUE;
+}
+
+
+void l1i_clear()
+{
+    for (uint32_t i = 0; i < l1i_num_sets * l1i_lines_per_set; i++)
+        l1i_cache[i].valid = FALSE;
+    l1i_time = 0;
+    l1i_accesses = 0;
+    l1i_misses = 0;
+}
+
+
+BOOL l1i_cache_access(uint32_t address, uint32_t *read_data)
+{
+    uint32_t line = address / BYTES_PER_CACHE_LINE;
+    L1I_CACHE_ENTRY *set = &l1i_cache[(line % l1i_num_sets) * l1i_lines_per_set];
+
+    l1i_time++;
+    for (uint32_t way = 0; way < l1i_lines_per_set; way++) {
+        if (set[way].valid && (set[way].line == line)) {
+            l1i_accesses++;
+            if (l1i_policy == L1I_POLICY_LRU)
+                set[way].stamp = l1i_time;
+            *read_data = set[way].cache_line[(address % BYTES_PER_CACHE_LINE) / BYTES_PER_WORD];
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+
+void l1i_insert_line(uint32_t address, uint32_t data[])
+{
+    uint32_t line = address / BYTES_PER_CACHE_LINE;
+    L1I_CACHE_ENTRY *set = &l1i_cache[(line % l1i_num_sets) * l1i_lines_per_set];
+
+    l1i_misses++;
+
+  //Replace an invalid line if there is one, otherwise the one
+  //with the oldest stamp.
+
+    L1I_CACHE_ENTRY *victim = &set[0];
+    for (uint32_t way = 0; way < l1i_lines_per_set; way++) {
+        if (!set[way].valid) {
+            victim = &set[way];
+            break;
+        }
+        if (set[way].stamp < victim->stamp)
+            victim = &set[way];
+    }
+
+    victim->valid = TRUE;
+    victim->line = line;
+    victim->stamp = ++l1i_time;
+    line_copy(victim->cache_line, data);
+}
+
+
+/************************************************
+
+       l1i_report()
+
+This procedure prints the L1I statistics.
+
+***********************************************/
+
+void l1i_report()
+{
+    printf("L1I (%u KB, %u-way, %s): %llu accesses, %llu misses, miss ratio = %.4f\n",
+           l1i_num_sets * l1i_lines_per_set * BYTES_PER_CACHE_LINE / 1024, l1i_lines_per_set,
+           l1i_policy == L1I_POLICY_LRU ? "LRU" : "FIFO",
+           (unsigned long long) l1i_accesses, (unsigned long long) l1i_misses,
+           l1i_accesses ? (double) l1i_misses / l1i_accesses : 0.0);
+}
@@ -0,0 +1,106 @@
+#ifndef L1I_CACHE_H
+#define L1I_CACHE_H
+
+/************************************************************
+
+    L1 instruction cache.
+
+When the L1 instruction cache is enabled, the L1 cache is split:
+instruction fetches (reads whose request metadata has access_type
+MEMORY_ACCESS_INSTRUCTION, see memory_request.h) go to the L1
+instruction cache (L1I), while all other accesses go to the L1
+cache of l1_cache.h, which then serves as the L1 data cache (L1D).
+Both are filled from the shared L2 cache.
+
+The L1I has its own geometry (size and associativity) and
+replacement policy. The L1D does not: it stays the fixed 64KB
+direct-mapped cache of l1_cache.h. Its geometry is built into the
+constants of the inlined L1 hit fast path (see
+l1_cache_access_hit()), so that a hit never looks up a geometry at
+run time, and into the checkpoints and the L1-filtered traces,
+which are only valid for that L1D.
+
+The L1I only holds instructions, which are never written, so its
+lines are never dirty. It is not kept coherent with the L1D: code
+that is written through the L1D is only seen by the L1I once it
+has been written back to L2 and the L1I line has been replaced.
+
+************************************************************/
+
+//Replacement policies of the L1I.
+#define L1I_POLICY_LRU 0
+#define L1I_POLICY_FIFO 1
+
+//Set to TRUE by l1i_initialize().
+extern BOOL l1i_enabled;
+
+//Counted by l1i_cache_access() and l1i_insert_line().
+extern uint64_t l1i_accesses;
+extern uint64_t l1i_misses;
+
+
+/************************************************
+
+       l1i_initialize()
+
+This procedure allocates an empty L1I of size_in_bytes bytes with
+lines_per_set lines per set (the number of sets must be a power
+of 2) and the specified replacement policy, clears its statistics
+and enables it.
+
+***********************************************/
+
+void l1i_initialize(uint32_t size_in_bytes, uint32_t lines_per_set, uint8_t policy);
+
+
+/************************************************
+
+       l1i_clear()
+
+This procedure invalidates every line of the L1I and clears its
+statistics, keeping its geometry and policy.
+
+***********************************************/
+
+void l1i_clear();
+
+
+/************************************************
+
+       l1i_cache_access()
+
+This procedure reads the word at the specified address from the
+L1I into read_data and returns TRUE on a hit. On a miss, it returns
+FALSE and has no other effect. The access is counted in l1i_accesses
+on the hit, so that an access that misses, has its line inserted
+and is then repeated is counted once.
+
+***********************************************/
+
+BOOL l1i_cache_access(uint32_t address, uint32_t *read_data);
+
+
+/************************************************
+
+       l1i_insert_line()
+
+This procedure inserts the cache line containing the specified
+address, with the data read from L2, into the L1I, and counts the
+miss in l1i_misses. The line replaced, if any, is simply dropped.
+
+***********************************************/
+
+void l1i_insert_line(uint32_t address, uint32_t data[]);
+
+
+/************************************************
+
+       l1i_report()
+
+This procedure prints the geometry, accesses and misses of the L1I.
+
+***********************************************/
+
+void l1i_report();
+
+#endif
@@ -29,17 +29,24 @@ An address is decomposed as follows (from lsb to msb):
 
 Each cache entry is structured as follows:
 
-    1 1 1     15      14
-    ------------------------------------------------
-   |v|r|d|reserved|  tag  |  16-word cache line data |
-    ------------------------------------------------
+    1 1 1  3  1    11      14
+    ------------------------------------------------------
+   |v|r|d|src|x|reserved|  tag  |  16-word cache line data |
+    ------------------------------------------------------
 
 where:
   v is the valid bit
   r is the reference bit
   d is the dirty bit
-
-and the 15 "reserved" bits are an artifact of using C. They
+  src is the prefetch source: 0 for a line brought in by a demand
+      access (or a prefetched line that has since been used by a
+      demand access), otherwise the number of the prefetcher that
+      brought the line in (see prefetch.h)
+  x is set if the line is predicted dead (see dead_block.h) or
+      predicted to have a distant re-reference (see ship.h); such
+      a line is evicted before any other valid line of its set
+
+and the 11 "reserved" bits are an artifact of using C. They
 would not exist in the cache hardware.
 
 **************************************************************/
@@ -50,6 +57,7 @@ would not exist in the cache hardware.
 
 #include "memory_subsystem_constants.h"
 #include "l2_cache.h"
+#include "line_kernels.h"
 
 
 /***************************************************
@@ -59,6 +67,7 @@ entry in the L2 cache. It has the following fields:
            valid (v) bit at bit 31 (leftmost bit),
            the reference (r) bit at bit 30,
            the dirty bit (d) at bit 29,
+           the prefetch source (src) in bits 26 through 28,
            the tag in bits 0 through 13 (the 14 rightmost bits)
   cache_line: an array of 16 words, constituting a single
               cache line.
@@ -77,20 +86,31 @@ typedef struct {
 ***************************************************/
 
 //4-way set-associative cache, so there are
-//4 cache lines per set.
-#define L2_LINES_PER_SET 4
+//4 cache lines per set (L2_LINES_PER_SET, see l2_cache.h).
 
 typedef struct {
   L2_CACHE_ENTRY lines[L2_LINES_PER_SET];
 } L2_CACHE_SET;
 
 
-//There are 4K = 2^12 sets in the L2 cache
-#define L2_NUM_CACHE_SETS (1 << 12)
+//There are 4K = 2^12 sets in the L2 cache (L2_NUM_CACHE_SETS,
+//see l2_cache.h).
 
 //The l2 cache itself is just an array of 4K = 2^12 cache sets.
 L2_CACHE_SET l2_cache[L2_NUM_CACHE_SETS];
 
+//One bit per set, set whenever the set changes, so that an
+//incremental checkpoint only saves the sets changed since the
+//previous one (see checkpoint.h).
+//Nothing is tracked until the first checkpoint.
+uint32_t l2_changed_sets[L2_NUM_CACHE_SETS / 32];
+BOOL l2_tracking_changes = FALSE;
+#define L2_MARK_CHANGED(set_index) \
+    do { \
+        if (l2_tracking_changes) \
+            l2_changed_sets[(set_index) >> 5] |= 1u << ((set_index) & 31); \
+    } while (0)
+
 //valid bit is bit 31 (leftmost bit) of v_d_tag word
 #define L2_VBIT_MASK (1 << 31)
 
@@ -100,6 +120,13 @@ L2_CACHE_SET l2_cache[L2_NUM_CACHE_SETS];
 //dirty bit is bit 29 (second to leftmost bit) of v_d_tag word
 #define L2_DIRTYBIT_MASK (1 << 29)
 
+//prefetch source is bits 26-28 of v_r_d_tag
+#define L2_PREFETCH_SOURCE_MASK (0x7 << 26)
+#define L2_PREFETCH_SOURCE_SHIFT 26
+
+//predicted-dead bit is bit 25 of v_r_d_tag
+#define L2_DEADBIT_MASK (1 << 25)
+
 //tag is lowest 14 bits of v_d_tag word.
 //the mask is 3FFF hex.
 #define L2_ENTRY_TAG_MASK 0x3fff
@@ -149,6 +176,7 @@ void l2_initialize()
         for (int line = 0; line < L2_LINES_PER_SET; line++) {
             l2_cache[set].lines[line].v_r_d_tag = 0;
         }       
+        L2_MARK_CHANGED(set);
     }
 }
 
@@ -233,23 +261,37 @@ void l2_cache_access(uint32_t address, uint32_t write_data[],
             break;
         }
     }
+  //If the line was brought in by a prefetch, this is the first
+  //demand access to it: report the prefetcher in the status byte
+  //and clear the prefetch source, so that the line now counts as
+  //a demand line.
+
+    *status &= ~(L2_PREFETCH_HIT_STATUS_MASK | L2_PREFETCH_SOURCE_STATUS_MASK);
+
     if (line_index == -1) {         // cache miss
         *status &= ~(0x1);
     }
     else {      // cache hit
         *status |= (0x1);
+        uint32_t v_r_d_tag = l2_cache[set_index].lines[line_index].v_r_d_tag;
+        uint32_t source = (l2_cache[set_index].lines[line_index].v_r_d_tag & L2_PREFETCH_SOURCE_MASK) >> L2_PREFETCH_SOURCE_SHIFT;
+        if (source) {
+            *status |= L2_PREFETCH_HIT_STATUS_MASK | (source << L2_PREFETCH_SOURCE_STATUS_SHIFT);
+            l2_cache[set_index].lines[line_index].v_r_d_tag &= ~L2_PREFETCH_SOURCE_MASK;
+        }
         l2_cache[set_index].lines[line_index].v_r_d_tag |= L2_RBIT_MASK;
         if (control & READ_ENABLE_MASK) {
-            for (uint32_t i = 0; i < WORDS_PER_CACHE_LINE; i++) {
-                read_data[i] = l2_cache[set_index].lines[line_index].cache_line[i];
-            }
+            line_copy(read_data, l2_cache[set_index].lines[line_index].cache_line);
         }
         if (control & WRITE_ENABLE_MASK) {
-            for (uint32_t i = 0; i < WORDS_PER_CACHE_LINE; i++) {
-                l2_cache[set_index].lines[line_index].cache_line[i] = write_data[i];
-            }
+            line_copy(l2_cache[set_index].lines[line_index].cache_line, write_data);
             l2_cache[set_index].lines[line_index].v_r_d_tag |= L2_DIRTYBIT_MASK;
         }
+
+      //A read hit on a line already referenced changes nothing.
+
+        if ((l2_cache[set_index].lines[line_index].v_r_d_tag != v_r_d_tag) || (control & WRITE_ENABLE_MASK))
+            L2_MARK_CHANGED(set_index);
     }
 }
 
@@ -349,8 +391,18 @@ void l2_insert_line(uint32_t address, uint32_t write_data[],
   //of a cache entry that has its r bit = 1 and its dirty bit = 0.
   uint32_t r1_d0_index = NOT_FOUND;
 
+  //This variable is used to store the index within the set
+  //of a cache entry that is predicted dead, which is evicted first.
+  uint32_t dead_index = NOT_FOUND;
+
   uint32_t word_offset;
 
+  //The status bits other than the write-back bit are only set
+  //if a valid line is evicted, below.
+
+    *status &= ~(L2_EVICTED_STATUS_MASK | L2_PREFETCH_SOURCE_STATUS_MASK);
+    L2_MARK_CHANGED(set_index);
+
   //In a loop, iterate though each entry in the set.
 
   //LOOP STARTS HERE
@@ -365,17 +417,23 @@ void l2_insert_line(uint32_t address, uint32_t write_data[],
       // function can return.
 
       if (!(l2_cache[set_index].lines[line].v_r_d_tag & L2_VBIT_MASK)) {
-          for (int i = 0; i < WORDS_PER_CACHE_LINE; i++) {
-              l2_cache[set_index].lines[line].cache_line[i] = write_data[i];
-          }
+          line_copy(l2_cache[set_index].lines[line].cache_line, write_data);
           l2_cache[set_index].lines[line].v_r_d_tag |= L2_VBIT_MASK;
           l2_cache[set_index].lines[line].v_r_d_tag &= ~L2_DIRTYBIT_MASK;
           l2_cache[set_index].lines[line].v_r_d_tag &= ~L2_RBIT_MASK;
+          l2_cache[set_index].lines[line].v_r_d_tag &= ~L2_PREFETCH_SOURCE_MASK;
+          l2_cache[set_index].lines[line].v_r_d_tag &= ~L2_DEADBIT_MASK;
           l2_cache[set_index].lines[line].v_r_d_tag &= ~L2_ENTRY_TAG_MASK;
           l2_cache[set_index].lines[line].v_r_d_tag |= tag;
           *status &= ~(0x1);
           return;
       }
+
+      //  A line predicted dead is the first choice for eviction.
+
+      else if ((l2_cache[set_index].lines[line].v_r_d_tag & L2_DEADBIT_MASK) && (dead_index == NOT_FOUND)) {
+          dead_index = line;
+      }
       //  Otherwise, we remember the first entry we encounter which has r=0 and d=0,
       //  the first entry that has r=0 and d=1, etc. When we're done looping,
       //  we choose the entry with the highest preference on the above list to evict.
@@ -402,7 +460,10 @@ void l2_insert_line(uint32_t address, uint32_t write_data[],
   //v=1, r=1, and d=1, then choose entry 0 of the set to evict.
     
     int line_index = -1;
-    if (r0_d0_index != NOT_FOUND) {
+    if (dead_index != NOT_FOUND) {
+        line_index = dead_index;
+    }
+    else if (r0_d0_index != NOT_FOUND) {
         line_index = r0_d0_index;
     }
     else if (r0_d1_index != NOT_FOUND) {
@@ -415,20 +476,24 @@ void l2_insert_line(uint32_t address, uint32_t write_data[],
         line_index = 0;
     }
 
+  //A valid line is being evicted. Its address is reported whether or
+  //not it has to be written back, along with its prefetch source if it
+  //was prefetched but never used.
+
+    *evicted_writeback_address = ((l2_cache[set_index].lines[line_index].v_r_d_tag & L2_ENTRY_TAG_MASK) << L2_ADDRESS_TAG_SHIFT) | (set_index << L2_ADDRESS_INDEX_SHIFT);
+    *status |= L2_EVICTED_STATUS_MASK;
+    *status |= ((l2_cache[set_index].lines[line_index].v_r_d_tag & L2_PREFETCH_SOURCE_MASK) >> L2_PREFETCH_SOURCE_SHIFT) << L2_PREFETCH_SOURCE_STATUS_SHIFT;
+
   //if the dirty bit of the cache entry to be evicted is set, then the data in the 
   //cache line needs to be written back. The address to write the current entry 
   //back to is constructed from the entry's tag and the set index in the cache by:
   // (evicted_entry_tag << L2_ADDRESS_TAG_SHIFT) | (set_index << L2_SET_INDEX_SHIFT)
-  //This address should be written to the evicted_writeback_address output
-  //parameter. The cache line data in the evicted entry should be copied to the
+  //This address has been written to the evicted_writeback_address output
+  //parameter, above. The cache line data in the evicted entry should be copied to the
   //evicted_writeback_data_array.
 
     if (l2_cache[set_index].lines[line_index].v_r_d_tag & L2_DIRTYBIT_MASK) {
-        for (int i = 0; i < WORDS_PER_CACHE_LINE; i++) {
-            evicted_writeback_data[i] = l2_cache[set_index].lines[line_index].cache_line[i];
-        }
-        *evicted_writeback_address = ((l2_cache[set_index].lines[line_index].v_r_d_tag & L2_ENTRY_TAG_MASK) << L2_ADDRESS_TAG_SHIFT) | (set_index << L2_ADDRESS_INDEX_SHIFT);
-        
+        line_copy(evicted_writeback_data, l2_cache[set_index].lines[line_index].cache_line);
     
   
   //Also, if the dirty bit of the chosen entry is been set, the low bit of the status byte 
@@ -446,12 +511,12 @@ void l2_insert_line(uint32_t address, uint32_t write_data[],
   //entry, and write the tag bits of the address into the tag of 
   //the entry.
 
-    for (int i = 0; i < WORDS_PER_CACHE_LINE; i++) {
-        l2_cache[set_index].lines[line_index].cache_line[i] = write_data[i];
-    }
+    line_copy(l2_cache[set_index].lines[line_index].cache_line, write_data);
     l2_cache[set_index].lines[line_index].v_r_d_tag |= L2_VBIT_MASK;
     l2_cache[set_index].lines[line_index].v_r_d_tag &= ~L2_DIRTYBIT_MASK;
     l2_cache[set_index].lines[line_index].v_r_d_tag &= ~L2_RBIT_MASK;
+    l2_cache[set_index].lines[line_index].v_r_d_tag &= ~L2_PREFETCH_SOURCE_MASK;
+    l2_cache[set_index].lines[line_index].v_r_d_tag &= ~L2_DEADBIT_MASK;
     l2_cache[set_index].lines[line_index].v_r_d_tag &= ~L2_ENTRY_TAG_MASK;
     l2_cache[set_index].lines[line_index].v_r_d_tag |= tag;
 }
@@ -470,7 +535,176 @@ void l2_clear_r_bits()
 {
     for (int set = 0; set < L2_NUM_CACHE_SETS; set++) {
         for (int line = 0; line < L2_LINES_PER_SET; line++) {
-            l2_cache[set].lines[line].v_r_d_tag &= ~L2_RBIT_MASK;
+            if (l2_cache[set].lines[line].v_r_d_tag & L2_RBIT_MASK) {
+                l2_cache[set].lines[line].v_r_d_tag &= ~L2_RBIT_MASK;
+                L2_MARK_CHANGED(set);
+            }
+        }
+    }
+}
+
+
+//Returns the index of the line holding the specified address
+//within its set, or -1 if the address is not in the L2 cache.
+
+static int l2_find_line(uint32_t set_index, uint32_t tag)
+{
+    for (int line = 0; line < L2_LINES_PER_SET; line++) {
+        if ((l2_cache[set_index].lines[line].v_r_d_tag & L2_VBIT_MASK) &&
+            ((l2_cache[set_index].lines[line].v_r_d_tag & L2_ENTRY_TAG_MASK) == tag)) {
+            return line;
         }
     }
-}
\ No newline at end of file
+    return -1;
+}
+
+
+/************************************************
+
+       l2_probe()
+
+This procedure returns TRUE if the cache line containing the
+specified address is in the L2 cache. Unlike l2_cache_access(),
+it has no effect on the state of the cache.
+
+***********************************************/
+
+BOOL l2_probe(uint32_t address)
+{
+    uint32_t set_index = (address & L2_ADDRESS_INDEX_MASK) >> L2_ADDRESS_INDEX_SHIFT;
+    uint32_t tag = (address & L2_ADDRESS_TAG_MASK) >> L2_ADDRESS_TAG_SHIFT;
+    return l2_find_line(set_index, tag) != -1;
+}
+
+
+/************************************************
+
+       l2_set_prefetch_source()
+
+This procedure records that the (resident) cache line containing
+the specified address was brought in by the specified prefetcher.
+
+***********************************************/
+
+void l2_set_prefetch_source(uint32_t address, uint8_t source)
+{
+    uint32_t set_index = (address & L2_ADDRESS_INDEX_MASK) >> L2_ADDRESS_INDEX_SHIFT;
+    uint32_t tag = (address & L2_ADDRESS_TAG_MASK) >> L2_ADDRESS_TAG_SHIFT;
+    int line = l2_find_line(set_index, tag);
+    if (line != -1) {
+        l2_cache[set_index].lines[line].v_r_d_tag &= ~L2_PREFETCH_SOURCE_MASK;
+        l2_cache[set_index].lines[line].v_r_d_tag |= ((uint32_t) source << L2_PREFETCH_SOURCE_SHIFT) & L2_PREFETCH_SOURCE_MASK;
+        L2_MARK_CHANGED(set_index);
+    }
+}
+
+
+/************************************************
+
+       l2_invalidate_line()
+
+This procedure removes the cache line containing the
+specified address from the L2 cache, returning its
+data if it has to be written back.
+
+***********************************************/
+
+void l2_invalidate_line(uint32_t address, uint32_t evicted_writeback_data[],
+			uint8_t *status)
+{
+    uint32_t set_index = (address & L2_ADDRESS_INDEX_MASK) >> L2_ADDRESS_INDEX_SHIFT;
+    uint32_t tag = (address & L2_ADDRESS_TAG_MASK) >> L2_ADDRESS_TAG_SHIFT;
+    int line = l2_find_line(set_index, tag);
+
+    *status &= ~(0x1 | L2_EVICTED_STATUS_MASK | L2_PREFETCH_SOURCE_STATUS_MASK);
+    if (line == -1)
+        return;
+
+    uint32_t v_r_d_tag = l2_cache[set_index].lines[line].v_r_d_tag;
+    *status |= L2_EVICTED_STATUS_MASK;
+    *status |= ((v_r_d_tag & L2_PREFETCH_SOURCE_MASK) >> L2_PREFETCH_SOURCE_SHIFT) << L2_PREFETCH_SOURCE_STATUS_SHIFT;
+    if (v_r_d_tag & L2_DIRTYBIT_MASK) {
+        line_copy(evicted_writeback_data, l2_cache[set_index].lines[line].cache_line);
+        *status |= (0x1);
+    }
+    l2_cache[set_index].lines[line].v_r_d_tag = 0;
+    L2_MARK_CHANGED(set_index);
+}
+
+
+/************************************************
+
+       l2_set_dead()
+
+This procedure sets or clears the predicted-dead bit of
+the cache line containing the specified address, if it
+is in the cache.
+
+***********************************************/
+
+void l2_set_dead(uint32_t address, BOOL dead)
+{
+    uint32_t set_index = (address & L2_ADDRESS_INDEX_MASK) >> L2_ADDRESS_INDEX_SHIFT;
+    uint32_t tag = (address & L2_ADDRESS_TAG_MASK) >> L2_ADDRESS_TAG_SHIFT;
+    int line = l2_find_line(set_index, tag);
+    if (line != -1) {
+        if (dead)
+            l2_cache[set_index].lines[line].v_r_d_tag |= L2_DEADBIT_MASK;
+        else
+            l2_cache[set_index].lines[line].v_r_d_tag &= ~L2_DEADBIT_MASK;
+        L2_MARK_CHANGED(set_index);
+    }
+}
+
+
+/************************************************
+
+       l2_write_changes(), l2_read_changes(),
+       l2_clear_changes()
+
+A checkpoint holds the number of sets, followed by the index
+and contents of each set.
+
+***********************************************/
+
+uint32_t l2_write_changes(FILE *file, BOOL all)
+{
+    uint32_t count = 0;
+    for (uint32_t set = 0; set < L2_NUM_CACHE_SETS; set++) {
+        if (all || (l2_changed_sets[set >> 5] & (1u << (set & 31))))
+            count++;
+    }
+    fwrite(&count, sizeof(count), 1, file);
+    for (uint32_t set = 0; set < L2_NUM_CACHE_SETS; set++) {
+        if (all || (l2_changed_sets[set >> 5] & (1u << (set & 31)))) {
+            fwrite(&set, sizeof(set), 1, file);
+            fwrite(&l2_cache[set], sizeof(L2_CACHE_SET), 1, file);
+        }
+    }
+    return count;
+}
+
+
+void l2_read_changes(FILE *file)
+{
+    uint32_t count, set;
+    if (fread(&count, sizeof(count), 1, file) != 1) {
+        printf("Error: truncated L2 checkpoint\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        if ((fread(&set, sizeof(set), 1, file) != 1) || (set >= L2_NUM_CACHE_SETS) ||
+            (fread(&l2_cache[set], sizeof(L2_CACHE_SET), 1, file) != 1)) {
+            printf("Error: truncated L2 checkpoint\n");
+            exit(1);
+        }
+    }
+}
+
+
+void l2_clear_changes()
+{
+    for (int i = 0; i < L2_NUM_CACHE_SETS / 32; i++)
+        l2_changed_sets[i] = 0;
+    l2_tracking_changes = TRUE;
+}
@@ -1,3 +1,27 @@
+#ifndef L2_CACHE_H
+#define L2_CACHE_H
+
+//The L2 cache is 4-way set associative, with 4K = 2^12 sets
+//(see l2_cache.c). The geometry is exported so that other
+//modules (e.g. page coloring) can be matched to it.
+#define L2_LINES_PER_SET 4
+#define L2_NUM_CACHE_SETS (1 << 12)
+
+//Addresses that differ by a multiple of this many bytes
+//map to the same L2 set.
+#define L2_BYTES_PER_WAY (L2_NUM_CACHE_SETS * BYTES_PER_CACHE_LINE)
+
+//Besides bit 0, the status byte of l2_cache_access() and
+//l2_insert_line() has the following bits (see below):
+//  bit 1: l2_cache_access(): the hit was the first demand access to
+//                            a prefetched line.
+//         l2_insert_line():  a valid line was evicted.
+//  bits 4-6: the prefetch source (the number of the prefetcher)
+//            of the line that was hit or evicted, if bit 1 is set.
+#define L2_PREFETCH_HIT_STATUS_MASK 0x2
+#define L2_EVICTED_STATUS_MASK 0x2
+#define L2_PREFETCH_SOURCE_STATUS_MASK 0x70
+#define L2_PREFETCH_SOURCE_STATUS_SHIFT 4
 
 
 /************************************************
@@ -38,6 +62,8 @@ status: this in an 8-bit output parameter (thus, a pointer to it is
         indicate whether a cache hit occurred or not:
               cache hit: bit 0 of status = 1
               cache miss: bit 0 of status = 0
+        On a hit on a line that was prefetched and not used since,
+        bit 1 is set and bits 4-6 hold the prefetch source.
 
 If the access results in a cache miss, then the only
 effect is to set the lowest bit of the status byte to 0.
@@ -81,6 +107,10 @@ status: this in an 8-bit output parameter (thus, a pointer to it is
         written back to memory or not, as follows:
             0: no write-back required
             1: evicted cache line needs to be written back.
+        If a valid line was evicted (whether or not it needs to be
+        written back), bit 1 is set and evicted_writeback_address is
+        assigned its address. If that line was prefetched and never
+        used, bits 4-6 hold its prefetch source.
 
 *********************************************************/
 
@@ -103,3 +133,78 @@ cache. It should be called periodically to support the the NRU algorithm.
 
 
 void l2_clear_r_bits();
+
+
+/************************************************
+
+       l2_probe()
+
+This procedure returns TRUE if the cache line containing the
+specified address is in the L2 cache. It has no effect on the
+state of the cache.
+
+***********************************************/
+
+BOOL l2_probe(uint32_t address);
+
+
+/************************************************
+
+       l2_set_prefetch_source()
+
+This procedure records that the cache line containing the
+specified address (which must be in the cache) was brought in
+by the specified prefetcher (1-7, see prefetch.h).
+
+***********************************************/
+
+void l2_set_prefetch_source(uint32_t address, uint8_t source);
+
+
+/************************************************
+
+       l2_invalidate_line()
+
+This procedure removes the cache line containing the specified
+address from the L2 cache, if it is there. The status byte is set
+as by l2_insert_line(): if the line is dirty, its data is copied to
+evicted_writeback_data and bit 0 is set, and if the line was in the
+cache, bit 1 is set and bits 4-6 hold its prefetch source.
+
+***********************************************/
+
+void l2_invalidate_line(uint32_t address, uint32_t evicted_writeback_data[],
+			uint8_t *status);
+
+
+/************************************************
+
+       l2_set_dead()
+
+This procedure marks the cache line containing the specified
+address as predicted dead (dead = TRUE) or not. When a line has to
+be evicted from a set, a line predicted dead is chosen first. A
+line is not predicted dead when it is inserted.
+
+***********************************************/
+
+void l2_set_dead(uint32_t address, BOOL dead);
+
+
+/************************************************
+
+       l2_write_changes(), l2_read_changes(),
+       l2_clear_changes()
+
+l2_write_changes() writes the cache sets changed since the last
+l2_clear_changes() (or every set, if all is TRUE) to a checkpoint
+file, and returns the number of sets written. l2_read_changes()
+reads them back into the cache. See checkpoint.h.
+
+***********************************************/
+
+uint32_t l2_write_changes(FILE *file, BOOL all);
+void l2_read_changes(FILE *file);
+void l2_clear_changes();
+
+#endif
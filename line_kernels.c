@@ -0,0 +1,253 @@
+/************************************************************
+
+   This file contains the cache line kernels (see line_kernels.h).
+
+   The vector versions are compiled for their instruction set with
+   the target attribute, so the rest of the simulator is still built
+   for the baseline instruction set, and are only called if the host
+   supports them.
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory_subsystem_constants.h"
+#include "line_kernels.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define LINE_KERNELS_X86
+#endif
+
+
+/************************************************************
+The portable version.
+************************************************************/
+
+static BOOL portable_supported()
+{
+    return TRUE;
+}
+
+static void portable_copy(uint32_t *destination, const uint32_t *source)
+{
+    for (int i = 0; i < WORDS_PER_CACHE_LINE; i++)
+        destination[i] = source[i];
+}
+
+static BOOL portable_equal(const uint32_t *a, const uint32_t *b)
+{
+    uint32_t difference = 0;
+    for (int i = 0; i < WORDS_PER_CACHE_LINE; i++)
+        difference |= a[i] ^ b[i];
+    return difference == 0;
+}
+
+static BOOL portable_is_zero(const uint32_t *line)
+{
+    uint32_t bits = 0;
+    for (int i = 0; i < WORDS_PER_CACHE_LINE; i++)
+        bits |= line[i];
+    return bits == 0;
+}
+
+static const LINE_KERNELS portable_kernels = {
+    "portable",
+    portable_supported,
+    portable_copy,
+    portable_equal,
+    portable_is_zero
+};
+
+
+#ifdef LINE_KERNELS_X86
+
+/************************************************************
+The SSE2 version: 4 16-byte vectors per line.
+************************************************************/
+
+static BOOL sse2_supported()
+{
+    return __builtin_cpu_supports("sse2");
+}
+
+__attribute__((target("sse2")))
+static void sse2_copy(uint32_t *destination, const uint32_t *source)
+{
+    __m128i *d = (__m128i *) destination;
+    const __m128i *s = (const __m128i *) source;
+    __m128i v0 = _mm_loadu_si128(s);
+    __m128i v1 = _mm_loadu_si128(s + 1);
+    __m128i v2 = _mm_loadu_si128(s + 2);
+    __m128i v3 = _mm_loadu_si128(s + 3);
+    _mm_storeu_si128(d, v0);
+    _mm_storeu_si128(d + 1, v1);
+    _mm_storeu_si128(d + 2, v2);
+    _mm_storeu_si128(d + 3, v3);
+}
+
+__attribute__((target("sse2")))
+static BOOL sse2_equal(const uint32_t *a, const uint32_t *b)
+{
+    const __m128i *x = (const __m128i *) a;
+    const __m128i *y = (const __m128i *) b;
+    __m128i same = _mm_and_si128(_mm_cmpeq_epi32(_mm_loadu_si128(x), _mm_loadu_si128(y)),
+                                 _mm_cmpeq_epi32(_mm_loadu_si128(x + 1), _mm_loadu_si128(y + 1)));
+    same = _mm_and_si128(same, _mm_cmpeq_epi32(_mm_loadu_si128(x + 2), _mm_loadu_si128(y + 2)));
+    same = _mm_and_si128(same, _mm_cmpeq_epi32(_mm_loadu_si128(x + 3), _mm_loadu_si128(y + 3)));
+    return _mm_movemask_epi8(same) == 0xffff;
+}
+
+__attribute__((target("sse2")))
+static BOOL sse2_is_zero(const uint32_t *line)
+{
+    const __m128i *x = (const __m128i *) line;
+    __m128i bits = _mm_or_si128(_mm_or_si128(_mm_loadu_si128(x), _mm_loadu_si128(x + 1)),
+                                _mm_or_si128(_mm_loadu_si128(x + 2), _mm_loadu_si128(x + 3)));
+    return _mm_movemask_epi8(_mm_cmpeq_epi32(bits, _mm_setzero_si128())) == 0xffff;
+}
+
+static const LINE_KERNELS sse2_kernels = {
+    "sse2",
+    sse2_supported,
+    sse2_copy,
+    sse2_equal,
+    sse2_is_zero
+};
+
+
+/************************************************************
+The AVX2 version: 2 32-byte vectors per line.
+************************************************************/
+
+static BOOL avx2_supported()
+{
+    return __builtin_cpu_supports("avx2");
+}
+
+__attribute__((target("avx2")))
+static void avx2_copy(uint32_t *destination, const uint32_t *source)
+{
+    __m256i *d = (__m256i *) destination;
+    const __m256i *s = (const __m256i *) source;
+    __m256i v0 = _mm256_loadu_si256(s);
+    __m256i v1 = _mm256_loadu_si256(s + 1);
+    _mm256_storeu_si256(d, v0);
+    _mm256_storeu_si256(d + 1, v1);
+}
+
+__attribute__((target("avx2")))
+static BOOL avx2_equal(const uint32_t *a, const uint32_t *b)
+{
+    const __m256i *x = (const __m256i *) a;
+    const __m256i *y = (const __m256i *) b;
+    __m256i difference = _mm256_or_si256(_mm256_xor_si256(_mm256_loadu_si256(x), _mm256_loadu_si256(y)),
+                                         _mm256_xor_si256(_mm256_loadu_si256(x + 1), _mm256_loadu_si256(y + 1)));
+    return _mm256_testz_si256(difference, difference);
+}
+
+__attribute__((target("avx2")))
+static BOOL avx2_is_zero(const uint32_t *line)
+{
+    const __m256i *x = (const __m256i *) line;
+    __m256i bits = _mm256_or_si256(_mm256_loadu_si256(x), _mm256_loadu_si256(x + 1));
+    return _mm256_testz_si256(bits, bits);
+}
+
+static const LINE_KERNELS avx2_kernels = {
+    "avx2",
+    avx2_supported,
+    avx2_copy,
+    avx2_equal,
+    avx2_is_zero
+};
+
+
+/************************************************************
+The AVX-512 version: a single 64-byte vector per line.
+************************************************************/
+
+static BOOL avx512_supported()
+{
+    return __builtin_cpu_supports("avx512f");
+}
+
+__attribute__((target("avx512f")))
+static void avx512_copy(uint32_t *destination, const uint32_t *source)
+{
+    _mm512_storeu_si512(destination, _mm512_loadu_si512(source));
+}
+
+__attribute__((target("avx512f")))
+static BOOL avx512_equal(const uint32_t *a, const uint32_t *b)
+{
+    return _mm512_cmpneq_epi32_mask(_mm512_loadu_si512(a), _mm512_loadu_si512(b)) == 0;
+}
+
+__attribute__((target("avx512f")))
+static BOOL avx512_is_zero(const uint32_t *line)
+{
+    __m512i bits = _mm512_loadu_si512(line);
+    return _mm512_test_epi32_mask(bits, bits) == 0;
+}
+
+static const LINE_KERNELS avx512_kernels = {
+    "avx512",
+    avx512_supported,
+    avx512_copy,
+    avx512_equal,
+    avx512_is_zero
+};
+
+#endif
+
+
+//The versions of the kernels, best first.
+
+static const LINE_KERNELS *line_kernels_versions[] = {
+#ifdef LINE_KERNELS_X86
+    &avx512_kernels,
+    &avx2_kernels,
+    &sse2_kernels,
+#endif
+    &portable_kernels
+};
+
+#define LINE_KERNELS_NUM_VERSIONS (sizeof(line_kernels_versions) / sizeof(line_kernels_versions[0]))
+
+const LINE_KERNELS *line_kernels = &portable_kernels;
+
+
+/************************************************
+
+       line_kernels_select()
+
+***********************************************/
+
+BOOL line_kernels_select(const char *name)
+{
+#ifdef LINE_KERNELS_X86
+    __builtin_cpu_init();
+#endif
+    for (uint32_t i = 0; i < LINE_KERNELS_NUM_VERSIONS; i++) {
+        const LINE_KERNELS *version = line_kernels_versions[i];
+        if (((name == NULL) || !strcmp(name, version->name)) && version->supported()) {
+            line_kernels = version;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+
+//Selects the best version when the program starts, so that the
+//kernels are in place before any cache is initialized.
+
+__attribute__((constructor))
+static void line_kernels_startup()
+{
+    line_kernels_select(NULL);
+}
@@ -0,0 +1,77 @@
+/************************************************************
+
+    Cache line kernels: copying, comparing and zero-testing
+    16-word (64-byte) cache lines.
+
+Every transfer of a whole cache line between the L1 and L2 caches,
+main memory and the line buffers of the memory subsystem is done with
+line_copy(). There are SSE2, AVX2 and AVX-512 versions of the
+kernels, each moving a line in 4, 2 or 1 vector loads and stores, as
+well as a portable version. When the program starts, the best version
+the host supports is selected (see line_kernels_select()).
+
+Lines may be at any address (and need not be aligned), but the
+vector accesses to a line aligned on 64 bytes, such as an L1 cache
+line (see l1_cache.h), never straddle two host cache lines.
+
+************************************************************/
+
+/***************************************************
+This struct describes a version of the kernels. It
+has the following fields:
+  name: "portable", "sse2", "avx2" or "avx512".
+  supported: returns TRUE if the host can run the kernels.
+  copy: copies a line from source to destination.
+  equal: returns TRUE if two lines hold the same words.
+  is_zero: returns TRUE if all the words of a line are 0.
+****************************************************/
+
+typedef struct {
+  const char *name;
+  BOOL (*supported)();
+  void (*copy)(uint32_t *destination, const uint32_t *source);
+  BOOL (*equal)(const uint32_t *a, const uint32_t *b);
+  BOOL (*is_zero)(const uint32_t *line);
+} LINE_KERNELS;
+
+//The kernels in use.
+extern const LINE_KERNELS *line_kernels;
+
+
+/************************************************
+
+       line_copy(), line_equal(), line_is_zero()
+
+These procedures call the kernels in use.
+
+***********************************************/
+
+static inline void line_copy(uint32_t destination[], const uint32_t source[])
+{
+    line_kernels->copy(destination, source);
+}
+
+static inline BOOL line_equal(const uint32_t a[], const uint32_t b[])
+{
+    return line_kernels->equal(a, b);
+}
+
+static inline BOOL line_is_zero(const uint32_t line[])
+{
+    return line_kernels->is_zero(line);
+}
+
+
+/************************************************
+
+       line_kernels_select()
+
+This procedure selects the version of the kernels with the specified
+name, or, if name is NULL, the best version the host supports (which
+is what is selected when the program starts). It returns FALSE, and
+leaves the kernels in use as they are, if there is no such version or
+the host does not support it.
+
+***********************************************/
+
+BOOL line_kernels_select(const char *name);
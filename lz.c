@@ -0,0 +1,162 @@
+/************************************************************
+
+   This file contains the LZ codec (see lz.h).
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "lz.h"
+
+//The match finder hashes the next LZ_MIN_MATCH bytes into a table
+//of the last position where each hash was seen.
+#define LZ_HASH_BITS 12
+#define LZ_NO_POSITION 0xffffffff
+
+static uint32_t lz_read32(const uint8_t *p)
+{
+    uint32_t value;
+    memcpy(&value, p, 4);
+    return value;
+}
+
+
+//Writes a length continued past 15 (see lz.h). Returns the new
+//output position, or capacity + 1 if there is no room.
+
+static uint32_t lz_write_length(uint8_t *output, uint32_t op, uint32_t capacity, uint32_t length)
+{
+    for (; length >= 255; length -= 255) {
+        if (op >= capacity)
+            return capacity + 1;
+        output[op++] = 255;
+    }
+    if (op >= capacity)
+        return capacity + 1;
+    output[op++] = (uint8_t) length;
+    return op;
+}
+
+
+//Writes a sequence of literal_length literals followed, if
+//match_length is not 0, by a match. Returns the new output
+//position, or capacity + 1 if there is no room.
+
+static uint32_t lz_write_sequence(uint8_t *output, uint32_t op, uint32_t capacity,
+				  const uint8_t *literals, uint32_t literal_length,
+				  uint32_t offset, uint32_t match_length)
+{
+    uint32_t match_code = match_length ? match_length - LZ_MIN_MATCH : 0;
+
+    if (op >= capacity)
+        return capacity + 1;
+    output[op++] = (uint8_t) (((literal_length < 15 ? literal_length : 15) << 4) | (match_code < 15 ? match_code : 15));
+    if (literal_length >= 15)
+        op = lz_write_length(output, op, capacity, literal_length - 15);
+    if ((op > capacity) || (op + literal_length > capacity))
+        return capacity + 1;
+    memcpy(&output[op], literals, literal_length);
+    op += literal_length;
+    if (match_length == 0)
+        return op;
+    if (op + 2 > capacity)
+        return capacity + 1;
+    output[op++] = offset & 0xff;
+    output[op++] = offset >> 8;
+    if (match_code >= 15)
+        op = lz_write_length(output, op, capacity, match_code - 15);
+    return op;
+}
+
+
+uint32_t lz_compress(const uint8_t *input, uint32_t size, uint8_t *output, uint32_t capacity)
+{
+    uint32_t table[1 << LZ_HASH_BITS];
+    uint32_t ip = 0, anchor = 0, op = 0;
+
+    for (int i = 0; i < (1 << LZ_HASH_BITS); i++)
+        table[i] = LZ_NO_POSITION;
+
+    while (ip + LZ_MIN_MATCH <= size) {
+        uint32_t sequence = lz_read32(&input[ip]);
+        uint32_t hash = (sequence * 2654435761u) >> (32 - LZ_HASH_BITS);
+        uint32_t ref = table[hash];
+        table[hash] = ip;
+        if ((ref == LZ_NO_POSITION) || (ip - ref > LZ_MAX_OFFSET) || (lz_read32(&input[ref]) != sequence)) {
+            ip++;
+            continue;
+        }
+
+      //Extend the match as far as it goes.
+
+        uint32_t length = LZ_MIN_MATCH;
+        while ((ip + length < size) && (input[ref + length] == input[ip + length]))
+            length++;
+        op = lz_write_sequence(output, op, capacity, &input[anchor], ip - anchor, ip - ref, length);
+        if (op > capacity)
+            return 0;
+        ip += length;
+        anchor = ip;
+    }
+
+  //The rest of the input is literals.
+
+    op = lz_write_sequence(output, op, capacity, &input[anchor], size - anchor, 0, 0);
+    return (op > capacity) ? 0 : op;
+}
+
+
+//Reads a length continued past 15 (see lz.h) into *length. Returns
+//the new input position, or size + 1 if the input ends first.
+
+static uint32_t lz_read_length(const uint8_t *input, uint32_t ip, uint32_t size, uint32_t *length)
+{
+    uint8_t byte;
+    do {
+        if (ip >= size)
+            return size + 1;
+        byte = input[ip++];
+        *length += byte;
+    } while (byte == 255);
+    return ip;
+}
+
+
+uint32_t lz_decompress(const uint8_t *input, uint32_t size, uint8_t *output, uint32_t capacity)
+{
+    uint32_t ip = 0, op = 0;
+
+    while (ip < size) {
+        uint8_t token = input[ip++];
+        uint32_t literal_length = token >> 4;
+        if (literal_length == 15)
+            ip = lz_read_length(input, ip, size, &literal_length);
+        if ((ip > size) || (ip + literal_length > size) || (op + literal_length > capacity))
+            return 0;
+        memcpy(&output[op], &input[ip], literal_length);
+        ip += literal_length;
+        op += literal_length;
+        if (ip == size)
+            break;
+
+      //The match may overlap the bytes it produces, so it is
+      //copied a byte at a time.
+
+        if (ip + 2 > size)
+            return 0;
+        uint32_t offset = input[ip] | (input[ip + 1] << 8);
+        ip += 2;
+        uint32_t match_length = token & 0xf;
+        if (match_length == 15)
+            ip = lz_read_length(input, ip, size, &match_length);
+        match_length += LZ_MIN_MATCH;
+        if ((ip > size) || (offset == 0) || (offset > op) || (op + match_length > capacity))
+            return 0;
+        for (uint32_t i = 0; i < match_length; i++, op++)
+            output[op] = output[op - offset];
+    }
+    return op;
+}
@@ -0,0 +1,46 @@
+/************************************************************
+
+    A small LZ77 codec, in the style of LZ4, used to compress
+    the pages of the compressed memory tier (see
+    compressed_memory.h).
+
+The compressed data is a series of sequences, each made of a token
+byte, literals and a match. The high 4 bits of the token hold the
+number of literals and the low 4 bits the match length minus
+LZ_MIN_MATCH; a value of 15 is continued by bytes that are added to
+it, up to the first byte that is not 255. The literals are then
+copied as is, followed by the match offset (2 bytes, little endian):
+the match is a copy of the match length bytes starting that many
+bytes back in the output. The last sequence only has literals.
+
+************************************************************/
+
+#define LZ_MIN_MATCH 4
+#define LZ_MAX_OFFSET 65535
+
+
+/************************************************
+
+       lz_compress()
+
+This procedure compresses size bytes from input into output, which
+has room for capacity bytes. It returns the size of the compressed
+data, or 0 if it does not fit in capacity bytes.
+
+***********************************************/
+
+uint32_t lz_compress(const uint8_t *input, uint32_t size, uint8_t *output, uint32_t capacity);
+
+
+/************************************************
+
+       lz_decompress()
+
+This procedure decompresses size bytes of compressed data from
+input into output, which has room for capacity bytes. It returns
+the size of the decompressed data, or 0 if the compressed data is
+invalid or does not fit in capacity bytes.
+
+***********************************************/
+
+uint32_t lz_decompress(const uint8_t *input, uint32_t size, uint8_t *output, uint32_t capacity);
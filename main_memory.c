@@ -1,9 +1,15 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
 
 #include "memory_subsystem_constants.h"
 #include "main_memory.h"
+#include "line_kernels.h"
 
 //main memory is just a (dynamically allocated) array
 //of unsigned 32-bit words.
@@ -12,6 +18,279 @@ uint32_t *main_memory;
 
 uint32_t main_memory_size_in_bytes;
 
+//Set by main_memory_use_file(). main_memory_mapped is TRUE if
+//main_memory is currently mapped from main_memory_file_path.
+const char *main_memory_file_path = NULL;
+const char *main_memory_image_path = NULL;
+BOOL main_memory_mapped = FALSE;
+
+//The file descriptor of the mapped file, kept open so that it can be
+//mapped again (see main_memory_make_private()), and the last advice
+//given (see main_memory_advise()).
+int main_memory_fd = -1;
+uint8_t main_memory_advice;
+
+//Set by main_memory_deduplicate(). main_memory_deduplicated is TRUE
+//if main memory is currently stored as deduplicated lines (see below),
+//in which case main_memory is NULL.
+BOOL main_memory_dedup_requested = FALSE;
+BOOL main_memory_deduplicated = FALSE;
+
+//The host page faults when main memory was initialized.
+long main_memory_minor_faults;
+long main_memory_major_faults;
+
+//One bit per page, set when the page is written (see
+//main_memory_write_changes()).
+uint32_t *main_memory_changed_pages;
+uint32_t main_memory_num_pages;
+//Nothing is tracked until the first checkpoint.
+BOOL main_memory_tracking_changes = FALSE;
+#define MAIN_MEMORY_MARK_CHANGED(page) \
+    do { \
+        if (main_memory_tracking_changes) \
+            main_memory_changed_pages[(page) >> 5] |= 1u << ((page) & 31); \
+    } while (0)
+#define MAIN_MEMORY_CHANGED(page) (main_memory_changed_pages[(page) >> 5] & (1u << ((page) & 31)))
+
+
+/************************************************************************
+A deduplicated main memory is made of a line map, which gives for each
+cache line of memory the slot of the line store holding its contents,
+and the line store. Each slot of the line store holds the contents of
+a line, their hash, the number of lines of memory that refer to it and
+the next slot in its hash chain (or, for a free slot, the next free
+slot). Lines are found by contents through a hash table of chains.
+At first, all of memory refers to slot 0, which holds a zero line.
+*************************************************************************/
+
+#define MAIN_MEMORY_NO_SLOT 0xffffffff
+#define MAIN_MEMORY_INITIAL_SLOTS 1024
+
+uint32_t *main_memory_line_map;
+uint32_t main_memory_num_lines;
+
+uint32_t *main_memory_store;        //WORDS_PER_CACHE_LINE words per slot
+uint32_t *main_memory_slot_hash;
+uint32_t *main_memory_slot_refs;
+uint32_t *main_memory_slot_next;
+uint32_t main_memory_num_slots;     //slots allocated, also the number of hash chains
+uint32_t main_memory_new_slot;      //slots below this one have been used
+uint32_t main_memory_free_slot;     //first free slot, or MAIN_MEMORY_NO_SLOT
+uint32_t main_memory_used_slots;    //slots holding the contents of some lines
+uint32_t *main_memory_chains;
+
+uint64_t main_memory_dedup_writes;
+uint64_t main_memory_dedup_shared;  //writes of contents that were already stored
+uint64_t main_memory_dedup_copies;  //writes to a line sharing its slot
+
+
+static uint32_t main_memory_line_hash(const uint32_t *words)
+{
+    uint32_t hash = 0x811c9dc5;
+    for (int i = 0; i < WORDS_PER_CACHE_LINE; i++) {
+        hash = (hash ^ words[i]) * 0x9e3779b1;
+        hash ^= hash >> 16;
+    }
+    return hash;
+}
+
+
+static void main_memory_link_slot(uint32_t slot)
+{
+    uint32_t *chain = &main_memory_chains[main_memory_slot_hash[slot] & (main_memory_num_slots - 1)];
+    main_memory_slot_next[slot] = *chain;
+    *chain = slot;
+}
+
+
+static void main_memory_unlink_slot(uint32_t slot)
+{
+    uint32_t *chain = &main_memory_chains[main_memory_slot_hash[slot] & (main_memory_num_slots - 1)];
+    while (*chain != slot)
+        chain = &main_memory_slot_next[*chain];
+    *chain = main_memory_slot_next[slot];
+}
+
+
+//Returns the slot holding the specified contents, or
+//MAIN_MEMORY_NO_SLOT if they are not stored.
+
+static uint32_t main_memory_find_slot(const uint32_t *words, uint32_t hash)
+{
+    uint32_t slot = main_memory_chains[hash & (main_memory_num_slots - 1)];
+    while (slot != MAIN_MEMORY_NO_SLOT) {
+        if ((main_memory_slot_hash[slot] == hash) &&
+            line_equal(&main_memory_store[slot * WORDS_PER_CACHE_LINE], words))
+            return slot;
+        slot = main_memory_slot_next[slot];
+    }
+    return MAIN_MEMORY_NO_SLOT;
+}
+
+
+//Returns a free slot. When all the slots are in use, the line store
+//and the hash table are doubled in size, and the slots rehashed.
+
+static uint32_t main_memory_allocate_slot()
+{
+    uint32_t slot = main_memory_free_slot;
+    if (slot != MAIN_MEMORY_NO_SLOT) {
+        main_memory_free_slot = main_memory_slot_next[slot];
+        return slot;
+    }
+    if (main_memory_new_slot == main_memory_num_slots) {
+        main_memory_num_slots *= 2;
+        main_memory_store = realloc(main_memory_store, (size_t) main_memory_num_slots * BYTES_PER_CACHE_LINE);
+        main_memory_slot_hash = realloc(main_memory_slot_hash, (size_t) main_memory_num_slots * 4);
+        main_memory_slot_refs = realloc(main_memory_slot_refs, (size_t) main_memory_num_slots * 4);
+        main_memory_slot_next = realloc(main_memory_slot_next, (size_t) main_memory_num_slots * 4);
+        main_memory_chains = realloc(main_memory_chains, (size_t) main_memory_num_slots * 4);
+        if (!main_memory_store || !main_memory_slot_hash || !main_memory_slot_refs ||
+            !main_memory_slot_next || !main_memory_chains) {
+            printf("Error: out of memory for the deduplicated main memory\n");
+            exit(1);
+        }
+        memset(main_memory_chains, 0xff, (size_t) main_memory_num_slots * 4);
+        for (uint32_t i = 0; i < main_memory_new_slot; i++)
+            main_memory_link_slot(i);
+    }
+    return main_memory_new_slot++;
+}
+
+
+//Drops a reference to a slot, freeing it if it was the last one.
+
+static void main_memory_release_slot(uint32_t slot)
+{
+    if (--main_memory_slot_refs[slot] == 0) {
+        main_memory_unlink_slot(slot);
+        main_memory_slot_next[slot] = main_memory_free_slot;
+        main_memory_free_slot = slot;
+        main_memory_used_slots--;
+    }
+}
+
+
+//Stores the contents of a line of a deduplicated main memory. The
+//line shares the slot of the same contents if they are already
+//stored. Otherwise, if the line is the only one using its slot, the
+//slot is written in place; if not, it gets a slot of its own (copy
+//on write).
+
+static void main_memory_store_line(uint32_t line, const uint32_t *words)
+{
+    uint32_t old_slot = main_memory_line_map[line];
+    uint32_t hash = main_memory_line_hash(words);
+    uint32_t slot = main_memory_find_slot(words, hash);
+
+    main_memory_dedup_writes++;
+    if (slot == old_slot)
+        return;
+    if (slot != MAIN_MEMORY_NO_SLOT) {
+        main_memory_dedup_shared++;
+        main_memory_slot_refs[slot]++;
+    }
+    else if (main_memory_slot_refs[old_slot] == 1) {
+        main_memory_unlink_slot(old_slot);
+        line_copy(&main_memory_store[old_slot * WORDS_PER_CACHE_LINE], words);
+        main_memory_slot_hash[old_slot] = hash;
+        main_memory_link_slot(old_slot);
+        return;
+    }
+    else {
+        main_memory_dedup_copies++;
+        slot = main_memory_allocate_slot();
+        line_copy(&main_memory_store[slot * WORDS_PER_CACHE_LINE], words);
+        main_memory_slot_hash[slot] = hash;
+        main_memory_slot_refs[slot] = 1;
+        main_memory_link_slot(slot);
+        main_memory_used_slots++;
+    }
+    main_memory_line_map[line] = slot;
+    main_memory_release_slot(old_slot);
+}
+
+
+//Makes all of a deduplicated main memory refer to a single zero line,
+//freeing the rest of the line store.
+
+static void main_memory_dedup_clear()
+{
+    free(main_memory_line_map);
+    free(main_memory_store);
+    free(main_memory_slot_hash);
+    free(main_memory_slot_refs);
+    free(main_memory_slot_next);
+    free(main_memory_chains);
+
+  //calloc() leaves the line map to the host's zero pages until it
+  //is written.
+
+    main_memory_line_map = calloc(main_memory_num_lines, sizeof(uint32_t));
+    main_memory_num_slots = MAIN_MEMORY_INITIAL_SLOTS;
+    main_memory_store = calloc(main_memory_num_slots, BYTES_PER_CACHE_LINE);
+    main_memory_slot_hash = malloc(main_memory_num_slots * 4);
+    main_memory_slot_refs = malloc(main_memory_num_slots * 4);
+    main_memory_slot_next = malloc(main_memory_num_slots * 4);
+    main_memory_chains = malloc(main_memory_num_slots * 4);
+    if (!main_memory_line_map || !main_memory_store) {
+        printf("Error: out of memory for the deduplicated main memory\n");
+        exit(1);
+    }
+    memset(main_memory_chains, 0xff, main_memory_num_slots * 4);
+    main_memory_slot_hash[0] = main_memory_line_hash(main_memory_store);
+    main_memory_slot_refs[0] = main_memory_num_lines;
+    main_memory_link_slot(0);
+    main_memory_new_slot = 1;
+    main_memory_free_slot = MAIN_MEMORY_NO_SLOT;
+    main_memory_used_slots = 1;
+}
+
+
+//Creates the file backing main memory as a sparse file, preloads
+//the image, if any, and maps the file as main_memory.
+
+static void main_memory_map_file(uint32_t size_in_bytes)
+{
+    int fd = open(main_memory_file_path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if ((fd < 0) || (ftruncate(fd, size_in_bytes) != 0)) {
+        printf("Error: cannot create %s\n", main_memory_file_path);
+        exit(1);
+    }
+
+  //The image is written through the file, rather than the mapping,
+  //so that it doesn't have to be faulted in page by page.
+
+    if (main_memory_image_path) {
+        static char buffer[1 << 16];
+        FILE *image = fopen(main_memory_image_path, "rb");
+        uint64_t offset = 0;
+        size_t n;
+        if (image == NULL) {
+            printf("Error: cannot open %s\n", main_memory_image_path);
+            exit(1);
+        }
+        while ((n = fread(buffer, 1, sizeof(buffer), image)) > 0) {
+            if ((offset + n > size_in_bytes) || (pwrite(fd, buffer, n, offset) != (ssize_t) n)) {
+                printf("Error: the image %s does not fit in main memory\n", main_memory_image_path);
+                exit(1);
+            }
+            offset += n;
+        }
+        fclose(image);
+    }
+
+    main_memory = mmap(NULL, size_in_bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (main_memory == MAP_FAILED) {
+        printf("Error: cannot map %s\n", main_memory_file_path);
+        exit(1);
+    }
+    main_memory_fd = fd;
+    main_memory_mapped = TRUE;
+    main_memory_advise(MAIN_MEMORY_ADVICE_RANDOM);
+}
+
 
 /************************************************************************
                  main_memory_initialize
@@ -29,10 +308,35 @@ void main_memory_initialize(uint32_t size_in_bytes)  // 33554432
     exit(1);
   }
 
-  //Allocate the main memory, using malloc
+  //Allocate the main memory, using malloc, or map it from a file.
 
-  main_memory = malloc(size_in_bytes);
+  if (main_memory_file_path && main_memory_dedup_requested) {
+      printf("Error: a file-backed main memory cannot be deduplicated\n");
+      exit(1);
+  }
+  if (main_memory_mapped) {
+      munmap(main_memory, main_memory_size_in_bytes);
+      close(main_memory_fd);
+      main_memory_mapped = FALSE;
+  }
+  else {
+      free(main_memory);
+  }
+  main_memory = NULL;
   main_memory_size_in_bytes = size_in_bytes;
+  main_memory_deduplicated = main_memory_dedup_requested;
+  if (main_memory_file_path) {
+      main_memory_map_file(size_in_bytes);
+  }
+  else if (main_memory_deduplicated) {
+      main_memory_num_lines = size_in_bytes / BYTES_PER_CACHE_LINE;
+      main_memory_dedup_clear();
+      main_memory_dedup_writes = 0;
+      main_memory_dedup_shared = 0;
+      main_memory_dedup_copies = 0;
+  }
+  else {
+      main_memory = malloc(size_in_bytes);
 
   //Write a 0 to each word in main memory. Note that the 
   //size_in_bytes parameter specifies the size of main memory
@@ -41,9 +345,21 @@ void main_memory_initialize(uint32_t size_in_bytes)  // 33554432
   //(not a byte at a time). Obviously, the size of main memory
   //in words is 1/4 of the size of main memory in bytes.
 
-  uint32_t size_in_words = size_in_bytes >> 2;
-  for (uint32_t i=0; i < size_in_words; i++)
-      main_memory[i] = 0;
+      uint32_t size_in_words = size_in_bytes >> 2;
+      for (uint32_t i=0; i < size_in_words; i++)
+          main_memory[i] = 0;
+  }
+
+  //No page has been written yet. The last page may be partial.
+
+  main_memory_num_pages = (size_in_bytes + MAIN_MEMORY_PAGE_SIZE - 1) >> MAIN_MEMORY_PAGE_SHIFT;
+  free(main_memory_changed_pages);
+  main_memory_changed_pages = calloc((main_memory_num_pages + 31) / 32, sizeof(uint32_t));
+
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+  main_memory_minor_faults = usage.ru_minflt;
+  main_memory_major_faults = usage.ru_majflt;
 }
   
 
@@ -100,23 +416,262 @@ void main_memory_access(uint32_t address, uint32_t write_data[],
 
   uint32_t cache_line_address = (address & CACHE_LINE_ADDRESS_MASK) / 4;
 
+  //A deduplicated main memory reads the line from its slot, and
+  //writes it through main_memory_store_line().
+
+  if (main_memory_deduplicated) {
+      uint32_t line = cache_line_address / WORDS_PER_CACHE_LINE;
+      if (control & READ_ENABLE_MASK)
+          line_copy(read_data, &main_memory_store[main_memory_line_map[line] * WORDS_PER_CACHE_LINE]);
+      if (control & WRITE_ENABLE_MASK) {
+          main_memory_store_line(line, write_data);
+          MAIN_MEMORY_MARK_CHANGED(address >> MAIN_MEMORY_PAGE_SHIFT);
+      }
+      return;
+  }
+
   //If the read-enable bit of the control parameter is set (i.e. is 1), 
   //then copy the cache line starting at cache_line_address into read_data.
   //See memory_subsystem_constants.h for masks that are convenient for
   //testing the bits of the control parameter.
   
   if (control & READ_ENABLE_MASK) {
-      for (int i = 0; i < 16; i++) {
-          read_data[i] = main_memory[cache_line_address + i];
-      }
+      line_copy(read_data, &main_memory[cache_line_address]);
   }
   
   //If the write-enable bit of the control parameter is set then copy
   //write_data into the cache line starting at cache_line_address.
 
   if (control & WRITE_ENABLE_MASK) {
-      for (int i = 0; i < 16; i++) {
-          main_memory[cache_line_address + i] = write_data[i];
-      }
+      line_copy(&main_memory[cache_line_address], write_data);
+      MAIN_MEMORY_MARK_CHANGED(address >> MAIN_MEMORY_PAGE_SHIFT);
   }
-}
\ No newline at end of file
+}
+
+
+/************************************************
+
+       main_memory_write_changes(), main_memory_read_changes(),
+       main_memory_clear_changes()
+
+A checkpoint holds the number of pages, followed by the number
+and contents of each page.
+
+***********************************************/
+
+//Returns the size in words of the specified page.
+static uint32_t main_memory_page_words(uint32_t page)
+{
+    uint32_t end = (page + 1) << MAIN_MEMORY_PAGE_SHIFT;
+    if (end > main_memory_size_in_bytes)
+        end = main_memory_size_in_bytes;
+    return (end - (page << MAIN_MEMORY_PAGE_SHIFT)) / 4;
+}
+
+
+//Returns the words of the specified page: in main memory itself or,
+//for a deduplicated main memory, copied into a buffer.
+static uint32_t *main_memory_page(uint32_t page)
+{
+    static uint32_t buffer[MAIN_MEMORY_PAGE_SIZE / 4];
+    if (!main_memory_deduplicated)
+        return &main_memory[page << (MAIN_MEMORY_PAGE_SHIFT - 2)];
+    main_memory_read_page(page, buffer);
+    return buffer;
+}
+
+
+//Returns TRUE if the specified page is to be written to a checkpoint.
+static BOOL main_memory_page_saved(uint32_t page, BOOL all)
+{
+    if (!all)
+        return MAIN_MEMORY_CHANGED(page) != 0;
+    uint32_t *words = main_memory_page(page);
+    for (uint32_t i = 0; i < main_memory_page_words(page); i += WORDS_PER_CACHE_LINE) {
+        if (!line_is_zero(&words[i]))
+            return TRUE;
+    }
+    return FALSE;
+}
+
+
+uint32_t main_memory_write_changes(FILE *file, BOOL all)
+{
+    uint32_t count = 0;
+    for (uint32_t page = 0; page < main_memory_num_pages; page++) {
+        if (main_memory_page_saved(page, all))
+            count++;
+    }
+    fwrite(&count, sizeof(count), 1, file);
+    for (uint32_t page = 0; page < main_memory_num_pages; page++) {
+        if (main_memory_page_saved(page, all)) {
+            fwrite(&page, sizeof(page), 1, file);
+            fwrite(main_memory_page(page), 4, main_memory_page_words(page), file);
+        }
+    }
+    return count;
+}
+
+
+void main_memory_read_changes(FILE *file, BOOL all)
+{
+    uint32_t count, page;
+
+  //Only nonzero words are cleared, so that the untouched pages of a
+  //file-backed main memory stay untouched. A deduplicated main memory
+  //just goes back to a single zero line.
+
+    if (all && !main_memory_deduplicated) {
+        for (uint32_t i = 0; i < main_memory_size_in_bytes >> 2; i++) {
+            if (main_memory[i])
+                main_memory[i] = 0;
+        }
+    }
+    else if (all) {
+        main_memory_dedup_clear();
+    }
+    if (fread(&count, sizeof(count), 1, file) != 1) {
+        printf("Error: truncated main memory checkpoint\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t *words;
+        if ((fread(&page, sizeof(page), 1, file) != 1) || (page >= main_memory_num_pages) ||
+            (fread(words = main_memory_page(page), 4, main_memory_page_words(page), file)
+             != main_memory_page_words(page))) {
+            printf("Error: truncated main memory checkpoint\n");
+            exit(1);
+        }
+        if (main_memory_deduplicated)
+            main_memory_write_page(page, words);
+    }
+}
+
+
+void main_memory_clear_changes()
+{
+    for (uint32_t i = 0; i < (main_memory_num_pages + 31) / 32; i++)
+        main_memory_changed_pages[i] = 0;
+    main_memory_tracking_changes = TRUE;
+}
+
+
+/************************************************************************
+                 main_memory_read_page, main_memory_write_page
+*************************************************************************/
+
+void main_memory_read_page(uint32_t page, uint32_t words[])
+{
+    uint32_t first_word = page << (MAIN_MEMORY_PAGE_SHIFT - 2);
+    if (!main_memory_deduplicated) {
+        memcpy(words, &main_memory[first_word], main_memory_page_words(page) * 4);
+        return;
+    }
+    for (uint32_t i = 0; i < main_memory_page_words(page); i += WORDS_PER_CACHE_LINE)
+        line_copy(&words[i], &main_memory_store[main_memory_line_map[(first_word + i) / WORDS_PER_CACHE_LINE]
+                                                * WORDS_PER_CACHE_LINE]);
+}
+
+
+void main_memory_write_page(uint32_t page, const uint32_t words[])
+{
+    uint32_t first_word = page << (MAIN_MEMORY_PAGE_SHIFT - 2);
+    if (!main_memory_deduplicated) {
+        memcpy(&main_memory[first_word], words, main_memory_page_words(page) * 4);
+        return;
+    }
+    for (uint32_t i = 0; i < main_memory_page_words(page); i += WORDS_PER_CACHE_LINE)
+        main_memory_store_line((first_word + i) / WORDS_PER_CACHE_LINE, &words[i]);
+}
+
+
+/************************************************************************
+                 main_memory_use_file, main_memory_deduplicate,
+                 main_memory_advise, main_memory_dedup_ratio,
+                 main_memory_report
+*************************************************************************/
+
+void main_memory_use_file(const char *path, const char *image_path)
+{
+    main_memory_file_path = path;
+    main_memory_image_path = image_path;
+}
+
+
+void main_memory_deduplicate(BOOL enabled)
+{
+    main_memory_dedup_requested = enabled;
+}
+
+
+void main_memory_advise(uint8_t advice)
+{
+    int advices[] = {MADV_NORMAL, MADV_RANDOM, MADV_SEQUENTIAL};
+    if (main_memory_mapped && (advice <= MAIN_MEMORY_ADVICE_SEQUENTIAL)) {
+        madvise(main_memory, main_memory_size_in_bytes, advices[advice]);
+        main_memory_advice = advice;
+    }
+}
+
+
+void main_memory_make_private()
+{
+    if (!main_memory_mapped)
+        return;
+    if (mmap(main_memory, main_memory_size_in_bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED,
+             main_memory_fd, 0) == MAP_FAILED) {
+        printf("Error: cannot map %s privately\n", main_memory_file_path);
+        exit(1);
+    }
+    main_memory_advise(main_memory_advice);
+}
+
+
+double main_memory_dedup_ratio()
+{
+    if (!main_memory_deduplicated)
+        return 1.0;
+    return (double) main_memory_num_lines / main_memory_used_slots;
+}
+
+
+void main_memory_report()
+{
+    if (main_memory_deduplicated) {
+        uint64_t host_bytes = (uint64_t) main_memory_num_lines * 4 +
+                              (uint64_t) main_memory_num_slots * (BYTES_PER_CACHE_LINE + 16);
+        printf("Main memory: %u bytes, deduplicated\n", main_memory_size_in_bytes);
+        printf("  %u distinct lines stored for %u lines, dedup ratio %.2f, %llu KB of host memory\n",
+               main_memory_used_slots, main_memory_num_lines, main_memory_dedup_ratio(),
+               (unsigned long long) (host_bytes >> 10));
+        printf("  %llu line writes, %llu of contents already stored, %llu copies on write\n",
+               (unsigned long long) main_memory_dedup_writes, (unsigned long long) main_memory_dedup_shared,
+               (unsigned long long) main_memory_dedup_copies);
+        return;
+    }
+    if (!main_memory_mapped) {
+        printf("Main memory: %u bytes, allocated\n", main_memory_size_in_bytes);
+        return;
+    }
+
+  //mincore() reports which host pages of the mapping are resident.
+
+    long host_page_size = sysconf(_SC_PAGESIZE);
+    size_t num_host_pages = ((size_t) main_memory_size_in_bytes + host_page_size - 1) / host_page_size;
+    unsigned char *resident = malloc(num_host_pages);
+    uint64_t resident_bytes = 0;
+    if (mincore(main_memory, main_memory_size_in_bytes, resident) == 0) {
+        for (size_t i = 0; i < num_host_pages; i++) {
+            if (resident[i] & 1)
+                resident_bytes += host_page_size;
+        }
+    }
+    free(resident);
+
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    printf("Main memory: %u bytes, mapped from %s\n", main_memory_size_in_bytes, main_memory_file_path);
+    printf("  %llu KB resident, %ld minor and %ld major host page faults\n",
+           (unsigned long long) (resident_bytes >> 10), usage.ru_minflt - main_memory_minor_faults,
+           usage.ru_majflt - main_memory_major_faults);
+}
@@ -9,6 +9,99 @@ there are 4 bytes per word and 16 words per cache line.
 
 void main_memory_initialize(uint32_t size_in_bytes);
 
+
+/************************************************************************
+                 main_memory_use_file
+
+This procedure makes the following calls to main_memory_initialize()
+map a file as main memory, rather than allocating it from the host's
+memory, so that the simulated memory can be larger than the host's.
+The file, at path, is created (or truncated) as a sparse file of the
+size of main memory, so only the pages that are written take up disk
+space, and the host's page cache holds the pages in use. If
+image_path is not NULL, main memory is preloaded with the contents
+of that file (the rest is zeros). A path of NULL goes back to
+allocated memory.
+
+Since addresses are 32 bits, main memory is at most 4GB either way.
+*************************************************************************/
+
+void main_memory_use_file(const char *path, const char *image_path);
+
+
+/************************************************************************
+                 main_memory_deduplicate
+
+This procedure makes the following calls to main_memory_initialize()
+store main memory deduplicated by contents, at the granularity of
+cache lines (if enabled is TRUE), rather than as one array. Each line
+of memory then refers to a slot of a line store, and all the lines
+with the same contents (zeroed buffers, replicated tables) share a
+single slot, found through a hash of the contents and reference
+counted. A write to a line that shares its slot gives the line a slot
+of its own (copy on write), unless the new contents are already
+stored. Only the line map (4 bytes per line) and the distinct lines
+take up host memory, so a mostly zero or redundant simulated memory
+can be much larger than the host's. It cannot be combined with
+main_memory_use_file().
+*************************************************************************/
+
+void main_memory_deduplicate(BOOL enabled);
+
+
+/************************************************************************
+                 main_memory_advise
+
+This procedure tells the host how main memory is about to be accessed
+(MAIN_MEMORY_ADVICE_...), so that it can adjust its readahead: random
+accesses get no readahead, sequential ones aggressive readahead. It
+only has an effect on a file-backed main memory, which starts out
+with MAIN_MEMORY_ADVICE_RANDOM: cache line fills are scattered, and
+with readahead, the host fills (and allocates on disk) whole large
+pages of the file around each one.
+*************************************************************************/
+
+#define MAIN_MEMORY_ADVICE_NORMAL 0
+#define MAIN_MEMORY_ADVICE_RANDOM 1
+#define MAIN_MEMORY_ADVICE_SEQUENTIAL 2
+
+void main_memory_advise(uint8_t advice);
+
+
+/************************************************************************
+                 main_memory_make_private
+
+This procedure maps a file-backed main memory again, in place, as a
+private (copy-on-write) mapping of the file: from then on, writes to
+main memory only go to this process's copy of the pages written, and
+no longer to the file. It is called by each branch of memory_fork()
+(see memory_fork.h), which would otherwise share the file's pages
+with the parent and the other branches. It has no effect on a main
+memory that is not file-backed.
+*************************************************************************/
+
+void main_memory_make_private();
+
+
+/************************************************************************
+                 main_memory_dedup_ratio, main_memory_report
+
+main_memory_dedup_ratio() returns the number of lines of a deduplicated
+main memory per distinct line stored (1 if main memory is not
+deduplicated).
+
+main_memory_report() prints how main memory is backed and, for a
+file-backed main memory, how much of it is resident in the host's
+memory and the host page faults (minor and major, i.e. needing a disk
+read) taken by the simulator since main memory was initialized. For a
+deduplicated main memory, it prints the distinct lines stored, the
+dedup ratio, the host memory used, and how many line writes shared
+contents already stored or made a copy on write.
+*************************************************************************/
+
+double main_memory_dedup_ratio();
+void main_memory_report();
+
 /********************************************************************
                main_memory_access
 
@@ -37,3 +130,38 @@ void main_memory_access(uint32_t address, uint32_t write_data[],
 			uint8_t control, uint32_t read_data[]);
 
 
+/************************************************
+
+       main_memory_write_changes(), main_memory_read_changes(),
+       main_memory_clear_changes()
+
+Main memory keeps track of the pages of MAIN_MEMORY_PAGE_SIZE bytes
+written since the last main_memory_clear_changes().
+main_memory_write_changes() writes these pages to a checkpoint file
+(or, if all is TRUE, every page that is not all zeros) and returns
+the number of pages written. main_memory_read_changes() reads them
+back into memory; if all is TRUE, the rest of memory is zeroed.
+See checkpoint.h.
+
+***********************************************/
+
+#define MAIN_MEMORY_PAGE_SHIFT 12
+#define MAIN_MEMORY_PAGE_SIZE (1 << MAIN_MEMORY_PAGE_SHIFT)
+
+uint32_t main_memory_write_changes(FILE *file, BOOL all);
+void main_memory_read_changes(FILE *file, BOOL all);
+void main_memory_clear_changes();
+
+
+/************************************************
+
+       main_memory_read_page(), main_memory_write_page()
+
+These procedures copy the contents of the page of MAIN_MEMORY_PAGE_SIZE
+bytes out of and into main memory, however it is stored, without
+marking it as written (see compressed_memory.h).
+
+***********************************************/
+
+void main_memory_read_page(uint32_t page, uint32_t words[]);
+void main_memory_write_page(uint32_t page, const uint32_t words[]);
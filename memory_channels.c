@@ -0,0 +1,145 @@
+/************************************************************
+
+   This file contains the multi-channel main memory model
+   (see memory_channels.h).
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_channels.h"
+
+BOOL memory_channels_enabled = FALSE;
+uint32_t memory_num_channels;
+uint8_t memory_channel_interleave;
+MEMORY_CHANNEL memory_channels[MEMORY_CHANNELS_MAX];
+
+//log2(memory_num_channels)
+uint32_t memory_channel_bits;
+
+//The lines most recently read from main memory, direct-mapped,
+//and the cycle at which their transfer completes.
+typedef struct {
+  uint32_t line;
+  uint64_t ready;
+} MEMORY_CHANNEL_TRANSFER;
+
+MEMORY_CHANNEL_TRANSFER memory_channel_transfers[MEMORY_CHANNELS_IN_FLIGHT];
+
+
+void memory_channels_initialize(uint32_t num_channels, uint8_t interleave)
+{
+    if ((num_channels == 0) || (num_channels > MEMORY_CHANNELS_MAX) || (num_channels & (num_channels - 1))) {
+        printf("Error: the number of memory channels must be a power of 2, up to %d\n", MEMORY_CHANNELS_MAX);
+        exit(1);
+    }
+    if (interleave > MEMORY_INTERLEAVE_XOR) {
+        printf("Error: unknown memory channel interleaving %d\n", interleave);
+        exit(1);
+    }
+    memory_num_channels = num_channels;
+    memory_channel_interleave = interleave;
+    for (memory_channel_bits = 0; (1u << memory_channel_bits) < num_channels; memory_channel_bits++)
+        ;
+    for (uint32_t channel = 0; channel < MEMORY_CHANNELS_MAX; channel++) {
+        memory_channels[channel].busy_until = 0;
+        memory_channels[channel].reads = 0;
+        memory_channels[channel].writes = 0;
+        memory_channels[channel].busy_cycles = 0;
+        memory_channels[channel].queue_cycles = 0;
+    }
+    for (int i = 0; i < MEMORY_CHANNELS_IN_FLIGHT; i++)
+        memory_channel_transfers[i].ready = 0;
+    memory_channels_enabled = TRUE;
+}
+
+
+uint32_t memory_channel_of(uint32_t address)
+{
+    uint32_t mask = memory_num_channels - 1;
+    uint32_t line = address >> 6;
+    uint32_t page = address >> MEMORY_CHANNEL_PAGE_SHIFT;
+
+    switch (memory_channel_interleave) {
+    case MEMORY_INTERLEAVE_LINE:
+        return line & mask;
+    case MEMORY_INTERLEAVE_PAGE:
+        return page & mask;
+    default:
+
+  //The page's channel bits are XORed with the same number of bits
+  //of the line within the page and of each group of higher bits.
+
+        {
+            uint32_t channel = page ^ (line & ((MEMORY_CHANNEL_PAGE_SIZE >> 6) - 1));
+            for (uint32_t rest = page >> memory_channel_bits; rest; rest >>= memory_channel_bits)
+                channel ^= rest;
+            return channel & mask;
+        }
+    }
+}
+
+
+uint32_t memory_channels_access(uint32_t address, uint8_t control, uint64_t time)
+{
+    MEMORY_CHANNEL *channel = &memory_channels[memory_channel_of(address)];
+
+  //The transfer starts when the channel is free.
+
+    uint64_t start = (channel->busy_until > time) ? channel->busy_until : time;
+    channel->busy_until = start + MEMORY_CHANNEL_BUSY_CYCLES;
+    channel->busy_cycles += MEMORY_CHANNEL_BUSY_CYCLES;
+    channel->queue_cycles += start - time;
+    if (control & READ_ENABLE_MASK) {
+        MEMORY_CHANNEL_TRANSFER *transfer = &memory_channel_transfers[(address >> 6) % MEMORY_CHANNELS_IN_FLIGHT];
+        transfer->line = address >> 6;
+        transfer->ready = channel->busy_until;
+        channel->reads++;
+    }
+    else {
+        channel->writes++;
+    }
+    return (uint32_t) (start - time);
+}
+
+
+uint32_t memory_channels_wait(uint32_t address, uint64_t time)
+{
+    MEMORY_CHANNEL_TRANSFER *transfer = &memory_channel_transfers[(address >> 6) % MEMORY_CHANNELS_IN_FLIGHT];
+    if ((transfer->line == (address >> 6)) && (transfer->ready > time))
+        return (uint32_t) (transfer->ready - time);
+    return 0;
+}
+
+
+double memory_channels_imbalance()
+{
+    uint64_t total = 0, busiest = 0;
+    for (uint32_t i = 0; i < memory_num_channels; i++) {
+        uint64_t transfers = memory_channels[i].reads + memory_channels[i].writes;
+        total += transfers;
+        if (transfers > busiest)
+            busiest = transfers;
+    }
+    return total ? (double) busiest * memory_num_channels / total : 1.0;
+}
+
+
+void memory_channels_report(uint64_t elapsed_cycles)
+{
+    const char *interleavings[] = {"line", "page", "XOR"};
+
+    printf("Memory channels: %u, %s interleaving, imbalance = %.2f\n", memory_num_channels,
+           interleavings[memory_channel_interleave], memory_channels_imbalance());
+    for (uint32_t i = 0; i < memory_num_channels; i++) {
+        MEMORY_CHANNEL *channel = &memory_channels[i];
+        uint64_t transfers = channel->reads + channel->writes;
+        printf("  channel %u: %llu reads, %llu writes, utilization = %.2f%%, average queueing delay = %.1f cycles\n",
+               i, (unsigned long long) channel->reads, (unsigned long long) channel->writes,
+               elapsed_cycles ? 100.0 * channel->busy_cycles / elapsed_cycles : 0.0,
+               transfers ? (double) channel->queue_cycles / transfers : 0.0);
+    }
+}
@@ -0,0 +1,139 @@
+/************************************************************
+
+    Multi-channel main memory.
+
+Main memory is divided into independent channels, each serving one
+cache line transfer at a time. An interleaving function maps each
+cache line to a channel:
+
+  MEMORY_INTERLEAVE_LINE: consecutive cache lines go to consecutive
+                          channels.
+  MEMORY_INTERLEAVE_PAGE: consecutive pages of MEMORY_CHANNEL_PAGE_SIZE
+                          bytes go to consecutive channels, so that a
+                          page is in a single channel.
+  MEMORY_INTERLEAVE_XOR:  the page's channel is XORed with bits of the
+                          line and row addresses, so that strides that
+                          are a multiple of the page size are spread
+                          over the channels too.
+
+Timing follows the latency model (see memory_subsystem.h). A
+transfer keeps its channel busy for MEMORY_CHANNEL_BUSY_CYCLES; a
+transfer to a busy channel waits in the channel's queue until the
+previous ones have completed, while the other channels serve their
+own transfers in parallel. The time spent waiting is added to the
+MAIN_MEMORY_LATENCY of a demand read. Write-backs and prefetch fills
+don't delay the access that caused them, but they keep their
+channels busy, and a line read from main memory is only available
+when its transfer has completed: a demand access that hits in the
+L2 cache on a prefetched line still being transferred waits for it.
+
+************************************************************/
+
+#define MEMORY_CHANNELS_MAX 16
+
+#define MEMORY_INTERLEAVE_LINE 0
+#define MEMORY_INTERLEAVE_PAGE 1
+#define MEMORY_INTERLEAVE_XOR 2
+
+#define MEMORY_CHANNEL_PAGE_SHIFT 12
+#define MEMORY_CHANNEL_PAGE_SIZE (1 << MEMORY_CHANNEL_PAGE_SHIFT)
+
+#define MEMORY_CHANNEL_BUSY_CYCLES 40
+
+//The number of lines whose transfer completion time is remembered
+//(see memory_channels_wait()).
+#define MEMORY_CHANNELS_IN_FLIGHT 256
+
+
+/***************************************************
+This struct holds the state and statistics of a
+channel. It has the following fields:
+  busy_until: the cycle at which the channel's last
+              queued transfer completes.
+  reads, writes: the transfers served.
+  busy_cycles: the cycles spent transferring.
+  queue_cycles: the cycles transfers spent waiting
+                for the channel.
+****************************************************/
+
+typedef struct {
+  uint64_t busy_until;
+  uint64_t reads;
+  uint64_t writes;
+  uint64_t busy_cycles;
+  uint64_t queue_cycles;
+} MEMORY_CHANNEL;
+
+//Set by memory_channels_initialize().
+extern BOOL memory_channels_enabled;
+extern uint32_t memory_num_channels;
+extern uint8_t memory_channel_interleave;
+extern MEMORY_CHANNEL memory_channels[MEMORY_CHANNELS_MAX];
+
+
+/************************************************
+
+       memory_channels_initialize()
+
+This procedure sets the number of channels (a power of 2, up to
+MEMORY_CHANNELS_MAX) and the interleaving (MEMORY_INTERLEAVE_...),
+clears the statistics and enables the channels.
+
+***********************************************/
+
+void memory_channels_initialize(uint32_t num_channels, uint8_t interleave);
+
+
+/************************************************
+
+       memory_channel_of()
+
+This procedure returns the channel of the specified address.
+
+***********************************************/
+
+uint32_t memory_channel_of(uint32_t address);
+
+
+/************************************************
+
+       memory_channels_access()
+
+This procedure is called for every cache line read from
+(control = READ_ENABLE_MASK) or written to main memory at the
+specified cycle. It queues the transfer on its channel and
+returns the number of cycles it waits before being served.
+
+***********************************************/
+
+uint32_t memory_channels_access(uint32_t address, uint8_t control, uint64_t time);
+
+
+/************************************************
+
+       memory_channels_wait()
+
+This procedure returns the number of cycles from the specified
+cycle until the transfer of the line containing the address from
+main memory completes (0 if it has completed).
+
+***********************************************/
+
+uint32_t memory_channels_wait(uint32_t address, uint64_t time);
+
+
+/************************************************
+
+       memory_channels_imbalance(),
+       memory_channels_report()
+
+memory_channels_imbalance() returns the imbalance of the channels:
+the transfers of the busiest channel over the average (1 if they
+are balanced). memory_channels_report() prints the transfers,
+utilization (the fraction of the elapsed cycles the channel was
+busy) and average queueing delay of each channel, and the imbalance.
+
+***********************************************/
+
+double memory_channels_imbalance();
+void memory_channels_report(uint64_t elapsed_cycles);
@@ -0,0 +1,81 @@
+/************************************************************
+
+   This file contains memory_fork() (see memory_fork.h).
+
+   The output of each branch goes to its own temporary file,
+   created by the parent before the fork: the branch redirects
+   its stdout to it, and the parent reads it back once the branch
+   has exited.
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "memory_subsystem_constants.h"
+#include "main_memory.h"
+#include "memory_fork.h"
+
+
+int memory_fork(int num_branches, void (*branch)(int branch_number), FILE *report)
+{
+    FILE *outputs[MEMORY_FORK_MAX_BRANCHES];
+    pid_t pids[MEMORY_FORK_MAX_BRANCHES];
+    int failed = 0;
+
+    if ((num_branches < 1) || (num_branches > MEMORY_FORK_MAX_BRANCHES)) {
+        printf("Error: the number of branches must be 1 to %d\n", MEMORY_FORK_MAX_BRANCHES);
+        exit(1);
+    }
+
+  //Anything still buffered would otherwise be printed again by
+  //each branch.
+
+    fflush(stdout);
+    fflush(report);
+
+    for (int b = 0; b < num_branches; b++) {
+        outputs[b] = tmpfile();
+        if (outputs[b] == NULL) {
+            printf("Error: cannot create the output file of branch %d\n", b);
+            exit(1);
+        }
+        pids[b] = fork();
+        if (pids[b] < 0) {
+            printf("Error: cannot fork branch %d\n", b);
+            exit(1);
+        }
+        if (pids[b] == 0) {
+            dup2(fileno(outputs[b]), fileno(stdout));
+            main_memory_make_private();
+            branch(b);
+            fflush(stdout);
+            _exit(0);
+        }
+    }
+
+  //Collect the output of each branch, in order.
+
+    for (int b = 0; b < num_branches; b++) {
+        int status;
+        char buffer[4096];
+        size_t length;
+
+        waitpid(pids[b], &status, 0);
+        BOOL ok = WIFEXITED(status) && (WEXITSTATUS(status) == 0);
+        if (!ok)
+            failed++;
+
+        fprintf(report, "=== Branch %d%s\n", b, ok ? "" : " (failed)");
+        rewind(outputs[b]);
+        while ((length = fread(buffer, 1, sizeof(buffer), outputs[b])) > 0)
+            fwrite(buffer, 1, length, report);
+        fclose(outputs[b]);
+    }
+    fflush(report);
+    return failed;
+}
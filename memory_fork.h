@@ -0,0 +1,39 @@
+/************************************************************
+
+    Forking a warmed memory subsystem.
+
+memory_fork() branches the current state of the memory subsystem
+(caches, main memory and every enabled feature) into several
+branches, which run in parallel, e.g. to try different policies or
+different trace segments from the same warmed state without
+warming each one up separately.
+
+Each branch is a child process created with fork(), so all of the
+state is shared copy-on-write: a branch only pays for the pages it
+modifies, and nothing it does affects the parent or the other
+branches. A file-backed main memory (see main_memory_use_file()) is
+mapped again privately by each branch, so its writes never reach
+the file either; the file holds the parent's memory throughout.
+
+Whatever a branch prints to stdout (e.g. with the *_report()
+procedures) is collected, and once all branches have completed,
+their output is written to a single report, in order.
+
+************************************************************/
+
+#define MEMORY_FORK_MAX_BRANCHES 64
+
+
+/************************************************
+
+       memory_fork()
+
+This procedure runs branch(0) to branch(num_branches - 1), each in
+its own copy of the memory subsystem, in parallel, and waits for
+them to complete. The output of each branch is written to report,
+after a header line with its number. It returns the number of
+branches that failed (exited with a nonzero status or crashed).
+
+***********************************************/
+
+int memory_fork(int num_branches, void (*branch)(int branch_number), FILE *report);
@@ -0,0 +1,42 @@
+#ifndef MEMORY_REQUEST_H
+#define MEMORY_REQUEST_H
+
+/************************************************************
+
+    Memory request metadata.
+
+A request to the memory subsystem may carry metadata about the
+instruction that issued it, for the policies that use it (e.g.
+PC-indexed prediction tables). It is passed to
+memory_access_with_info() (see memory_subsystem.h) and handed down,
+as a pointer, to the L1 miss and L2 miss handling and to the policy
+hooks they call. A request without metadata passes NULL, so that
+policies fall back to address-based behavior and nothing is copied
+or looked up when the metadata isn't used.
+
+************************************************************/
+
+//Values of access_type, below.
+#define MEMORY_ACCESS_DATA 0
+#define MEMORY_ACCESS_INSTRUCTION 1
+
+/***************************************************
+This struct holds the metadata of a memory request.
+It has the following fields:
+  pc: the address of the instruction that issued the
+      request (for an instruction fetch, the address
+      being fetched).
+  thread_id: the hardware thread (or core) that issued
+             the request.
+  access_type: MEMORY_ACCESS_DATA or MEMORY_ACCESS_INSTRUCTION.
+  size: the size of the access in bytes.
+****************************************************/
+
+typedef struct {
+  uint32_t pc;
+  uint8_t thread_id;
+  uint8_t access_type;
+  uint8_t size;
+} MEMORY_REQUEST_INFO;
+
+#endif
@@ -17,12 +17,37 @@
 #include "main_memory.h"
 #include "l1_cache.h"
 #include "l2_cache.h"
+#include "mini_sim.h"
+#include "working_set.h"
+#include "page_map.h"
+#include "access_classifier.h"
+#include "prefetch.h"
+#include "dead_block.h"
+#include "ship.h"
+#include "store_buffer.h"
+#include "memory_channels.h"
+#include "memory_tiers.h"
+#include "compressed_memory.h"
+#include "self_profile.h"
+#include "filtered_trace.h"
 #include "memory_subsystem.h"
 
 
 //These are defined below.
-void memory_handle_l1_miss(uint32_t address);
+void memory_handle_l1_miss(uint32_t address, BOOL software_prefetch,
+			   const MEMORY_REQUEST_INFO *info);
+void memory_read_l2_line(uint32_t address, BOOL software_prefetch,
+			 const MEMORY_REQUEST_INFO *info, uint32_t read_data[]);
 void memory_handle_l2_miss(uint32_t address, uint8_t control);
+void memory_write_back_l1_line(uint32_t address, uint32_t data[]);
+void memory_handle_cache_hint(uint32_t address, uint8_t control);
+void memory_prefetch_into_l2(uint32_t address);
+void memory_evict_from_l2(uint32_t address, uint32_t l1_data[]);
+void memory_main_memory_access(uint32_t address, uint32_t write_data[],
+			       uint8_t control, uint32_t read_data[]);
+uint32_t memory_perform_access(uint32_t address, uint32_t write_data,
+			       uint8_t control, uint32_t *read_data,
+			       const MEMORY_REQUEST_INFO *info);
 
 //We are going to count how many L1 and L2 cache misses 
 //have occurred. These are the variables used to keep
@@ -30,6 +55,40 @@ void memory_handle_l2_miss(uint32_t address, uint8_t control);
 uint32_t num_l1_misses;
 uint32_t num_l2_misses;
 
+//Software prefetches, by kind: L1 read, L2 read, L1 write, L2 write
+//(see memory_handle_cache_hint()), and what became of them.
+uint32_t num_sw_prefetches[4];
+uint32_t num_sw_prefetches_redundant;
+uint32_t num_sw_prefetch_memory_fills;
+uint32_t num_sw_prefetches_useful_l1;
+uint32_t num_sw_prefetches_useless_l1;
+uint32_t num_sw_prefetches_useful_l2;
+uint32_t num_sw_prefetches_useless_l2;
+uint32_t num_sw_prefetches_hw_covered;
+
+//Demote and evict hints, and the write-backs they caused.
+uint32_t num_demotes;
+uint32_t num_evicts;
+uint32_t num_hint_writebacks;
+
+//TRUE while a software prefetch is being filled from main memory,
+//as prefetch_filling (see prefetch.h) is for a hardware prefetch.
+BOOL memory_software_prefetch_filling = FALSE;
+
+//See memory_subsystem.h.
+BOOL memory_fast_path_enabled = TRUE;
+BOOL memory_latency_model_enabled = FALSE;
+uint64_t memory_cycles;
+
+//With the memory channels or tiers, the cycles the last line read
+//from main memory took beyond MAIN_MEMORY_LATENCY, and the cycles
+//the current access took beyond its level's latency.
+uint32_t memory_read_queue_delay;
+uint32_t memory_demand_queue_delay;
+
+//The size of main memory, from main_memory.c.
+extern uint32_t main_memory_size_in_bytes;
+
 /*******************************************************
 
         memory_subsystem_initialize()
@@ -53,16 +112,50 @@ void memory_subsystem_initialize(uint32_t memory_size_in_bytes)
     l1_initialize();
     num_l1_misses = 0;
     num_l2_misses = 0;
+    for (int kind = 0; kind < 4; kind++)
+        num_sw_prefetches[kind] = 0;
+    num_sw_prefetches_redundant = 0;
+    num_sw_prefetch_memory_fills = 0;
+    num_sw_prefetches_useful_l1 = 0;
+    num_sw_prefetches_useless_l1 = 0;
+    num_sw_prefetches_useful_l2 = 0;
+    num_sw_prefetches_useless_l2 = 0;
+    num_sw_prefetches_hw_covered = 0;
+    num_demotes = 0;
+    num_evicts = 0;
+    num_hint_writebacks = 0;
+    memory_cycles = 0;
+
+  //Stores still in the store buffer were meant for the old memory.
+
+    if (store_buffer_enabled)
+        store_buffer_initialize(store_buffer_entries);
+    if (l1i_enabled)
+        l1i_clear();
+    if (ship_enabled)
+        ship_clear_lines();
+    if (prefetch_enabled)
+        prefetch_clear();
+    if (memory_channels_enabled)
+        memory_channels_initialize(memory_num_channels, memory_channel_interleave);
+    if (memory_tiers_enabled)
+        memory_tiers_initialize(memory_size_in_bytes, memory_tier_fast_size_in_bytes, memory_tier_policy,
+                                memory_tier_threshold, memory_tier_epoch_length);
+    if (compressed_memory_enabled)
+        compressed_memory_initialize(memory_size_in_bytes, compressed_memory_pool_size_in_bytes,
+                                     compressed_memory_inactive_epochs, compressed_memory_epoch_length);
 }
 
 
 
 /*****************************************************
 
-              memory_access()
+              memory_access_slow()
 
 This is the procedure for reading and writing one word
-of data from and to the memory subsystem. 
+of data from and to the memory subsystem. It is called by
+memory_access() (see memory_subsystem.h) whenever the L1
+hit fast path doesn't apply.
 
 It takes the following parameters:
 
@@ -71,22 +164,99 @@ address:  32-bit address of the data being read or written.
 write_data: In the case of a memory write, the 32-bit value
           being written.
 
-control:  an unsigned byte (8 bits), of which only the two lowest bits
-          are meaningful, as follows:
+control:  an unsigned byte (8 bits), as follows:
           -- bit 0:  read enable (1 means read, 0 means don't read)
           -- bit 1:  write enable (1 means write, 0 means don't write)
+          -- bits 2-6: cache hint operations, see
+             memory_subsystem_constants.h.
 
 read_data: a 32-bit ouput parameter (thus, a pointer to it is passed).
          In the case of a read operation, the data being read will
          be written to read_data.
 
+info: the metadata of the request (see memory_request.h), or NULL.
+
 ****************************************************/
 
-void memory_access(uint32_t address, uint32_t write_data, 
-		   uint8_t control, uint32_t *read_data)
+void memory_access_slow(uint32_t address, uint32_t write_data, 
+			uint8_t control, uint32_t *read_data,
+			const MEMORY_REQUEST_INFO *info)
 {
 
+  //Cache hints don't access any data, see memory_handle_cache_hint().
+  //The stores in the store buffer are performed before a demote
+  //or evict.
+
+    if (control & CACHE_HINT_MASK) {
+        if (store_buffer_enabled && (control & (DEMOTE_MASK | EVICT_MASK)))
+            store_buffer_drain();
+        memory_handle_cache_hint(address, control);
+        return;
+    }
+
+  //If the working-set estimator is enabled, record the access.
+
+    if (working_set_enabled)
+        working_set_access(address);
+
+  //If the store buffer is enabled, a write retires into it, and a
+  //read of a word that is in it is forwarded from it. Otherwise,
+  //the access is performed on the caches.
+
+    if (store_buffer_enabled) {
+        store_buffer_advance();
+        if (control & WRITE_ENABLE_MASK) {
+            store_buffer_write(address, write_data);
+            return;
+        }
+    }
+    if (!(store_buffer_enabled && store_buffer_forward(address, read_data))) {
+        uint32_t latency = memory_perform_access(address, write_data, control, read_data, info);
+        if (memory_latency_model_enabled)
+            memory_cycles += latency;
+    }
+
+  //The access classifier recognizes pointer chasing by
+  //comparing miss addresses with recently loaded values.
+
+    if (access_classifier_enabled && (control & READ_ENABLE_MASK))
+        access_classifier_note_load(*read_data);
+}
+
+
+//This procedure performs a read or write on the L1 cache, handling
+//an L1 miss, and returns the latency of the access (see
+//memory_enable_latency_model()). It is called by memory_access_slow()
+//and, to drain the store buffer, by store_buffer.c.
+
+uint32_t memory_perform_access(uint32_t address, uint32_t write_data,
+			       uint8_t control, uint32_t *read_data,
+			       const MEMORY_REQUEST_INFO *info)
+{
   uint8_t status;
+  uint32_t latency = L1_HIT_LATENCY;
+  uint32_t l2_misses = num_l2_misses;
+
+    memory_demand_queue_delay = 0;
+
+  //With the split L1, an instruction fetch goes to the L1I, which
+  //is filled from L2 just like the L1 (data) cache.
+
+    if (l1i_enabled && info && (info->access_type == MEMORY_ACCESS_INSTRUCTION) &&
+        (control & READ_ENABLE_MASK)) {
+        if (!l1i_cache_access(address, read_data)) {
+            memory_handle_l1_miss(address, FALSE, info);
+            l1i_cache_access(address, read_data);
+            latency = ((num_l2_misses != l2_misses) ? MAIN_MEMORY_LATENCY : L2_HIT_LATENCY) + memory_demand_queue_delay;
+        }
+        return latency;
+    }
+
+  //A line brought into L1 by a software prefetch misses in the
+  //fast path until its first use, which is counted here.
+
+    if ((num_sw_prefetches[0] + num_sw_prefetches[2]) && l1_use_sw_prefetch(address))
+        num_sw_prefetches_useful_l1++;
 
   //call l1_cache_access to try to read or write the 
   //data from or to the L1 cache.
@@ -103,9 +273,11 @@ void memory_access(uint32_t address, uint32_t write_data,
 
     if (!(status & 0x1)) {
         num_l1_misses += 1;
-        memory_handle_l1_miss(address);
+        memory_handle_l1_miss(address, FALSE, info);
         l1_cache_access(address, write_data, control, read_data, &status);
+        latency = ((num_l2_misses != l2_misses) ? MAIN_MEMORY_LATENCY : L2_HIT_LATENCY) + memory_demand_queue_delay;
     }
+    return latency;
 }
 
 
@@ -113,33 +285,40 @@ void memory_access(uint32_t address, uint32_t write_data,
 //This procedure should be called when an L1 cache miss occurs.
 //It doesn't matter if the miss occured on a read or a write
 //operation. It takes as a parameter the address that resulted
-//in the L1 cache miss.
+//in the L1 cache miss. It is also called with software_prefetch
+//set to TRUE to bring a line into L1 for a software prefetch, in
+//which case an L2 miss is not counted in num_l2_misses. The metadata
+//of the request (or NULL) is passed on to the policies.
 
-void memory_handle_l1_miss(uint32_t address)  
+void memory_handle_l1_miss(uint32_t address, BOOL software_prefetch,
+			   const MEMORY_REQUEST_INFO *info)
 {
+    uint8_t outer_component = self_profile_enter(SELF_PROFILE_L1_MISS);
 
-  //call l2_cache_access to read the cache line containing
-  //the specified address from the L2 cache. This is necessary
-  //regardless if the operation that caused the L1 cache miss
-  //was a read or a write.
+  //If an L1-filtered trace is being recorded, the miss goes into it.
+
+    if (filtered_trace_recording)
+        filtered_trace_note(software_prefetch ? FILTERED_TRACE_SW_PREFETCH_L1 : FILTERED_TRACE_FILL,
+                            address, info, NULL);
+
+  //If the access classifier is enabled, it sees every L1 miss.
+
+    if (access_classifier_enabled && !software_prefetch)
+        access_classifier_miss(address);
+
+  //Read the line from L2 (see memory_read_l2_line(), below).
 
     uint8_t status;
     uint32_t read_data[WORDS_PER_CACHE_LINE];
-    l2_cache_access(address, NULL, READ_ENABLE_MASK, read_data, &status);
+    memory_read_l2_line(address, software_prefetch, info, read_data);
 
-  //if the result was an L2 cache miss, then:
-  //   -- increment num_l2_misses
-  //   -- call memory_handle_l2_miss, specifying the address that 
-  //      caused the L2 miss (which is the same as the address that
-  //      caused the L1 miss), and specifying that the L2 miss 
-  //      occurred when attempting to read (not write) from L2 cache.
-  //  --  call l2_cache_access again to read the needed cache line
-  //      from the l2 cache.
+  //With the split L1, an instruction fetch fills the L1I instead,
+  //whose lines are never dirty.
 
-    if (!(status & 0x1)) {
-        num_l2_misses += 1;
-        memory_handle_l2_miss(address, READ_ENABLE_MASK);
-        l2_cache_access(address, NULL, READ_ENABLE_MASK, read_data, &status);
+    if (l1i_enabled && info && (info->access_type == MEMORY_ACCESS_INSTRUCTION)) {
+        l1i_insert_line(address, read_data);
+        self_profile_leave(outer_component);
+        return;
     }
   
   //Now that the needed cache line has been retrieved from the 
@@ -149,6 +328,10 @@ void memory_handle_l1_miss(uint32_t address)
     uint32_t evicted_writeback_address;
     uint32_t evicted_writeback_data[WORDS_PER_CACHE_LINE];
     l1_insert_line(address, read_data, &evicted_writeback_address, evicted_writeback_data, &status);
+    if (status & L1_UNUSED_SW_PREFETCH_STATUS_MASK)
+        num_sw_prefetches_useless_l1++;
+    if (software_prefetch)
+        l1_set_sw_prefetch(address);
 
   //if the cache line that was evicted from L1 has to be written back,
   //then l2_cache_access must be called to write the evicted cache line
@@ -160,15 +343,148 @@ void memory_handle_l1_miss(uint32_t address)
   //      was a write (not a read).
   //   -- l2_cache_access should be called again to write the cache line
   //      evicted from L1 into L2.
-  //      
+  //   (see memory_write_back_l1_line(), below)
 
     if (status & 0x1) {
-        l2_cache_access(evicted_writeback_address, evicted_writeback_data, WRITE_ENABLE_MASK, NULL, &status);
-        if (!(status & 0x1)) {
-            memory_handle_l2_miss(evicted_writeback_address, WRITE_ENABLE_MASK);
-            l2_cache_access(evicted_writeback_address, evicted_writeback_data, WRITE_ENABLE_MASK, NULL, &status);
+        memory_write_back_l1_line(evicted_writeback_address, evicted_writeback_data);
+    }
+    self_profile_leave(outer_component);
+}
+
+
+//This procedure writes a dirty cache line evicted from L1
+//into the L2 cache.
+
+void memory_write_back_l1_line(uint32_t address, uint32_t data[])
+{
+    uint8_t status;
+
+    if (filtered_trace_recording)
+        filtered_trace_note(FILTERED_TRACE_WRITEBACK, address, NULL, data);
+    if (mini_sim_enabled)
+        mini_sim_access(address, WRITE_ENABLE_MASK, MINI_SIM_LEVEL_L2, TRUE);
+    l2_cache_access(address, data, WRITE_ENABLE_MASK, NULL, &status);
+    if (!(status & 0x1)) {
+        memory_handle_l2_miss(address, WRITE_ENABLE_MASK);
+        l2_cache_access(address, data, WRITE_ENABLE_MASK, NULL, &status);
+    }
+}
+
+
+//This procedure reads the line containing the specified address
+//from L2 into read_data for memory_handle_l1_miss(), handling an L2
+//miss, with everything the L2 side of the memory subsystem does on
+//an L1 miss (prefetching, dead-block prediction, SHiP...), but
+//without touching L1. It is also called to replay an L1 miss of an
+//L1-filtered trace (see filtered_trace.h). A software prefetch is
+//not a demand read: it is kept out of the hardware prefetchers, the
+//dead-block predictor and SHiP, which neither learn from it nor
+//count it, and is only accounted for in the software prefetch
+//statistics.
+
+void memory_read_l2_line(uint32_t address, BOOL software_prefetch,
+			 const MEMORY_REQUEST_INFO *info, uint32_t read_data[])
+{
+  //call l2_cache_access to read the cache line containing
+  //the specified address from the L2 cache. This is necessary
+  //regardless if the operation that caused the L1 cache miss
+  //was a read or a write.
+
+    uint8_t status;
+    BOOL demand = !software_prefetch;
+    if (prefetch_enabled && demand)
+        prefetch_advance();
+    l2_cache_access(address, NULL, READ_ENABLE_MASK, read_data, &status);
+
+  //If the mini-sim is enabled, present the same L2 access to
+  //each of its miniature L2 configurations.
+
+    if (mini_sim_enabled)
+        mini_sim_access(address, READ_ENABLE_MASK, MINI_SIM_LEVEL_L2, demand);
+
+  //If the dead-block predictor is enabled, it predicts whether
+  //this is the last access to the line (and learns from it).
+
+    BOOL predicted_dead = dead_block_enabled && demand && dead_block_access(address, info);
+    BOOL bypassed = FALSE;
+
+  //If SHiP is enabled, it learns from hits whether the signature
+  //of a line's fill was reused.
+
+    uint16_t signature = 0;
+    if (ship_enabled && demand) {
+        signature = ship_access(address, info);
+        if (status & 0x1)
+            ship_hit(address);
+    }
+
+  //if the result was an L2 cache miss, then:
+  //   -- increment num_l2_misses
+  //   -- call memory_handle_l2_miss, specifying the address that 
+  //      caused the L2 miss (which is the same as the address that
+  //      caused the L1 miss), and specifying that the L2 miss 
+  //      occurred when attempting to read (not write) from L2 cache.
+  //  --  call l2_cache_access again to read the needed cache line
+  //      from the l2 cache.
+  //If the line is still being prefetched, the prefetch is
+  //completed instead (a late prefetch, not counted as a miss).
+  //If the line is predicted dead and the predictor is in bypass
+  //mode, it is read from main memory without being put in L2.
+
+    uint8_t outcome = (status & L2_PREFETCH_HIT_STATUS_MASK) ? PREFETCH_OUTCOME_PREFETCH_HIT : PREFETCH_OUTCOME_HIT;
+    if (!(status & 0x1)) {
+        if (prefetch_enabled && prefetch_wait_for_fill(address, demand)) {
+            outcome = PREFETCH_OUTCOME_LATE;
         }
+        else {
+            if (software_prefetch)
+                num_sw_prefetch_memory_fills += 1;
+            else
+                num_l2_misses += 1;
+            memory_software_prefetch_filling = software_prefetch;
+            if (dead_block_enabled && demand)
+                dead_block_note_fill(predicted_dead);
+            if (predicted_dead && (dead_block_mode == DEAD_BLOCK_BYPASS)) {
+                memory_main_memory_access(address, NULL, READ_ENABLE_MASK, read_data);
+                bypassed = TRUE;
+            }
+            else {
+                memory_handle_l2_miss(address, READ_ENABLE_MASK);
+                if (ship_enabled && demand)
+                    ship_fill(address, signature);
+            }
+            memory_software_prefetch_filling = FALSE;
+            if (!software_prefetch)
+                memory_demand_queue_delay = memory_read_queue_delay;
+            outcome = PREFETCH_OUTCOME_MISS;
+        }
+        if (!bypassed)
+            l2_cache_access(address, NULL, READ_ENABLE_MASK, read_data, &status);
     }
+
+  //With the memory channels, a line still being transferred from
+  //main memory (e.g. by a prefetch) has to be waited for.
+
+    if (memory_channels_enabled && !software_prefetch && (outcome != PREFETCH_OUTCOME_MISS))
+        memory_demand_queue_delay = memory_channels_wait(address, memory_cycles);
+
+  //A line predicted dead is marked in L2, to be evicted first.
+
+    if (dead_block_enabled && demand && !bypassed)
+        l2_set_dead(address, predicted_dead);
+
+  //Let the prefetchers see the demand access, and account for
+  //the prefetch that brought the line in, if any. A software
+  //prefetch of a line a hardware prefetcher fetched (or was
+  //fetching) is not credited to that prefetcher.
+
+    uint8_t source = (status & L2_PREFETCH_SOURCE_STATUS_MASK) >> L2_PREFETCH_SOURCE_STATUS_SHIFT;
+    if (source == PREFETCH_SOURCE_SOFTWARE)
+        num_sw_prefetches_useful_l2++;
+    else if (software_prefetch && ((outcome == PREFETCH_OUTCOME_PREFETCH_HIT) || (outcome == PREFETCH_OUTCOME_LATE)))
+        num_sw_prefetches_hw_covered++;
+    if (prefetch_enabled && demand)
+        prefetch_demand_access(address, outcome, source, info);
 }
 
 
@@ -185,6 +501,7 @@ void memory_handle_l1_miss(uint32_t address)
 void memory_handle_l2_miss(uint32_t address, uint8_t control)
 {
   uint32_t cache_line[WORDS_PER_CACHE_LINE];
+  uint8_t outer_component = self_profile_enter(SELF_PROFILE_L2_MISS);
 
   //if the L2 miss was on a read operation, then main_memory_access
   //must be called to fetch the needed cache line from main_memory.
@@ -197,7 +514,7 @@ void memory_handle_l2_miss(uint32_t address, uint8_t control)
     uint32_t evicted_writeback_address;
     uint8_t status;
     if (control & READ_ENABLE_MASK) {
-        main_memory_access(address, NULL, READ_ENABLE_MASK, cache_line);
+        memory_main_memory_access(address, NULL, READ_ENABLE_MASK, cache_line);
     }
 
   //Now call l2_insert_line to insert the cache line data from cache_line,
@@ -213,7 +530,121 @@ void memory_handle_l2_miss(uint32_t address, uint8_t control)
   //to write the evicted cache line to main memory.
 
     if (status & 0x1) {
-        main_memory_access(evicted_writeback_address, evicted_writeback_data, WRITE_ENABLE_MASK, NULL);
+        memory_main_memory_access(evicted_writeback_address, evicted_writeback_data, WRITE_ENABLE_MASK, NULL);
+    }
+
+  //Account for an evicted line that was prefetched and never used.
+  //The prefetchers are told about every line evicted from L2.
+
+    if (status & L2_EVICTED_STATUS_MASK) {
+        if (((status & L2_PREFETCH_SOURCE_STATUS_MASK) >> L2_PREFETCH_SOURCE_STATUS_SHIFT) == PREFETCH_SOURCE_SOFTWARE)
+            num_sw_prefetches_useless_l2++;
+        if (prefetch_enabled)
+            prefetch_line_evicted(evicted_writeback_address, status);
+        if (ship_enabled)
+            ship_evicted(evicted_writeback_address);
+    }
+    self_profile_leave(outer_component);
+}
+
+
+//This procedure performs a cache hint operation (see
+//memory_subsystem_constants.h). None of them returns data or
+//counts as an L1 or L2 miss.
+// -- A software prefetch brings the line into L1 (through L2),
+//    or into L2 only, unless it is already there. There is no
+//    coherence to model, so the write intent only matters to
+//    the statistics.
+// -- Demote writes the line back to L2 if it is dirty, and
+//    removes it from L1.
+// -- Evict writes the line back to main memory if it is dirty
+//    (in L1 or L2), and removes it from both caches.
+
+void memory_handle_cache_hint(uint32_t address, uint8_t control)
+{
+    uint32_t l1_data[WORDS_PER_CACHE_LINE];
+    uint8_t status;
+
+    if (control & (SW_PREFETCH_L1_MASK | SW_PREFETCH_L2_MASK)) {
+        BOOL into_l1 = (control & SW_PREFETCH_L1_MASK) != 0;
+        num_sw_prefetches[(into_l1 ? 0 : 1) + ((control & SW_PREFETCH_WRITE_MASK) ? 2 : 0)]++;
+        if (l1_probe(address))
+            num_sw_prefetches_redundant++;
+        else if (into_l1)
+            memory_handle_l1_miss(address, TRUE, NULL);
+        else
+            memory_prefetch_into_l2(address);
+    }
+
+    if (control & DEMOTE_MASK) {
+        num_demotes++;
+        l1_invalidate_line(address, l1_data, &status);
+        if (status & 0x1) {
+            num_hint_writebacks++;
+            memory_write_back_l1_line(address, l1_data);
+        }
+    }
+
+    if (control & EVICT_MASK) {
+        num_evicts++;
+        l1_invalidate_line(address, l1_data, &status);
+        memory_evict_from_l2(address, (status & 0x1) ? l1_data : NULL);
+    }
+}
+
+
+//This procedure brings the line containing the specified address
+//into L2 only, for a software prefetch that missed in L1, unless it
+//is already in L2.
+
+void memory_prefetch_into_l2(uint32_t address)
+{
+    if (filtered_trace_recording)
+        filtered_trace_note(FILTERED_TRACE_SW_PREFETCH_L2, address, NULL, NULL);
+    if (l2_probe(address)) {
+        num_sw_prefetches_redundant++;
+    }
+    else {
+        num_sw_prefetch_memory_fills++;
+        memory_software_prefetch_filling = TRUE;
+        memory_handle_l2_miss(address, READ_ENABLE_MASK);
+        memory_software_prefetch_filling = FALSE;
+        l2_set_prefetch_source(address, PREFETCH_SOURCE_SOFTWARE);
+    }
+}
+
+
+//This procedure removes the line containing the specified address
+//from L2, for an evict hint, and writes it back to main memory if
+//it is dirty. l1_data is the line evicted from L1 at the same time
+//if it was dirty (it is then the most recent copy), or NULL.
+
+void memory_evict_from_l2(uint32_t address, uint32_t l1_data[])
+{
+    uint32_t l2_data[WORDS_PER_CACHE_LINE];
+    uint8_t status;
+
+    if (filtered_trace_recording)
+        filtered_trace_note(FILTERED_TRACE_EVICT, address, NULL, l1_data);
+    l2_invalidate_line(address, l2_data, &status);
+    if (status & L2_EVICTED_STATUS_MASK) {
+        if (((status & L2_PREFETCH_SOURCE_STATUS_MASK) >> L2_PREFETCH_SOURCE_STATUS_SHIFT) == PREFETCH_SOURCE_SOFTWARE)
+            num_sw_prefetches_useless_l2++;
+        if (prefetch_enabled)
+            prefetch_line_evicted(address, status);
+        if (ship_enabled)
+            ship_evicted(address);
+    }
+
+  //The L1 copy, if dirty, is the most recent one.
+
+    if (l1_data) {
+        num_hint_writebacks++;
+        memory_main_memory_access(address, l1_data, WRITE_ENABLE_MASK, NULL);
+    }
+    else if (status & 0x1) {
+        num_hint_writebacks++;
+        memory_main_memory_access(address, l2_data, WRITE_ENABLE_MASK, NULL);
     }
 }
 
@@ -231,6 +662,315 @@ L2 cache to be clear in support of the NRU replacement algorithm.
 void memory_handle_clock_interrupt()
 {
   //call the function to clear the r bits in the L2 cache
+  //(and in the mini-sim's models of it, if enabled)
 
+    if (filtered_trace_recording)
+        filtered_trace_note(FILTERED_TRACE_CLOCK, 0, NULL, NULL);
     l2_clear_r_bits();
-}
\ No newline at end of file
+    if (mini_sim_enabled)
+        mini_sim_clear_r_bits();
+
+  //The clock interrupt also marks the passage of time for
+  //the working-set estimator.
+
+    if (working_set_enabled)
+        working_set_clock_tick();
+}
+
+
+/****************************************************
+
+     memory_enable_working_set()
+
+This procedure enables the working-set estimator over the
+whole of main memory and disables the L1 hit fast path, so
+that L1 hits are recorded too.
+
+*****************************************************/
+
+void memory_enable_working_set(uint8_t window_unit, uint32_t window_length,
+			       FILE *output)
+{
+    working_set_initialize(main_memory_size_in_bytes, window_unit, window_length, output);
+    memory_fast_path_enabled = FALSE;
+}
+
+
+/****************************************************
+
+     memory_enable_page_map()
+
+This procedure enables the page map over the whole of main
+memory. A page color corresponds to a page-sized range of L2
+sets, so there are L2_BYTES_PER_WAY / page size colors (or a
+single color if pages are larger than a way of the L2).
+
+*****************************************************/
+
+void memory_enable_page_map(uint32_t page_shift, uint8_t policy, uint32_t seed)
+{
+    uint32_t num_colors = L2_BYTES_PER_WAY >> page_shift;
+    if (num_colors == 0)
+        num_colors = 1;
+    page_map_initialize(main_memory_size_in_bytes, page_shift, policy, num_colors, seed);
+}
+
+
+/****************************************************
+
+     memory_enable_access_classifier()
+
+This procedure enables the access-pattern classifier. It
+needs to see the value returned by every load (to detect
+pointer chasing), so the L1 hit fast path is disabled.
+
+*****************************************************/
+
+void memory_enable_access_classifier()
+{
+    access_classifier_initialize();
+    memory_fast_path_enabled = FALSE;
+}
+
+
+/****************************************************
+
+     memory_enable_prefetching()
+
+This procedure enables prefetching into the L2 cache, with
+no prefetchers attached yet. Prefetching is driven by L1
+misses only, so the L1 hit fast path stays enabled.
+
+*****************************************************/
+
+void memory_enable_prefetching()
+{
+    prefetch_initialize(main_memory_size_in_bytes);
+}
+
+
+/****************************************************
+
+     memory_enable_dead_block()
+
+This procedure enables the dead-block predictor on demand
+reads of the L2 cache, in the specified mode.
+
+*****************************************************/
+
+void memory_enable_dead_block(uint8_t mode)
+{
+    if (ship_enabled) {
+        printf("Error: the dead-block predictor and SHiP cannot both be enabled\n");
+        exit(1);
+    }
+    dead_block_initialize(mode);
+}
+
+
+/****************************************************
+
+     memory_enable_ship()
+
+This procedure enables the SHiP insertion policy for
+demand fills of the L2 cache, with the specified kind
+of signature.
+
+*****************************************************/
+
+void memory_enable_ship(uint8_t signature_kind)
+{
+    if (dead_block_enabled) {
+        printf("Error: the dead-block predictor and SHiP cannot both be enabled\n");
+        exit(1);
+    }
+    ship_initialize(signature_kind);
+}
+
+
+//This procedure reads or writes a cache line of main memory. With
+//the memory channels or tiers, the transfer is queued on its channel
+//and tier, a compressed page is decompressed, and the time a read
+//takes beyond MAIN_MEMORY_LATENCY is left in memory_read_queue_delay.
+
+void memory_main_memory_access(uint32_t address, uint32_t write_data[],
+			       uint8_t control, uint32_t read_data[])
+{
+    uint32_t delay = 0;
+    uint8_t outer_component = self_profile_enter(SELF_PROFILE_MAIN_MEMORY);
+
+  //Every line that leaves L2 for main memory, or is read from it
+  //(into L2, or around it when the dead-block predictor bypasses
+  //L2), goes to the L3 configurations of the mini-sim. Prefetch
+  //fills update their state, but are not counted as reads.
+
+    if (mini_sim_enabled)
+        mini_sim_access(address, control, MINI_SIM_LEVEL_L3,
+                        !prefetch_filling && !memory_software_prefetch_filling);
+
+    if (compressed_memory_enabled)
+        delay += compressed_memory_access(address, control);
+    if (memory_channels_enabled)
+        delay += memory_channels_access(address, control, memory_cycles);
+    if (memory_tiers_enabled)
+        delay += memory_tiers_access(address, control, memory_cycles);
+    if (control & READ_ENABLE_MASK)
+        memory_read_queue_delay = delay;
+    main_memory_access(address, write_data, control, read_data);
+    self_profile_leave(outer_component);
+}
+
+
+/****************************************************
+
+     memory_enable_latency_model()
+
+This procedure enables the latency model, which needs
+to see every access.
+
+*****************************************************/
+
+void memory_enable_latency_model()
+{
+    memory_latency_model_enabled = TRUE;
+    memory_fast_path_enabled = FALSE;
+}
+
+
+/****************************************************
+
+     memory_enable_store_buffer()
+
+This procedure enables the store buffer, which times
+its stores with the latency model.
+
+*****************************************************/
+
+void memory_enable_store_buffer(uint32_t entries)
+{
+    memory_enable_latency_model();
+    store_buffer_initialize(entries);
+}
+
+
+/****************************************************
+
+     memory_enable_split_l1()
+
+This procedure enables the L1 instruction cache.
+
+*****************************************************/
+
+void memory_enable_split_l1(uint32_t size_in_bytes, uint32_t lines_per_set, uint8_t policy)
+{
+    l1i_initialize(size_in_bytes, lines_per_set, policy);
+}
+
+
+/****************************************************
+
+     memory_enable_channels()
+
+This procedure enables the memory channels, which time
+their transfers with the latency model.
+
+*****************************************************/
+
+void memory_enable_channels(uint32_t num_channels, uint8_t interleave)
+{
+    memory_enable_latency_model();
+    memory_channels_initialize(num_channels, interleave);
+}
+
+
+/****************************************************
+
+     memory_enable_tiers()
+
+This procedure enables the memory tiers, which time
+their transfers with the latency model.
+
+*****************************************************/
+
+void memory_enable_tiers(uint32_t fast_size_in_bytes, uint8_t policy,
+			 uint32_t threshold, uint32_t epoch_length)
+{
+    memory_enable_latency_model();
+    memory_tiers_initialize(main_memory_size_in_bytes, fast_size_in_bytes, policy, threshold, epoch_length);
+}
+
+
+/****************************************************
+
+     memory_enable_compression()
+
+This procedure enables the compressed memory tier.
+
+*****************************************************/
+
+void memory_enable_compression(uint32_t pool_size_in_bytes, uint32_t inactive_epochs,
+			       uint32_t epoch_length)
+{
+    compressed_memory_initialize(main_memory_size_in_bytes, pool_size_in_bytes, inactive_epochs, epoch_length);
+}
+
+
+/****************************************************
+
+     memory_enable_self_profile()
+
+This procedure enables self-profiling, which needs to
+see every access.
+
+*****************************************************/
+
+void memory_enable_self_profile(uint32_t sample_period)
+{
+    self_profile_initialize(sample_period);
+}
+
+
+/****************************************************
+
+     memory_access_timed()
+
+This procedure performs an access that self-profiling times,
+through the L1 hit fast path, if it applies, as an access that
+is not timed would.
+
+*****************************************************/
+
+void memory_access_timed(uint32_t address, uint32_t write_data,
+			 uint8_t control, uint32_t *read_data,
+			 const MEMORY_REQUEST_INFO *info)
+{
+    if (!(memory_fast_path_enabled && !(control & CACHE_HINT_MASK) &&
+          !(l1i_enabled && info && (info->access_type == MEMORY_ACCESS_INSTRUCTION)) &&
+          l1_cache_access_hit(address, write_data, control, read_data)))
+        memory_access_slow(address, write_data, control, read_data, info);
+    self_profile_end_access();
+}
+
+
+/****************************************************
+
+     memory_cache_hint_report()
+
+This procedure prints the software prefetch and cache
+hint statistics.
+
+*****************************************************/
+
+void memory_cache_hint_report()
+{
+    uint32_t issued = num_sw_prefetches[0] + num_sw_prefetches[1] + num_sw_prefetches[2] + num_sw_prefetches[3];
+
+    printf("Software prefetches: %u (L1 read %u, L2 read %u, L1 write %u, L2 write %u), %u redundant\n",
+           issued, num_sw_prefetches[0], num_sw_prefetches[1], num_sw_prefetches[2], num_sw_prefetches[3],
+           num_sw_prefetches_redundant);
+    printf("  %u lines fetched from main memory\n", num_sw_prefetch_memory_fills);
+    printf("  into L1: %u used, %u evicted unused\n", num_sw_prefetches_useful_l1, num_sw_prefetches_useless_l1);
+    printf("  into L2: %u used, %u evicted unused\n", num_sw_prefetches_useful_l2, num_sw_prefetches_useless_l2);
+    printf("  %u of lines already fetched, or being fetched, by a hardware prefetcher\n", num_sw_prefetches_hw_covered);
+    printf("Cache hints: %u demotes, %u evicts, %u write-backs\n", num_demotes, num_evicts, num_hint_writebacks);
+}
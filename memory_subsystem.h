@@ -1,4 +1,11 @@
+#ifndef MEMORY_SUBSYSTEM_H
+#define MEMORY_SUBSYSTEM_H
 
+#include "l1_cache.h"
+#include "l1i_cache.h"
+#include "page_map.h"
+#include "memory_request.h"
+#include "self_profile.h"
 
 /*******************************************************
 
@@ -27,10 +34,12 @@ address:  32-bit address of the data being read or written.
 write_data: In the case of a memory write, the 32-bit value
           being written.
 
-control:  an unsigned byte (8 bits), of which only the two lowest bits
-          are meaningful, as follows:
+control:  an unsigned byte (8 bits), as follows:
           -- bit 0:  read enable (1 means read, 0 means don't read)
           -- bit 1:  write enable (1 means write, 0 means don't write)
+          -- bits 2-6: cache hint operations (software prefetch,
+             demote and evict), in which case bits 0 and 1 must be 0.
+             See memory_subsystem_constants.h.
 
 read_data: a 32-bit ouput parameter (thus, a pointer to it is passed).
          In the case of a read operation, the data being read will
@@ -38,8 +47,66 @@ read_data: a 32-bit ouput parameter (thus, a pointer to it is passed).
 
 ****************************************************/
 
-void memory_access(uint32_t address, uint32_t write_data,
-		   uint8_t control, uint32_t *read_data);
+//memory_access() is defined inline below. An L1 hit is handled
+//entirely by l1_cache_access_hit() (see l1_cache.h); anything else
+//falls into memory_access_slow(), in memory_subsystem.c, which
+//handles the miss and any enabled per-access statistics.
+
+//The fast path is disabled while a feature that needs to see
+//every access (not just L1 misses) is enabled, e.g. the
+//working-set estimator.
+extern BOOL memory_fast_path_enabled;
+
+void memory_access_slow(uint32_t address, uint32_t write_data,
+			uint8_t control, uint32_t *read_data,
+			const MEMORY_REQUEST_INFO *info);
+
+//With self-profiling, one access in every sample period goes to
+//memory_access_timed() instead (see self_profile.h).
+void memory_access_timed(uint32_t address, uint32_t write_data,
+			 uint8_t control, uint32_t *read_data,
+			 const MEMORY_REQUEST_INFO *info);
+
+static inline void memory_access(uint32_t address, uint32_t write_data,
+				 uint8_t control, uint32_t *read_data)
+{
+    if (self_profile_enabled && self_profile_start_access()) {
+        memory_access_timed(address, write_data, control, read_data, NULL);
+        return;
+    }
+    if (memory_fast_path_enabled && !(control & CACHE_HINT_MASK) &&
+        l1_cache_access_hit(address, write_data, control, read_data))
+        return;
+    memory_access_slow(address, write_data, control, read_data, NULL);
+}
+
+
+/*****************************************************
+
+              memory_access_with_info()
+
+This is the same as memory_access(), with the metadata of the
+request (see memory_request.h). The metadata is only looked at
+past an L1 hit, by the policies that use it, except that an
+instruction fetch goes to the L1 instruction cache if it is
+enabled (see memory_enable_split_l1()).
+
+****************************************************/
+
+static inline void memory_access_with_info(uint32_t address, uint32_t write_data,
+					   uint8_t control, uint32_t *read_data,
+					   const MEMORY_REQUEST_INFO *info)
+{
+    if (self_profile_enabled && self_profile_start_access()) {
+        memory_access_timed(address, write_data, control, read_data, info);
+        return;
+    }
+    if (memory_fast_path_enabled && !(control & CACHE_HINT_MASK) &&
+        !(l1i_enabled && info && (info->access_type == MEMORY_ACCESS_INSTRUCTION)) &&
+        l1_cache_access_hit(address, write_data, control, read_data))
+        return;
+    memory_access_slow(address, write_data, control, read_data, info);
+}
 
 
 
@@ -54,4 +121,237 @@ L1 cache to be clear in support of the NRU replacement algorithm.
 *******************************************************/
 
 void memory_handle_clock_interrupt();
- 
+
+
+/****************************************************
+
+     memory_cache_hint_report()
+
+This procedure prints the number of software prefetches of each
+kind, how many of them were redundant, fetched a line from main
+memory, were used or were evicted unused, or were of a line a
+hardware prefetcher had fetched or was fetching, and the number of
+demote and evict hints. Software prefetches are not demand reads:
+the hardware prefetchers, the dead-block predictor and SHiP do not
+see them.
+
+*******************************************************/
+
+void memory_cache_hint_report();
+
+
+/****************************************************
+
+     memory_enable_working_set()
+
+This procedure enables the working-set estimator (see working_set.h)
+over the whole of main memory. Since the estimator must see every
+access, this also disables the L1 hit fast path.
+
+*******************************************************/
+
+void memory_enable_working_set(uint8_t window_unit, uint32_t window_length,
+			       FILE *output);
+
+
+/****************************************************
+
+     memory_enable_page_map()
+
+This procedure enables the page map (see page_map.h) over the whole
+of main memory, with as many page colors as there are pages in one
+way of the L2 cache (64 for 4KB pages, 1 for 2MB pages).
+
+*******************************************************/
+
+void memory_enable_page_map(uint32_t page_shift, uint8_t policy, uint32_t seed);
+
+
+/****************************************************
+
+     memory_enable_access_classifier()
+
+This procedure enables the access-pattern classifier (see
+access_classifier.h) on the L1 miss stream. Since the classifier
+also looks at every loaded value, this disables the L1 hit fast
+path.
+
+*******************************************************/
+
+void memory_enable_access_classifier();
+
+
+/****************************************************
+
+     memory_enable_prefetching()
+
+This procedure enables prefetching into the L2 cache (see
+prefetch.h) over the whole of main memory. Prefetchers are then
+attached with prefetch_attach().
+
+*******************************************************/
+
+void memory_enable_prefetching();
+
+
+/****************************************************
+
+     memory_enable_dead_block()
+
+This procedure enables the dead-block predictor (see dead_block.h)
+for the L2 cache, with the specified mode: DEAD_BLOCK_BYPASS or
+DEAD_BLOCK_LOW_PRIORITY.
+
+*******************************************************/
+
+void memory_enable_dead_block(uint8_t mode);
+
+
+/****************************************************
+
+     memory_enable_ship()
+
+This procedure enables the SHiP insertion policy (see ship.h) for
+the L2 cache, with the specified kind of signature:
+SHIP_SIGNATURE_PC, SHIP_SIGNATURE_MEMORY or SHIP_SIGNATURE_ISEQ.
+SHiP and the dead-block predictor cannot both be enabled.
+
+*******************************************************/
+
+void memory_enable_ship(uint8_t signature_kind);
+
+
+/****************************************************
+
+     memory_enable_latency_model()
+
+This procedure enables the latency model: memory_cycles is
+advanced by the latency of each access, which is the latency of
+the level that served it (see below). Accesses are performed one
+at a time, except for stores if the store buffer is enabled (see
+store_buffer.h). Since the model must see every access, this
+disables the L1 hit fast path.
+
+*******************************************************/
+
+#define L1_HIT_LATENCY 4
+#define L2_HIT_LATENCY 14
+#define MAIN_MEMORY_LATENCY 200
+
+//The number of cycles elapsed, cleared by memory_subsystem_initialize().
+extern uint64_t memory_cycles;
+
+void memory_enable_latency_model();
+
+
+/****************************************************
+
+     memory_enable_store_buffer()
+
+This procedure enables a store buffer with the specified number
+of entries in front of the L1 cache (see store_buffer.h), along
+with the latency model.
+
+*******************************************************/
+
+void memory_enable_store_buffer(uint32_t entries);
+
+
+/****************************************************
+
+     memory_enable_split_l1()
+
+This procedure splits the L1 cache: an L1 instruction cache (see
+l1i_cache.h) of size_in_bytes bytes, with lines_per_set lines per
+set and the specified replacement policy (L1I_POLICY_LRU or
+L1I_POLICY_FIFO), serves the instruction fetches, and the L1 cache
+(still the fixed 64KB direct-mapped cache, see l1i_cache.h) serves
+the data accesses. From then on, num_l1_misses only counts
+L1D misses; the L1I misses are counted in l1i_misses.
+
+*******************************************************/
+
+void memory_enable_split_l1(uint32_t size_in_bytes, uint32_t lines_per_set, uint8_t policy);
+
+
+/****************************************************
+
+     memory_enable_channels()
+
+This procedure divides main memory into num_channels channels,
+with the specified interleaving (MEMORY_INTERLEAVE_..., see
+memory_channels.h), along with the latency model. A demand read
+of main memory then also waits for its channel to be free.
+
+*******************************************************/
+
+void memory_enable_channels(uint32_t num_channels, uint8_t interleave);
+
+
+/****************************************************
+
+     memory_enable_tiers()
+
+This procedure divides main memory into a fast tier of
+fast_size_in_bytes bytes and a slow tier holding the rest, with
+hot pages migrated to the fast tier by the specified policy
+(MEMORY_TIER_POLICY_..., see memory_tiers.h), along with the
+latency model. A page is hot if it was read from main memory at
+least threshold times in an epoch of epoch_length reads.
+
+*******************************************************/
+
+void memory_enable_tiers(uint32_t fast_size_in_bytes, uint8_t policy,
+			 uint32_t threshold, uint32_t epoch_length);
+
+
+/****************************************************
+
+     memory_enable_compression()
+
+This procedure enables the compressed memory tier (see
+compressed_memory.h): pages of main memory not accessed for
+inactive_epochs epochs of epoch_length main memory accesses are
+compressed into a pool of up to pool_size_in_bytes bytes, and
+decompressed on their next access.
+
+*******************************************************/
+
+void memory_enable_compression(uint32_t pool_size_in_bytes, uint32_t inactive_epochs,
+			       uint32_t epoch_length);
+
+
+/****************************************************
+
+     memory_enable_self_profile()
+
+This procedure enables self-profiling (see self_profile.h): one
+access in every sample_period is timed on the host, and
+self_profile_report() prints the accesses simulated per host
+second and the host time spent in the L1 path, the L1 and L2 miss
+handling, main memory, and outside of the memory subsystem. The
+L1 hit fast path stays enabled.
+
+*******************************************************/
+
+void memory_enable_self_profile(uint32_t sample_period);
+
+
+/*****************************************************
+
+              memory_access_virtual()
+
+This is the same as memory_access(), except that the address is
+a virtual address. If the page map is enabled, it is translated
+to a physical address first; otherwise, it is used as is.
+
+****************************************************/
+
+static inline void memory_access_virtual(uint32_t virtual_address, uint32_t write_data,
+					 uint8_t control, uint32_t *read_data)
+{
+    uint32_t address = page_map_enabled ? page_map_translate(virtual_address) : virtual_address;
+    memory_access(address, write_data, control, read_data);
+}
+
+#endif
@@ -20,3 +20,19 @@
 #define READ_ENABLE_MASK 0x1
 #define WRITE_ENABLE_MASK 0x2
 
+//The other bits of the control byte passed to memory_access()
+//specify cache hint operations, which neither read nor write any
+//data (bits 0 and 1 must then be 0):
+//  bit 2: software prefetch of the line into L1 (and L2)
+//  bit 3: software prefetch of the line into L2 only
+//  bit 4: with bit 2 or 3, the line is prefetched to be written
+//  bit 5: demote the line from L1 to L2 (like cldemote)
+//  bit 6: write back the line if dirty and evict it from
+//         L1 and L2 (like clflushopt)
+
+#define SW_PREFETCH_L1_MASK 0x4
+#define SW_PREFETCH_L2_MASK 0x8
+#define SW_PREFETCH_WRITE_MASK 0x10
+#define DEMOTE_MASK 0x20
+#define EVICT_MASK 0x40
+#define CACHE_HINT_MASK (SW_PREFETCH_L1_MASK | SW_PREFETCH_L2_MASK | DEMOTE_MASK | EVICT_MASK)
@@ -0,0 +1,290 @@
+/************************************************************
+
+   This file contains the two-tier main memory model
+   (see memory_tiers.h).
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "memory_tiers.h"
+
+//The tier of a page that has not been accessed yet.
+#define MEMORY_TIER_NONE 2
+
+BOOL memory_tiers_enabled = FALSE;
+uint32_t memory_tier_fast_size_in_bytes;
+uint8_t memory_tier_policy;
+uint32_t memory_tier_threshold;
+uint32_t memory_tier_epoch_length;
+
+//Per page: its tier, its reads in epoch page_epoch, and whether it
+//has been accessed since the CLOCK hand last passed it.
+uint32_t memory_tier_num_pages;
+uint8_t *memory_tier_page_tier;
+uint32_t *memory_tier_page_reads;
+uint32_t *memory_tier_page_epoch;
+BOOL *memory_tier_page_referenced;
+
+//The pages in the fast tier, swept by the CLOCK hand.
+uint32_t *memory_tier_fast_pages;
+uint32_t memory_tier_fast_capacity;
+uint32_t memory_tier_num_fast;
+uint32_t memory_tier_clock_hand;
+
+uint32_t memory_tier_epoch;
+uint32_t memory_tier_epoch_reads;
+
+//MEMORY_TIER_POLICY_EPOCH: the slow pages that reached the
+//threshold during the epoch.
+#define MEMORY_TIER_MAX_CANDIDATES (4 * MEMORY_TIER_MAX_EPOCH_PROMOTIONS)
+uint32_t memory_tier_candidates[MEMORY_TIER_MAX_CANDIDATES];
+uint32_t memory_tier_num_candidates;
+
+//Per tier: when its last transfer completes, and statistics.
+uint64_t memory_tier_busy_until[2];
+uint64_t memory_tier_reads[2];
+uint64_t memory_tier_writes[2];
+uint64_t memory_tier_queue_cycles[2];
+
+uint64_t memory_tier_promotions;
+uint64_t memory_tier_demotions;
+uint64_t memory_tier_migration_lines;
+
+static const uint32_t memory_tier_busy_cycles[2] = {MEMORY_TIER_FAST_BUSY_CYCLES, MEMORY_TIER_SLOW_BUSY_CYCLES};
+
+
+void memory_tiers_initialize(uint32_t memory_size_in_bytes, uint32_t fast_size_in_bytes,
+			     uint8_t policy, uint32_t threshold, uint32_t epoch_length)
+{
+    if (fast_size_in_bytes & (MEMORY_TIER_PAGE_SIZE - 1)) {
+        printf("Error: the fast tier must be a multiple of %d bytes\n", MEMORY_TIER_PAGE_SIZE);
+        exit(1);
+    }
+    if ((policy > MEMORY_TIER_POLICY_LRU) || (threshold == 0) || (epoch_length == 0)) {
+        printf("Error: invalid memory tier migration policy\n");
+        exit(1);
+    }
+    memory_tier_fast_size_in_bytes = fast_size_in_bytes;
+    memory_tier_policy = policy;
+    memory_tier_threshold = threshold;
+    memory_tier_epoch_length = epoch_length;
+
+    free(memory_tier_page_tier);
+    free(memory_tier_page_reads);
+    free(memory_tier_page_epoch);
+    free(memory_tier_page_referenced);
+    free(memory_tier_fast_pages);
+    memory_tier_num_pages = (memory_size_in_bytes + MEMORY_TIER_PAGE_SIZE - 1) >> MEMORY_TIER_PAGE_SHIFT;
+    memory_tier_page_tier = malloc(memory_tier_num_pages);
+    memory_tier_page_reads = calloc(memory_tier_num_pages, sizeof(uint32_t));
+    memory_tier_page_epoch = calloc(memory_tier_num_pages, sizeof(uint32_t));
+    memory_tier_page_referenced = calloc(memory_tier_num_pages, sizeof(BOOL));
+    for (uint32_t page = 0; page < memory_tier_num_pages; page++)
+        memory_tier_page_tier[page] = MEMORY_TIER_NONE;
+    memory_tier_fast_capacity = fast_size_in_bytes >> MEMORY_TIER_PAGE_SHIFT;
+    memory_tier_fast_pages = malloc((memory_tier_fast_capacity + 1) * sizeof(uint32_t));
+    memory_tier_num_fast = 0;
+    memory_tier_clock_hand = 0;
+
+    memory_tier_epoch = 0;
+    memory_tier_epoch_reads = 0;
+    memory_tier_num_candidates = 0;
+    for (int tier = 0; tier < 2; tier++) {
+        memory_tier_busy_until[tier] = 0;
+        memory_tier_reads[tier] = 0;
+        memory_tier_writes[tier] = 0;
+        memory_tier_queue_cycles[tier] = 0;
+    }
+    memory_tier_promotions = 0;
+    memory_tier_demotions = 0;
+    memory_tier_migration_lines = 0;
+    memory_tiers_enabled = TRUE;
+}
+
+
+uint8_t memory_tier_of(uint32_t address)
+{
+    return memory_tier_page_tier[address >> MEMORY_TIER_PAGE_SHIFT];
+}
+
+
+//Copies a page from one tier to the other, which keeps both busy
+//for a page's worth of line transfers, starting at time.
+
+static void memory_tier_copy_page(uint64_t time)
+{
+    uint32_t lines = MEMORY_TIER_PAGE_SIZE / BYTES_PER_CACHE_LINE;
+    for (int tier = 0; tier < 2; tier++) {
+        if (memory_tier_busy_until[tier] < time)
+            memory_tier_busy_until[tier] = time;
+        memory_tier_busy_until[tier] += lines * memory_tier_busy_cycles[tier];
+    }
+    memory_tier_migration_lines += lines;
+}
+
+
+//Moves a slow page to the fast tier, demoting the fast page chosen
+//by the CLOCK algorithm (the first one not accessed since the hand
+//last passed it) if the fast tier is full.
+
+static void memory_tier_promote(uint32_t page, uint64_t time)
+{
+    uint32_t slot;
+
+    if (memory_tier_fast_capacity == 0)
+        return;
+    if (memory_tier_num_fast < memory_tier_fast_capacity) {
+        slot = memory_tier_num_fast++;
+    }
+    else {
+        while (memory_tier_page_referenced[memory_tier_fast_pages[memory_tier_clock_hand]]) {
+            memory_tier_page_referenced[memory_tier_fast_pages[memory_tier_clock_hand]] = FALSE;
+            memory_tier_clock_hand = (memory_tier_clock_hand + 1) % memory_tier_fast_capacity;
+        }
+        slot = memory_tier_clock_hand;
+        memory_tier_clock_hand = (memory_tier_clock_hand + 1) % memory_tier_fast_capacity;
+        memory_tier_page_tier[memory_tier_fast_pages[slot]] = MEMORY_TIER_SLOW;
+        memory_tier_copy_page(time);
+        memory_tier_demotions++;
+    }
+    memory_tier_fast_pages[slot] = page;
+    memory_tier_page_tier[page] = MEMORY_TIER_FAST;
+    memory_tier_page_referenced[page] = TRUE;
+    memory_tier_copy_page(time);
+    memory_tier_promotions++;
+}
+
+
+//Returns the reads of a page in the current epoch.
+
+static uint32_t memory_tier_reads_in_epoch(uint32_t page)
+{
+    return (memory_tier_page_epoch[page] == memory_tier_epoch) ? memory_tier_page_reads[page] : 0;
+}
+
+
+//Ends the epoch. With MEMORY_TIER_POLICY_EPOCH, the candidates
+//are promoted, hottest first.
+
+static void memory_tier_end_epoch(uint64_t time)
+{
+    uint32_t promoted = 0;
+
+    while ((promoted < MEMORY_TIER_MAX_EPOCH_PROMOTIONS) && memory_tier_num_candidates) {
+        uint32_t hottest = 0;
+        for (uint32_t i = 1; i < memory_tier_num_candidates; i++) {
+            if (memory_tier_reads_in_epoch(memory_tier_candidates[i]) >
+                memory_tier_reads_in_epoch(memory_tier_candidates[hottest]))
+                hottest = i;
+        }
+        uint32_t page = memory_tier_candidates[hottest];
+        memory_tier_candidates[hottest] = memory_tier_candidates[--memory_tier_num_candidates];
+        if (memory_tier_page_tier[page] == MEMORY_TIER_SLOW) {
+            memory_tier_promote(page, time);
+            promoted++;
+        }
+    }
+    memory_tier_num_candidates = 0;
+    memory_tier_epoch++;
+    memory_tier_epoch_reads = 0;
+}
+
+
+uint32_t memory_tiers_access(uint32_t address, uint8_t control, uint64_t time)
+{
+    uint32_t page = address >> MEMORY_TIER_PAGE_SHIFT;
+    if (page >= memory_tier_num_pages)
+        return 0;
+
+  //A page is placed on its first access.
+
+    if (memory_tier_page_tier[page] == MEMORY_TIER_NONE) {
+        if (memory_tier_num_fast < memory_tier_fast_capacity) {
+            memory_tier_fast_pages[memory_tier_num_fast++] = page;
+            memory_tier_page_tier[page] = MEMORY_TIER_FAST;
+        }
+        else {
+            memory_tier_page_tier[page] = MEMORY_TIER_SLOW;
+        }
+    }
+    memory_tier_page_referenced[page] = TRUE;
+
+  //The transfer starts when the tier is free.
+
+    uint8_t tier = memory_tier_page_tier[page];
+    uint64_t start = (memory_tier_busy_until[tier] > time) ? memory_tier_busy_until[tier] : time;
+    memory_tier_busy_until[tier] = start + memory_tier_busy_cycles[tier];
+    memory_tier_queue_cycles[tier] += start - time;
+    if (!(control & READ_ENABLE_MASK)) {
+        memory_tier_writes[tier]++;
+        return 0;
+    }
+    memory_tier_reads[tier]++;
+    uint32_t delay = (uint32_t) (start - time);
+    if (tier == MEMORY_TIER_SLOW)
+        delay += MEMORY_TIER_SLOW_LATENCY - MAIN_MEMORY_LATENCY;
+
+  //Count the read towards the page's hotness, and migrate it
+  //according to the policy.
+
+    if (memory_tier_page_epoch[page] != memory_tier_epoch) {
+        memory_tier_page_epoch[page] = memory_tier_epoch;
+        memory_tier_page_reads[page] = 0;
+    }
+    memory_tier_page_reads[page]++;
+    if (tier == MEMORY_TIER_SLOW) {
+        switch (memory_tier_policy) {
+        case MEMORY_TIER_POLICY_THRESHOLD:
+            if (memory_tier_page_reads[page] >= memory_tier_threshold)
+                memory_tier_promote(page, start);
+            break;
+        case MEMORY_TIER_POLICY_EPOCH:
+            if ((memory_tier_page_reads[page] == memory_tier_threshold) &&
+                (memory_tier_num_candidates < MEMORY_TIER_MAX_CANDIDATES))
+                memory_tier_candidates[memory_tier_num_candidates++] = page;
+            break;
+        case MEMORY_TIER_POLICY_LRU:
+            memory_tier_promote(page, start);
+            break;
+        }
+    }
+    if (++memory_tier_epoch_reads == memory_tier_epoch_length)
+        memory_tier_end_epoch(time);
+    return delay;
+}
+
+
+double memory_tiers_fast_fraction()
+{
+    uint64_t reads = memory_tier_reads[MEMORY_TIER_FAST] + memory_tier_reads[MEMORY_TIER_SLOW];
+    return reads ? (double) memory_tier_reads[MEMORY_TIER_FAST] / reads : 0.0;
+}
+
+
+void memory_tiers_report()
+{
+    const char *policies[] = {"no migration", "threshold", "epoch", "LRU"};
+    uint64_t reads = memory_tier_reads[MEMORY_TIER_FAST] + memory_tier_reads[MEMORY_TIER_SLOW];
+
+    printf("Memory tiers: %u KB fast, %u KB slow, %s policy\n", memory_tier_fast_size_in_bytes >> 10,
+           (memory_tier_num_pages - memory_tier_fast_capacity) * (MEMORY_TIER_PAGE_SIZE >> 10),
+           policies[memory_tier_policy]);
+    printf("  reads: %llu (%.2f%%) from the fast tier, %llu (%.2f%%) from the slow tier\n",
+           (unsigned long long) memory_tier_reads[MEMORY_TIER_FAST], 100.0 * memory_tiers_fast_fraction(),
+           (unsigned long long) memory_tier_reads[MEMORY_TIER_SLOW],
+           reads ? 100.0 * memory_tier_reads[MEMORY_TIER_SLOW] / reads : 0.0);
+    printf("  %llu promotions, %llu demotions, %llu KB of migration traffic\n",
+           (unsigned long long) memory_tier_promotions, (unsigned long long) memory_tier_demotions,
+           (unsigned long long) (memory_tier_migration_lines * BYTES_PER_CACHE_LINE) >> 10);
+    for (int tier = 0; tier < 2; tier++) {
+        uint64_t transfers = memory_tier_reads[tier] + memory_tier_writes[tier];
+        printf("  %s tier: %llu writes, average queueing delay = %.1f cycles\n", tier ? "slow" : "fast",
+               (unsigned long long) memory_tier_writes[tier],
+               transfers ? (double) memory_tier_queue_cycles[tier] / transfers : 0.0);
+    }
+}
@@ -0,0 +1,123 @@
+/************************************************************
+
+    Two-tier main memory with hot page migration.
+
+Main memory is divided into pages of MEMORY_TIER_PAGE_SIZE bytes,
+each placed in one of two tiers: a fast tier (e.g. local DRAM) of
+a given capacity, and a slow tier (e.g. CXL-attached or persistent
+memory) with a higher latency and lower bandwidth holding the rest.
+A page is placed when it is first accessed in main memory: in the
+fast tier while there is room, else in the slow tier.
+
+Timing follows the latency model (see memory_subsystem.h). Each
+tier serves one cache line transfer at a time, taking
+MEMORY_TIER_FAST_BUSY_CYCLES or MEMORY_TIER_SLOW_BUSY_CYCLES; a
+demand read waits for its tier to be free, and a read from the slow
+tier takes MEMORY_TIER_SLOW_LATENCY instead of MAIN_MEMORY_LATENCY.
+
+The hotness of a page is the number of times it was read from main
+memory (i.e. L2 misses and prefetch fills) during the current epoch
+of epoch_length reads. The migration policy promotes hot pages from
+the slow tier to the fast tier, demoting a cold fast page, chosen
+with the CLOCK algorithm, when the fast tier is full:
+
+  MEMORY_TIER_POLICY_NONE:      pages stay where they were placed.
+  MEMORY_TIER_POLICY_THRESHOLD: a slow page is promoted as soon as it
+                                has been read threshold times in the
+                                epoch.
+  MEMORY_TIER_POLICY_EPOCH:     at the end of each epoch, the slow
+                                pages read at least threshold times
+                                are promoted, hottest first, up to
+                                MEMORY_TIER_MAX_EPOCH_PROMOTIONS.
+  MEMORY_TIER_POLICY_LRU:       every read of a slow page promotes
+                                it, and the fast tier is managed as
+                                an (approximate) LRU cache of pages.
+
+A migration copies the page from one tier to the other, which keeps
+both tiers busy for a page's worth of line transfers: this traffic
+is accounted, and delays the demand reads that queue behind it.
+
+************************************************************/
+
+#define MEMORY_TIER_PAGE_SHIFT 12
+#define MEMORY_TIER_PAGE_SIZE (1 << MEMORY_TIER_PAGE_SHIFT)
+
+#define MEMORY_TIER_FAST 0
+#define MEMORY_TIER_SLOW 1
+
+#define MEMORY_TIER_SLOW_LATENCY 500
+#define MEMORY_TIER_FAST_BUSY_CYCLES 10
+#define MEMORY_TIER_SLOW_BUSY_CYCLES 40
+
+#define MEMORY_TIER_POLICY_NONE 0
+#define MEMORY_TIER_POLICY_THRESHOLD 1
+#define MEMORY_TIER_POLICY_EPOCH 2
+#define MEMORY_TIER_POLICY_LRU 3
+
+#define MEMORY_TIER_MAX_EPOCH_PROMOTIONS 64
+
+//Set by memory_tiers_initialize().
+extern BOOL memory_tiers_enabled;
+extern uint32_t memory_tier_fast_size_in_bytes;
+extern uint8_t memory_tier_policy;
+extern uint32_t memory_tier_threshold;
+extern uint32_t memory_tier_epoch_length;
+
+
+/************************************************
+
+       memory_tiers_initialize()
+
+This procedure places every page of a main memory of
+memory_size_in_bytes bytes back in no tier, sets the capacity of
+the fast tier (a multiple of MEMORY_TIER_PAGE_SIZE) and the
+migration policy, clears the statistics and enables the tiers.
+
+***********************************************/
+
+void memory_tiers_initialize(uint32_t memory_size_in_bytes, uint32_t fast_size_in_bytes,
+			     uint8_t policy, uint32_t threshold, uint32_t epoch_length);
+
+
+/************************************************
+
+       memory_tiers_access()
+
+This procedure is called for every cache line read from
+(control = READ_ENABLE_MASK) or written to main memory at the
+specified cycle. It places the page if needed, runs the migration
+policy and returns the cycles a read takes beyond
+MAIN_MEMORY_LATENCY: the time waiting for its tier and, from the
+slow tier, the extra latency.
+
+***********************************************/
+
+uint32_t memory_tiers_access(uint32_t address, uint8_t control, uint64_t time);
+
+
+/************************************************
+
+       memory_tier_of()
+
+This procedure returns the tier (MEMORY_TIER_FAST or
+MEMORY_TIER_SLOW) of the page containing the specified
+address, which must have been placed.
+
+***********************************************/
+
+uint8_t memory_tier_of(uint32_t address);
+
+
+/************************************************
+
+       memory_tiers_fast_fraction(), memory_tiers_report()
+
+memory_tiers_fast_fraction() returns the fraction of the reads
+from main memory served by the fast tier. memory_tiers_report()
+prints the reads served by each tier, the promotions, demotions
+and migration traffic, and the average queueing delay of each tier.
+
+***********************************************/
+
+double memory_tiers_fast_fraction();
+void memory_tiers_report();
@@ -0,0 +1,398 @@
+/************************************************************
+
+   This file contains the miniature cache simulator ("mini-sim").
+
+   Each configuration models a cache with num_sets sets of
+   lines_per_set lines. Only tags are kept (no data), and only the
+   sets whose hashed set index is 0 modulo the sampling rate are
+   simulated. Each sampled set keeps its own access and miss counts,
+   so that the variation among the sampled sets can be used to
+   compute the standard error of the extrapolated miss ratio.
+
+   The set index and tag are taken from the address exactly as in
+   the L2 cache: the lowest 6 bits are the offset within the cache
+   line, the next log2(num_sets) bits are the set index. For
+   simplicity, the whole line address (address >> 6) is stored as
+   the tag.
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "memory_subsystem_constants.h"
+#include "mini_sim.h"
+
+
+//Per-line state bits of a mini-sim cache entry.
+#define MINI_SIM_VBIT_MASK 0x1
+#define MINI_SIM_RBIT_MASK 0x2
+#define MINI_SIM_DIRTYBIT_MASK 0x4
+
+//In slot_of_set, indicates that a set is not sampled.
+#define MINI_SIM_NOT_SAMPLED (-1)
+
+#define MINI_SIM_LINE_SHIFT 6
+
+/***************************************************
+This struct holds one miniature cache configuration.
+  slot_of_set: for each set of the full cache, the index of
+               the set among the sampled sets, or
+               MINI_SIM_NOT_SAMPLED.
+  tags, flags, lru_stamps: num_sampled_sets * lines_per_set
+               entries, one per line of the sampled sets.
+  set_accesses, set_misses: per sampled set read counts.
+  total_accesses: read accesses seen by the configuration,
+               sampled or not. Used to extrapolate the
+               number of misses of the full cache.
+****************************************************/
+
+typedef struct {
+  uint8_t level;
+  uint32_t size_in_bytes;
+  uint32_t num_sets;
+  uint32_t lines_per_set;
+  uint8_t policy;
+  uint32_t sampling_rate;
+  int32_t *slot_of_set;
+  uint32_t num_sampled_sets;
+  uint32_t *tags;
+  uint8_t *flags;
+  uint32_t *lru_stamps;
+  uint32_t lru_clock;
+  uint32_t *set_accesses;
+  uint32_t *set_misses;
+  uint64_t total_accesses;
+} MINI_SIM_CONFIG;
+
+
+MINI_SIM_CONFIG mini_sim_configs[MINI_SIM_MAX_CONFIGS];
+int mini_sim_num_configs;
+
+BOOL mini_sim_enabled = FALSE;
+
+
+//Mixes the bits of the set index, so that the sampled sets
+//are spread over the cache rather than being every Nth set.
+
+static uint32_t mini_sim_hash(uint32_t x)
+{
+    x ^= x >> 16;
+    x *= 0x7feb352d;
+    x ^= x >> 15;
+    x *= 0x846ca68b;
+    x ^= x >> 16;
+    return x;
+}
+
+
+/************************************************
+            mini_sim_initialize()
+
+This procedure discards any configurations that have
+been added and enables the mini-sim.
+************************************************/
+
+void mini_sim_initialize()
+{
+    for (int c = 0; c < mini_sim_num_configs; c++) {
+        free(mini_sim_configs[c].slot_of_set);
+        free(mini_sim_configs[c].tags);
+        free(mini_sim_configs[c].flags);
+        free(mini_sim_configs[c].lru_stamps);
+        free(mini_sim_configs[c].set_accesses);
+        free(mini_sim_configs[c].set_misses);
+    }
+    mini_sim_num_configs = 0;
+    mini_sim_enabled = TRUE;
+}
+
+
+/************************************************************
+
+            mini_sim_add_config()
+
+This procedure adds a miniature cache configuration and returns
+its index. See mini_sim.h.
+
+************************************************************/
+
+int mini_sim_add_config(uint32_t size_in_bytes, uint32_t lines_per_set,
+			uint8_t policy, uint32_t sampling_rate, uint8_t level)
+{
+    if (mini_sim_num_configs == MINI_SIM_MAX_CONFIGS) {
+        printf("Error: at most %d mini-sim configurations are supported\n", MINI_SIM_MAX_CONFIGS);
+        exit(1);
+    }
+    if ((lines_per_set == 0) || (sampling_rate == 0)) {
+        printf("Error: mini-sim lines per set and sampling rate must be non-zero\n");
+        exit(1);
+    }
+    if ((level != MINI_SIM_LEVEL_L2) && (level != MINI_SIM_LEVEL_L3)) {
+        printf("Error: mini-sim level %u is neither MINI_SIM_LEVEL_L2 nor MINI_SIM_LEVEL_L3\n", level);
+        exit(1);
+    }
+
+  //The number of sets must be a power of 2, so that the set index
+  //is a field of the address.
+
+    uint32_t num_sets = size_in_bytes / (BYTES_PER_CACHE_LINE * lines_per_set);
+    if ((num_sets == 0) || (num_sets & (num_sets - 1)) ||
+        (num_sets * BYTES_PER_CACHE_LINE * lines_per_set != size_in_bytes)) {
+        printf("Error: mini-sim cache of %u bytes with %u lines per set does not have a power of 2 number of sets\n",
+               size_in_bytes, lines_per_set);
+        exit(1);
+    }
+
+    MINI_SIM_CONFIG *config = &mini_sim_configs[mini_sim_num_configs];
+    config->level = level;
+    config->size_in_bytes = size_in_bytes;
+    config->num_sets = num_sets;
+    config->lines_per_set = lines_per_set;
+    config->policy = policy;
+    config->sampling_rate = sampling_rate;
+    config->lru_clock = 0;
+    config->total_accesses = 0;
+
+  //Choose the sampled sets by hashing the set index.
+
+    config->slot_of_set = malloc(num_sets * sizeof(int32_t));
+    config->num_sampled_sets = 0;
+    for (uint32_t set = 0; set < num_sets; set++) {
+        if (mini_sim_hash(set) % sampling_rate == 0) {
+            config->slot_of_set[set] = config->num_sampled_sets++;
+        }
+        else {
+            config->slot_of_set[set] = MINI_SIM_NOT_SAMPLED;
+        }
+    }
+    if (config->num_sampled_sets == 0) {
+        printf("Error: mini-sim sampling rate %u leaves no sets of a %u-set cache\n", sampling_rate, num_sets);
+        exit(1);
+    }
+
+    uint32_t num_lines = config->num_sampled_sets * lines_per_set;
+    config->tags = calloc(num_lines, sizeof(uint32_t));
+    config->flags = calloc(num_lines, sizeof(uint8_t));
+    config->lru_stamps = calloc(num_lines, sizeof(uint32_t));
+    config->set_accesses = calloc(config->num_sampled_sets, sizeof(uint32_t));
+    config->set_misses = calloc(config->num_sampled_sets, sizeof(uint32_t));
+
+    return mini_sim_num_configs++;
+}
+
+
+//Chooses the line to evict from a full NRU set, using the same
+//order of preference as l2_insert_line():
+//   r=0 d=0, then r=0 d=1, then r=1 d=0, otherwise line 0.
+
+static uint32_t mini_sim_nru_victim(uint8_t *flags, uint32_t lines_per_set)
+{
+    uint32_t r0_d1_index = lines_per_set;
+    uint32_t r1_d0_index = lines_per_set;
+
+    for (uint32_t line = 0; line < lines_per_set; line++) {
+        if (!(flags[line] & MINI_SIM_RBIT_MASK)) {
+            if (!(flags[line] & MINI_SIM_DIRTYBIT_MASK))
+                return line;
+            if (r0_d1_index == lines_per_set)
+                r0_d1_index = line;
+        }
+        else if (!(flags[line] & MINI_SIM_DIRTYBIT_MASK)) {
+            if (r1_d0_index == lines_per_set)
+                r1_d0_index = line;
+        }
+    }
+    if (r0_d1_index != lines_per_set)
+        return r0_d1_index;
+    if (r1_d0_index != lines_per_set)
+        return r1_d0_index;
+    return 0;
+}
+
+
+/************************************************************
+
+            mini_sim_access()
+
+This procedure presents one access to every configuration
+of the specified level. See mini_sim.h.
+
+************************************************************/
+
+void mini_sim_access(uint32_t address, uint8_t control, uint8_t level, BOOL demand)
+{
+    uint32_t line_address = address >> MINI_SIM_LINE_SHIFT;
+    BOOL counted = (control & READ_ENABLE_MASK) && demand;
+
+    for (int c = 0; c < mini_sim_num_configs; c++) {
+        MINI_SIM_CONFIG *config = &mini_sim_configs[c];
+        if (config->level != level)
+            continue;
+
+        if (counted)
+            config->total_accesses++;
+
+      //Filter out the accesses to sets that are not sampled.
+
+        int32_t slot = config->slot_of_set[line_address & (config->num_sets - 1)];
+        if (slot == MINI_SIM_NOT_SAMPLED)
+            continue;
+
+        uint32_t first = slot * config->lines_per_set;
+        uint32_t *tags = &config->tags[first];
+        uint8_t *flags = &config->flags[first];
+        uint32_t *lru_stamps = &config->lru_stamps[first];
+
+        int line_index = -1;
+        for (uint32_t line = 0; line < config->lines_per_set; line++) {
+            if ((flags[line] & MINI_SIM_VBIT_MASK) && (tags[line] == line_address)) {
+                line_index = line;
+                break;
+            }
+        }
+
+        if (counted)
+            config->set_accesses[slot]++;
+
+      //On a miss, fill an invalid line if there is one, otherwise
+      //evict a line according to the replacement policy.
+
+        if (line_index == -1) {
+            if (counted)
+                config->set_misses[slot]++;
+
+            for (uint32_t line = 0; line < config->lines_per_set; line++) {
+                if (!(flags[line] & MINI_SIM_VBIT_MASK)) {
+                    line_index = line;
+                    break;
+                }
+            }
+            if (line_index == -1) {
+                if (config->policy == MINI_SIM_POLICY_NRU) {
+                    line_index = mini_sim_nru_victim(flags, config->lines_per_set);
+                }
+                else {
+                    line_index = 0;
+                    for (uint32_t line = 1; line < config->lines_per_set; line++) {
+                        if (lru_stamps[line] < lru_stamps[line_index])
+                            line_index = line;
+                    }
+                }
+            }
+            tags[line_index] = line_address;
+            flags[line_index] = MINI_SIM_VBIT_MASK;
+        }
+
+      //As in the L2 cache, the access that follows the fill
+      //marks the line as referenced (and dirty on a write).
+
+        flags[line_index] |= MINI_SIM_RBIT_MASK;
+        if (control & WRITE_ENABLE_MASK)
+            flags[line_index] |= MINI_SIM_DIRTYBIT_MASK;
+        lru_stamps[line_index] = ++config->lru_clock;
+    }
+}
+
+
+/************************************************
+
+       mini_sim_clear_r_bits()
+
+This procedure clears the r bits of the NRU configurations.
+
+***********************************************/
+
+void mini_sim_clear_r_bits()
+{
+    for (int c = 0; c < mini_sim_num_configs; c++) {
+        MINI_SIM_CONFIG *config = &mini_sim_configs[c];
+        if (config->policy != MINI_SIM_POLICY_NRU)
+            continue;
+        uint32_t num_lines = config->num_sampled_sets * config->lines_per_set;
+        for (uint32_t line = 0; line < num_lines; line++) {
+            config->flags[line] &= ~MINI_SIM_RBIT_MASK;
+        }
+    }
+}
+
+
+/************************************************************
+
+            mini_sim_get_miss_ratio()
+
+The miss ratio is estimated as the ratio of the total sampled
+misses to the total sampled accesses. Its standard error is
+that of a ratio estimator over the sampled sets:
+
+   SE^2 = sum_i (m_i - r * a_i)^2 / (n (n-1) abar^2)
+
+where m_i and a_i are the misses and accesses of sampled set i,
+r is the estimated miss ratio, n is the number of sampled sets
+and abar is the mean number of accesses per sampled set.
+
+************************************************************/
+
+double mini_sim_get_miss_ratio(int config_index, double *std_error)
+{
+    MINI_SIM_CONFIG *config = &mini_sim_configs[config_index];
+    uint32_t n = config->num_sampled_sets;
+
+    uint64_t accesses = 0;
+    uint64_t misses = 0;
+    for (uint32_t slot = 0; slot < n; slot++) {
+        accesses += config->set_accesses[slot];
+        misses += config->set_misses[slot];
+    }
+
+    if (accesses == 0) {
+        *std_error = 0.0;
+        return 0.0;
+    }
+
+    double ratio = (double) misses / accesses;
+
+    if (n < 2) {
+        *std_error = 0.0;
+        return ratio;
+    }
+
+    double sum_squares = 0.0;
+    for (uint32_t slot = 0; slot < n; slot++) {
+        double residual = config->set_misses[slot] - ratio * config->set_accesses[slot];
+        sum_squares += residual * residual;
+    }
+    double mean_accesses = (double) accesses / n;
+    *std_error = sqrt(sum_squares / ((double) n * (n - 1))) / mean_accesses;
+    return ratio;
+}
+
+
+/************************************************
+
+       mini_sim_report()
+
+This procedure prints the extrapolated miss ratio of
+each configuration.
+
+***********************************************/
+
+void mini_sim_report()
+{
+    printf("Mini-sim: %d configurations\n", mini_sim_num_configs);
+    for (int c = 0; c < mini_sim_num_configs; c++) {
+        MINI_SIM_CONFIG *config = &mini_sim_configs[c];
+        double std_error;
+        double ratio = mini_sim_get_miss_ratio(c, &std_error);
+
+        printf("  %s %8u KB, %2u-way, %s, 1/%u sampling (%u of %u sets): miss ratio = %.4f +/- %.4f, "
+               "estimated misses = %.0f\n",
+               (config->level == MINI_SIM_LEVEL_L3) ? "L3" : "L2",
+               config->size_in_bytes >> 10, config->lines_per_set,
+               (config->policy == MINI_SIM_POLICY_NRU) ? "NRU" : "LRU",
+               config->sampling_rate, config->num_sampled_sets, config->num_sets,
+               ratio, std_error, ratio * config->total_accesses);
+    }
+}
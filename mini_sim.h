@@ -0,0 +1,136 @@
+/************************************************************
+
+    Miniature cache simulation ("mini-sim") by set sampling.
+
+A mini-sim configuration is a tag-only model of an L2- or
+L3-sized cache in which only a hashed subset of the sets (about
+1 of every sampling_rate sets) is actually simulated. The miss
+ratio of the sampled sets is used as an estimate of the miss
+ratio of the full cache. Since whole sets are sampled, this works
+with any replacement policy.
+
+Many configurations can be registered, and are simulated in
+parallel in a single pass over the trace. A configuration of an L2
+cache is fed the stream of L2 accesses (the L1 misses and
+write-backs from L1), and one of an L3 cache is fed the stream
+between the L2 cache and main memory: the lines read from main
+memory (including those the dead-block predictor bypasses L2 with)
+and the lines written back to it (including by evict hints), see
+memory_main_memory_access(). An L3 configuration therefore models
+an L3 cache behind the simulated L2 cache.
+
+Only demand reads are counted in the miss ratios. The reads of
+prefetches, software or hardware, update the state of the
+configurations, as they would fill a real cache, but are left out
+of the statistics, as they are of num_l2_misses.
+
+************************************************************/
+
+//Replacement policies supported by a mini-sim configuration.
+//MINI_SIM_POLICY_NRU mirrors the L2 cache's NRU algorithm.
+#define MINI_SIM_POLICY_NRU 0
+#define MINI_SIM_POLICY_LRU 1
+
+//The level of the cache modeled by a mini-sim configuration, which
+//determines the reference stream it is fed.
+#define MINI_SIM_LEVEL_L2 0
+#define MINI_SIM_LEVEL_L3 1
+
+//Maximum number of configurations that can be simulated at once.
+#define MINI_SIM_MAX_CONFIGS 32
+
+//Set to TRUE by mini_sim_initialize(). memory_subsystem.c only
+//feeds the mini-sim when this is set.
+extern BOOL mini_sim_enabled;
+
+
+/************************************************
+            mini_sim_initialize()
+
+This procedure discards any configurations that have
+been added and enables the mini-sim.
+************************************************/
+
+void mini_sim_initialize();
+
+
+/************************************************************
+
+            mini_sim_add_config()
+
+This procedure adds a miniature cache configuration. The
+parameters are:
+
+size_in_bytes: the (data) size of the full cache being modeled.
+
+lines_per_set: the associativity of the cache. size_in_bytes must
+               be such that the number of sets is a power of 2.
+
+policy: MINI_SIM_POLICY_NRU or MINI_SIM_POLICY_LRU.
+
+sampling_rate: about 1 of every sampling_rate sets is simulated.
+               A sampling rate of 1 simulates the full cache.
+
+level: MINI_SIM_LEVEL_L2 or MINI_SIM_LEVEL_L3.
+
+It returns the index of the new configuration.
+
+************************************************************/
+
+int mini_sim_add_config(uint32_t size_in_bytes, uint32_t lines_per_set,
+			uint8_t policy, uint32_t sampling_rate, uint8_t level);
+
+
+/************************************************************
+
+            mini_sim_access()
+
+This procedure presents one access to every configuration of the
+specified level: an L2 access for MINI_SIM_LEVEL_L2, or a line read
+from or written to main memory for MINI_SIM_LEVEL_L3. control has
+the same meaning as for l2_cache_access(). As with num_l2_misses,
+only demand reads (reads with demand set to TRUE) are counted in
+the statistics; writes (write-backs from the level above) and the
+reads of prefetches only update the cache state.
+
+************************************************************/
+
+void mini_sim_access(uint32_t address, uint8_t control, uint8_t level, BOOL demand);
+
+
+/************************************************
+
+       mini_sim_clear_r_bits()
+
+This procedure clears the r bits of the NRU configurations.
+It is called along with l2_clear_r_bits().
+
+***********************************************/
+
+void mini_sim_clear_r_bits();
+
+
+/************************************************************
+
+            mini_sim_get_miss_ratio()
+
+This procedure returns, for the specified configuration, the
+extrapolated miss ratio and (in std_error) the standard error
+of that estimate, computed from the per-set variation of the
+misses among the sampled sets.
+
+************************************************************/
+
+double mini_sim_get_miss_ratio(int config, double *std_error);
+
+
+/************************************************
+
+       mini_sim_report()
+
+This procedure prints the extrapolated miss ratio of
+each configuration.
+
+***********************************************/
+
+void mini_sim_report();
@@ -0,0 +1,256 @@
+/************************************************************
+
+   This file contains the page-mapping emulation.
+
+   The page table is a flat array with one entry per virtual page
+   of the 32-bit address space (1M entries for 4KB pages, 2K
+   entries for 2MB pages). An entry holds the physical frame number
+   plus 1, so that 0 means the page has not been touched yet.
+
+   Free frames are handed out as follows:
+     - sequential: in increasing frame number order.
+     - random: in the order of a shuffled list of all frames.
+     - page coloring and bin hopping: the frames of color c are
+       c, c + num_colors, c + 2*num_colors, ..., and they are
+       handed out in that order. If a color has no free frames
+       left, the next color with free frames is used instead.
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "page_map.h"
+
+#define PAGE_MAP_NOT_MAPPED 0
+#define PAGE_MAP_INVALID_VPN (~0u)
+
+BOOL page_map_enabled = FALSE;
+
+uint32_t page_map_page_shift;
+uint8_t page_map_policy;
+uint32_t page_map_num_frames;
+uint32_t page_map_num_colors;
+
+uint32_t *page_map_page_table;
+
+//sequential and random allocation: the next frame (or index
+//into the shuffled frame list) to hand out.
+uint32_t page_map_next_frame;
+uint32_t *page_map_shuffled_frames;
+
+//page coloring and bin hopping: the number of frames of each
+//color handed out so far, and the color of the last fault.
+uint32_t *page_map_color_next;
+uint32_t page_map_last_color;
+
+PAGE_MAP_TLB_ENTRY page_map_tlb[PAGE_MAP_TLB_ENTRIES];
+
+//statistics
+uint64_t page_map_tlb_hits;
+uint64_t page_map_tlb_misses;
+uint32_t page_map_num_mapped_pages;
+uint32_t page_map_color_fallbacks;
+
+
+//A small xorshift generator, so that the random frame order
+//doesn't depend on (or disturb) the C library's rand().
+
+static uint32_t page_map_random_state;
+
+static uint32_t page_map_random()
+{
+    page_map_random_state ^= page_map_random_state << 13;
+    page_map_random_state ^= page_map_random_state >> 17;
+    page_map_random_state ^= page_map_random_state << 5;
+    return page_map_random_state;
+}
+
+
+/************************************************************
+
+            page_map_initialize()
+
+This procedure sets up an empty page map over main memory.
+
+************************************************************/
+
+void page_map_initialize(uint32_t memory_size_in_bytes, uint32_t page_shift,
+			 uint8_t policy, uint32_t num_colors, uint32_t seed)
+{
+    uint32_t num_frames = memory_size_in_bytes >> page_shift;
+
+    if ((page_shift != PAGE_MAP_4K_PAGE_SHIFT) && (page_shift != PAGE_MAP_2M_PAGE_SHIFT)) {
+        printf("Error: page map supports only 4KB and 2MB pages\n");
+        exit(1);
+    }
+    if (num_frames == 0) {
+        printf("Error: main memory is smaller than a single page\n");
+        exit(1);
+    }
+    if ((num_colors == 0) || (num_colors > num_frames)) {
+        printf("Error: the number of page colors must be between 1 and the number of frames (%u)\n", num_frames);
+        exit(1);
+    }
+
+    page_map_page_shift = page_shift;
+    page_map_policy = policy;
+    page_map_num_frames = num_frames;
+    page_map_num_colors = num_colors;
+
+    free(page_map_page_table);
+    page_map_page_table = calloc((size_t) 1 << (32 - page_shift), sizeof(uint32_t));
+
+    page_map_next_frame = 0;
+
+  //For random allocation, shuffle the list of all frames
+  //(Fisher-Yates).
+
+    free(page_map_shuffled_frames);
+    page_map_shuffled_frames = NULL;
+    if (policy == PAGE_MAP_RANDOM) {
+        page_map_random_state = seed ? seed : 1;
+        page_map_shuffled_frames = malloc(num_frames * sizeof(uint32_t));
+        for (uint32_t frame = 0; frame < num_frames; frame++)
+            page_map_shuffled_frames[frame] = frame;
+        for (uint32_t i = num_frames - 1; i > 0; i--) {
+            uint32_t j = page_map_random() % (i + 1);
+            uint32_t temp = page_map_shuffled_frames[i];
+            page_map_shuffled_frames[i] = page_map_shuffled_frames[j];
+            page_map_shuffled_frames[j] = temp;
+        }
+    }
+
+    free(page_map_color_next);
+    page_map_color_next = calloc(num_colors, sizeof(uint32_t));
+    page_map_last_color = num_colors - 1;
+
+    for (int i = 0; i < PAGE_MAP_TLB_ENTRIES; i++)
+        page_map_tlb[i].vpn = PAGE_MAP_INVALID_VPN;
+
+    page_map_tlb_hits = 0;
+    page_map_tlb_misses = 0;
+    page_map_num_mapped_pages = 0;
+    page_map_color_fallbacks = 0;
+    page_map_enabled = TRUE;
+}
+
+
+//Returns a free frame of the specified color or, if there is
+//none, of the next color that has a free frame.
+
+static uint32_t page_map_allocate_colored_frame(uint32_t color)
+{
+    for (uint32_t tried = 0; tried < page_map_num_colors; tried++) {
+        uint32_t frame = color + page_map_color_next[color] * page_map_num_colors;
+        if (frame < page_map_num_frames) {
+            page_map_color_next[color]++;
+            if (tried)
+                page_map_color_fallbacks++;
+            return frame;
+        }
+        color = (color + 1) % page_map_num_colors;
+    }
+    printf("Error: page map has run out of physical frames\n");
+    exit(1);
+}
+
+
+//Allocates a frame for a virtual page on its first touch.
+
+static uint32_t page_map_allocate_frame(uint32_t vpn)
+{
+    if (page_map_num_mapped_pages == page_map_num_frames) {
+        printf("Error: page map has run out of physical frames\n");
+        exit(1);
+    }
+
+    switch (page_map_policy) {
+    case PAGE_MAP_SEQUENTIAL:
+        return page_map_next_frame++;
+    case PAGE_MAP_RANDOM:
+        return page_map_shuffled_frames[page_map_next_frame++];
+    case PAGE_MAP_PAGE_COLORING:
+        return page_map_allocate_colored_frame(vpn % page_map_num_colors);
+    case PAGE_MAP_BIN_HOPPING:
+        page_map_last_color = (page_map_last_color + 1) % page_map_num_colors;
+        return page_map_allocate_colored_frame(page_map_last_color);
+    default:
+        printf("Error: unknown page map policy %u\n", page_map_policy);
+        exit(1);
+    }
+}
+
+
+/************************************************************
+
+            page_map_translate_slow()
+
+This procedure translates a virtual address that missed in the
+translation cache and fills the translation cache.
+
+************************************************************/
+
+uint32_t page_map_translate_slow(uint32_t virtual_address)
+{
+    uint32_t vpn = virtual_address >> page_map_page_shift;
+
+    page_map_tlb_misses++;
+
+    if (page_map_page_table[vpn] == PAGE_MAP_NOT_MAPPED) {
+        page_map_page_table[vpn] = page_map_allocate_frame(vpn) + 1;
+        page_map_num_mapped_pages++;
+    }
+
+    uint32_t pfn = page_map_page_table[vpn] - 1;
+    PAGE_MAP_TLB_ENTRY *entry = &page_map_tlb[vpn & (PAGE_MAP_TLB_ENTRIES - 1)];
+    entry->vpn = vpn;
+    entry->pfn = pfn;
+
+    return (pfn << page_map_page_shift) | (virtual_address & ((1u << page_map_page_shift) - 1));
+}
+
+
+/************************************************************
+
+            page_map_report()
+
+This procedure prints the page map statistics.
+
+************************************************************/
+
+void page_map_report()
+{
+    static const char *policy_names[] = {"sequential", "random", "page coloring", "bin hopping"};
+
+    uint64_t translations = page_map_tlb_hits + page_map_tlb_misses;
+    printf("Page map: %s allocation of %uKB pages, %u of %u frames mapped, %u colors\n",
+           policy_names[page_map_policy], (1u << page_map_page_shift) >> 10,
+           page_map_num_mapped_pages, page_map_num_frames, page_map_num_colors);
+    printf("  translation cache hit rate = %.4f (%llu translations)\n",
+           translations ? (double) page_map_tlb_hits / translations : 0.0,
+           (unsigned long long) translations);
+
+  //Count the mapped pages of each (physical) color, to show how
+  //evenly they are spread over the cache.
+
+    uint32_t *pages_per_color = calloc(page_map_num_colors, sizeof(uint32_t));
+    for (uint32_t vpn = 0; vpn < (1u << (32 - page_map_page_shift)); vpn++) {
+        if (page_map_page_table[vpn] != PAGE_MAP_NOT_MAPPED)
+            pages_per_color[(page_map_page_table[vpn] - 1) % page_map_num_colors]++;
+    }
+    uint32_t min_pages = pages_per_color[0];
+    uint32_t max_pages = pages_per_color[0];
+    for (uint32_t color = 1; color < page_map_num_colors; color++) {
+        if (pages_per_color[color] < min_pages)
+            min_pages = pages_per_color[color];
+        if (pages_per_color[color] > max_pages)
+            max_pages = pages_per_color[color];
+    }
+    free(pages_per_color);
+
+    printf("  pages per color: min %u, max %u; color fallbacks = %u\n",
+           min_pages, max_pages, page_map_color_fallbacks);
+}
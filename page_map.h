@@ -0,0 +1,135 @@
+#ifndef PAGE_MAP_H
+#define PAGE_MAP_H
+
+/************************************************************
+
+    Page-mapping emulation.
+
+Traces record virtual addresses. The page map translates them to
+physical addresses in the configured main memory, allocating a
+physical frame the first time each virtual page is touched, the way
+an operating system would. The frame allocation policy determines
+how pages are spread over the L2 sets:
+
+  PAGE_MAP_SEQUENTIAL:    frames are allocated in order.
+  PAGE_MAP_RANDOM:        frames are allocated in a random order.
+  PAGE_MAP_PAGE_COLORING: a page gets a frame of the same color
+                          as the virtual page, where the color of
+                          a page is its page number modulo the
+                          number of colors.
+  PAGE_MAP_BIN_HOPPING:   successive page faults get frames of
+                          successive colors.
+
+For a physically indexed cache, the number of colors is the size
+of one way of the cache divided by the page size.
+
+************************************************************/
+
+#define PAGE_MAP_SEQUENTIAL 0
+#define PAGE_MAP_RANDOM 1
+#define PAGE_MAP_PAGE_COLORING 2
+#define PAGE_MAP_BIN_HOPPING 3
+
+//Page sizes are given by their shift: 4KB and 2MB pages.
+#define PAGE_MAP_4K_PAGE_SHIFT 12
+#define PAGE_MAP_2M_PAGE_SHIFT 21
+
+//Number of entries in the (direct-mapped) translation cache.
+#define PAGE_MAP_TLB_ENTRIES 64
+
+//Set to TRUE by page_map_initialize().
+extern BOOL page_map_enabled;
+
+
+/************************************************************
+
+            page_map_initialize()
+
+This procedure sets up an empty page map over main memory.
+The parameters are:
+
+memory_size_in_bytes: the size of main memory. All of it is
+              available for page frames.
+
+page_shift: PAGE_MAP_4K_PAGE_SHIFT or PAGE_MAP_2M_PAGE_SHIFT.
+
+policy: one of the frame allocation policies above.
+
+num_colors: the number of page colors (used by page coloring
+            and bin hopping), at least 1.
+
+seed: the seed of the random frame order (PAGE_MAP_RANDOM), so
+      that results are reproducible.
+
+************************************************************/
+
+void page_map_initialize(uint32_t memory_size_in_bytes, uint32_t page_shift,
+			 uint8_t policy, uint32_t num_colors, uint32_t seed);
+
+
+/************************************************************
+This struct defines an entry of the translation cache, which
+holds recent virtual to physical page number translations.
+vpn is ~0 if the entry is not valid.
+************************************************************/
+
+typedef struct {
+  uint32_t vpn;
+  uint32_t pfn;
+} PAGE_MAP_TLB_ENTRY;
+
+extern PAGE_MAP_TLB_ENTRY page_map_tlb[PAGE_MAP_TLB_ENTRIES];
+extern uint32_t page_map_page_shift;
+extern uint64_t page_map_tlb_hits;
+
+
+/************************************************************
+
+            page_map_translate_slow()
+
+This procedure translates a virtual address whose page is not
+in the translation cache, by looking it up in the page table
+(allocating a frame if the page has not been touched before),
+and fills the translation cache.
+
+************************************************************/
+
+uint32_t page_map_translate_slow(uint32_t virtual_address);
+
+
+/************************************************************
+
+            page_map_translate()
+
+This procedure returns the physical address for a virtual
+address. A translation cache hit is handled inline.
+
+************************************************************/
+
+static inline uint32_t page_map_translate(uint32_t virtual_address)
+{
+    uint32_t vpn = virtual_address >> page_map_page_shift;
+    PAGE_MAP_TLB_ENTRY *entry = &page_map_tlb[vpn & (PAGE_MAP_TLB_ENTRIES - 1)];
+
+    if (entry->vpn == vpn) {
+        page_map_tlb_hits++;
+        return (entry->pfn << page_map_page_shift) |
+               (virtual_address & ((1u << page_map_page_shift) - 1));
+    }
+    return page_map_translate_slow(virtual_address);
+}
+
+
+/************************************************************
+
+            page_map_report()
+
+This procedure prints the number of mapped pages, the
+translation cache hit rate and how evenly the pages are
+spread over the colors.
+
+************************************************************/
+
+void page_map_report();
+
+#endif
@@ -0,0 +1,551 @@
+/************************************************************
+
+   This file contains the prefetch queue, the prefetch accounting
+   and the feedback-directed throttling of the attached prefetchers.
+
+   Aggressiveness levels (distance and degree):
+
+       level:     1    2    3    4    5
+       distance:  4    8   16   32   64
+       degree:    1    1    2    4    4
+
+   At the end of each interval, the interval's accuracy (useful /
+   issued prefetches), lateness (late / useful prefetches) and
+   pollution (demand misses on lines evicted by prefetches / demand
+   misses) are each averaged with the previous value, and the level
+   is adjusted as follows:
+
+       accuracy   late   polluting   level
+       high       yes       -        up
+       high       no        -        unchanged
+       medium     yes      no        up
+       medium      -       yes       down
+       medium     no       no        unchanged
+       low         -        -        down
+
+   where accuracy is high above PREFETCH_ACCURACY_HIGH and low below
+   PREFETCH_ACCURACY_LOW, and the lateness and pollution thresholds
+   are PREFETCH_LATENESS_THRESHOLD and PREFETCH_POLLUTION_THRESHOLD.
+
+   Pollution is detected with a pollution filter, a Bloom filter
+   with two hashes of the line address and as many bits as there
+   are lines in the L2 cache: a demand line evicted by a prefetch
+   is inserted, and a demand miss on a line the filter contains is
+   counted as caused by a prefetch. A line cannot be taken out of
+   a Bloom filter, so the filter is cleared at every interval.
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "l2_cache.h"
+#include "prefetch.h"
+
+//From memory_subsystem.c. Prefetches are filled the same way as
+//demand misses.
+void memory_handle_l2_miss(uint32_t address, uint8_t control);
+
+#define PREFETCH_ACCURACY_HIGH 0.75
+#define PREFETCH_ACCURACY_LOW 0.40
+#define PREFETCH_LATENESS_THRESHOLD 0.01
+#define PREFETCH_POLLUTION_THRESHOLD 0.005
+
+#define PREFETCH_POLLUTION_FILTER_BITS (L2_NUM_CACHE_SETS * L2_LINES_PER_SET)
+
+#define PREFETCH_LINE_MASK (~0x3f)
+
+static const uint32_t prefetch_level_distance[PREFETCH_NUM_LEVELS + 1] = {0, 4, 8, 16, 32, 64};
+static const uint32_t prefetch_level_degree[PREFETCH_NUM_LEVELS + 1] = {0, 1, 1, 2, 4, 4};
+
+BOOL prefetch_enabled = FALSE;
+
+uint32_t prefetch_memory_size_in_bytes;
+
+//The attached prefetchers, indexed by prefetch source (0 is unused).
+const PREFETCHER *prefetchers[PREFETCH_MAX_PREFETCHERS + 1];
+uint8_t prefetch_num_prefetchers;
+
+/***************************************************
+This struct defines an entry of the prefetch queue.
+  fill_time: value of prefetch_clock at which the
+             prefetch is filled into the L2 cache.
+****************************************************/
+
+typedef struct {
+  BOOL valid;
+  uint32_t address;
+  uint8_t source;
+  uint64_t fill_time;
+} PREFETCH_QUEUE_ENTRY;
+
+PREFETCH_QUEUE_ENTRY prefetch_queue[PREFETCH_QUEUE_ENTRIES];
+uint64_t prefetch_clock;
+
+//TRUE while a prefetch is being filled, so that the lines it
+//evicts go into the pollution filter (and so that the mini-sim
+//doesn't count its read as a demand read, see memory_subsystem.c).
+BOOL prefetch_filling = FALSE;
+
+//Statistics, per prefetch source.
+uint64_t prefetch_issued[PREFETCH_MAX_PREFETCHERS + 1];
+uint64_t prefetch_useful[PREFETCH_MAX_PREFETCHERS + 1];
+uint64_t prefetch_late[PREFETCH_MAX_PREFETCHERS + 1];
+uint64_t prefetch_useless[PREFETCH_MAX_PREFETCHERS + 1];
+uint64_t prefetch_dropped[PREFETCH_MAX_PREFETCHERS + 1];
+
+uint64_t prefetch_demand_misses;
+uint64_t prefetch_pollution_misses;
+
+//Throttling state.
+BOOL prefetch_throttling_enabled;
+uint8_t prefetch_level;
+uint32_t prefetch_interval_accesses;
+uint32_t prefetch_interval_issued;
+uint32_t prefetch_interval_useful;
+uint32_t prefetch_interval_late;
+uint32_t prefetch_interval_misses;
+uint32_t prefetch_interval_pollution;
+double prefetch_accuracy;
+double prefetch_lateness;
+double prefetch_pollution;
+
+uint64_t prefetch_pollution_filter[PREFETCH_POLLUTION_FILTER_BITS / 64];
+
+//The level chosen for each interval so far.
+uint8_t *prefetch_level_history;
+uint32_t prefetch_num_intervals;
+uint32_t prefetch_level_history_size;
+
+
+/************************************************
+
+       prefetch_initialize()
+
+This procedure detaches all prefetchers, empties the prefetch
+queue, clears the statistics and enables prefetching.
+
+***********************************************/
+
+void prefetch_initialize(uint32_t memory_size_in_bytes)
+{
+    prefetch_memory_size_in_bytes = memory_size_in_bytes;
+    prefetch_num_prefetchers = 0;
+
+    for (int i = 0; i < PREFETCH_QUEUE_ENTRIES; i++)
+        prefetch_queue[i].valid = FALSE;
+    prefetch_clock = 0;
+
+    for (int source = 0; source <= PREFETCH_MAX_PREFETCHERS; source++) {
+        prefetchers[source] = NULL;
+        prefetch_issued[source] = 0;
+        prefetch_useful[source] = 0;
+        prefetch_late[source] = 0;
+        prefetch_useless[source] = 0;
+        prefetch_dropped[source] = 0;
+    }
+    prefetch_demand_misses = 0;
+    prefetch_pollution_misses = 0;
+
+    prefetch_throttling_enabled = TRUE;
+    prefetch_level = PREFETCH_INITIAL_LEVEL;
+    prefetch_interval_accesses = 0;
+    prefetch_interval_issued = 0;
+    prefetch_interval_useful = 0;
+    prefetch_interval_late = 0;
+    prefetch_interval_misses = 0;
+    prefetch_interval_pollution = 0;
+    prefetch_accuracy = 0.0;
+    prefetch_lateness = 0.0;
+    prefetch_pollution = 0.0;
+    for (int i = 0; i < PREFETCH_POLLUTION_FILTER_BITS / 64; i++)
+        prefetch_pollution_filter[i] = 0;
+    prefetch_num_intervals = 0;
+
+    prefetch_enabled = TRUE;
+}
+
+
+/************************************************
+
+       prefetch_clear()
+
+This procedure empties the prefetch queue and the pollution
+filter, and re-initializes the attached prefetchers.
+
+***********************************************/
+
+void prefetch_clear()
+{
+    for (int i = 0; i < PREFETCH_QUEUE_ENTRIES; i++)
+        prefetch_queue[i].valid = FALSE;
+    for (int i = 0; i < PREFETCH_POLLUTION_FILTER_BITS / 64; i++)
+        prefetch_pollution_filter[i] = 0;
+    for (int s = 1; s <= prefetch_num_prefetchers; s++) {
+        if (prefetchers[s]->initialize)
+            prefetchers[s]->initialize(s);
+    }
+}
+
+
+/************************************************
+
+       prefetch_attach()
+
+This procedure attaches a prefetcher and returns its prefetch
+source number.
+
+***********************************************/
+
+uint8_t prefetch_attach(const PREFETCHER *prefetcher)
+{
+    if (prefetch_num_prefetchers == PREFETCH_MAX_PREFETCHERS) {
+        printf("Error: at most %d prefetchers can be attached\n", PREFETCH_MAX_PREFETCHERS);
+        exit(1);
+    }
+    uint8_t source = ++prefetch_num_prefetchers;
+    prefetchers[source] = prefetcher;
+    if (prefetcher->initialize)
+        prefetcher->initialize(source);
+    return source;
+}
+
+
+/************************************************
+
+       prefetch_set_throttling()
+
+This procedure sets the aggressiveness level and whether
+it is adjusted at the end of each interval.
+
+***********************************************/
+
+void prefetch_set_throttling(BOOL enabled, uint8_t level)
+{
+    if ((level < 1) || (level > PREFETCH_NUM_LEVELS)) {
+        printf("Error: prefetch aggressiveness level must be between 1 and %d\n", PREFETCH_NUM_LEVELS);
+        exit(1);
+    }
+    prefetch_throttling_enabled = enabled;
+    prefetch_level = level;
+}
+
+
+uint32_t prefetch_degree()
+{
+    return prefetch_level_degree[prefetch_level];
+}
+
+
+uint32_t prefetch_distance()
+{
+    return prefetch_level_distance[prefetch_level];
+}
+
+
+//The two hash functions of the pollution filter, both on the line
+//address.
+
+static uint32_t prefetch_pollution_hash(uint32_t address, int which)
+{
+    uint32_t line = address >> 6;
+    uint32_t hash = line * (which ? 0x9e3779b1 : 0x85ebca6b);
+    return (hash ^ (hash >> 15)) % PREFETCH_POLLUTION_FILTER_BITS;
+}
+
+
+static void prefetch_pollution_insert(uint32_t address)
+{
+    for (int which = 0; which < 2; which++) {
+        uint32_t bit = prefetch_pollution_hash(address, which);
+        prefetch_pollution_filter[bit / 64] |= (uint64_t) 1 << (bit % 64);
+    }
+}
+
+
+static BOOL prefetch_pollution_contains(uint32_t address)
+{
+    for (int which = 0; which < 2; which++) {
+        uint32_t bit = prefetch_pollution_hash(address, which);
+        if (!(prefetch_pollution_filter[bit / 64] & ((uint64_t) 1 << (bit % 64))))
+            return FALSE;
+    }
+    return TRUE;
+}
+
+
+static PREFETCH_QUEUE_ENTRY *prefetch_queue_lookup(uint32_t address)
+{
+    for (int i = 0; i < PREFETCH_QUEUE_ENTRIES; i++) {
+        if (prefetch_queue[i].valid && (prefetch_queue[i].address == address))
+            return &prefetch_queue[i];
+    }
+    return NULL;
+}
+
+
+/************************************************
+
+       prefetch_issue()
+
+This procedure puts a prefetch of the cache line containing
+address into the prefetch queue, unless it has to be dropped.
+
+***********************************************/
+
+void prefetch_issue(uint32_t address, uint8_t source)
+{
+    address &= PREFETCH_LINE_MASK;
+
+    if (address >= prefetch_memory_size_in_bytes)
+        return;
+    if (l2_probe(address) || prefetch_queue_lookup(address))
+        return;
+
+    for (int i = 0; i < PREFETCH_QUEUE_ENTRIES; i++) {
+        if (!prefetch_queue[i].valid) {
+            prefetch_queue[i].valid = TRUE;
+            prefetch_queue[i].address = address;
+            prefetch_queue[i].source = source;
+            prefetch_queue[i].fill_time = prefetch_clock + PREFETCH_FILL_DELAY;
+            prefetch_issued[source]++;
+            prefetch_interval_issued++;
+            return;
+        }
+    }
+    prefetch_dropped[source]++;
+}
+
+
+//Fills a prefetch from main memory into the L2 cache.
+
+static void prefetch_fill(PREFETCH_QUEUE_ENTRY *entry)
+{
+    entry->valid = FALSE;
+
+  //The line may have been brought in by a demand miss (e.g. a write-back
+  //from L1) while the prefetch was in the queue.
+
+    if (l2_probe(entry->address))
+        return;
+
+    prefetch_filling = TRUE;
+    memory_handle_l2_miss(entry->address, READ_ENABLE_MASK);
+    prefetch_filling = FALSE;
+    l2_set_prefetch_source(entry->address, entry->source);
+}
+
+
+/************************************************
+
+       prefetch_advance()
+
+This procedure advances the prefetch clock and fills the
+prefetches that are due.
+
+***********************************************/
+
+void prefetch_advance()
+{
+    prefetch_clock++;
+    for (int i = 0; i < PREFETCH_QUEUE_ENTRIES; i++) {
+        if (prefetch_queue[i].valid && (prefetch_queue[i].fill_time <= prefetch_clock))
+            prefetch_fill(&prefetch_queue[i]);
+    }
+}
+
+
+/************************************************
+
+       prefetch_wait_for_fill()
+
+This procedure fills a prefetch of the specified line right
+away, if it is in the prefetch queue.
+
+***********************************************/
+
+BOOL prefetch_wait_for_fill(uint32_t address, BOOL demand)
+{
+    PREFETCH_QUEUE_ENTRY *entry = prefetch_queue_lookup(address & PREFETCH_LINE_MASK);
+    if (entry == NULL)
+        return FALSE;
+    if (demand) {
+        prefetch_late[entry->source]++;
+        prefetch_interval_late++;
+    }
+    prefetch_fill(entry);
+    return TRUE;
+}
+
+
+//Averages the value measured in the last interval with the
+//previous value (there is none after the first interval).
+
+static double prefetch_smooth(double previous, uint32_t count, uint32_t total)
+{
+    if (total == 0)
+        return previous;
+    if (prefetch_num_intervals == 0)
+        return (double) count / total;
+    return 0.5 * previous + 0.5 * ((double) count / total);
+}
+
+
+//Adjusts the aggressiveness level at the end of an interval.
+
+static void prefetch_end_interval()
+{
+    prefetch_accuracy = prefetch_smooth(prefetch_accuracy, prefetch_interval_useful, prefetch_interval_issued);
+    prefetch_lateness = prefetch_smooth(prefetch_lateness, prefetch_interval_late, prefetch_interval_useful);
+    prefetch_pollution = prefetch_smooth(prefetch_pollution, prefetch_interval_pollution, prefetch_interval_misses);
+
+    BOOL late = prefetch_lateness > PREFETCH_LATENESS_THRESHOLD;
+    BOOL polluting = prefetch_pollution > PREFETCH_POLLUTION_THRESHOLD;
+    int change = 0;
+
+    if (prefetch_accuracy >= PREFETCH_ACCURACY_HIGH) {
+        if (late)
+            change = 1;
+    }
+    else if (prefetch_accuracy >= PREFETCH_ACCURACY_LOW) {
+        if (polluting)
+            change = -1;
+        else if (late)
+            change = 1;
+    }
+    else {
+        change = -1;
+    }
+
+    if (prefetch_throttling_enabled) {
+        if ((change > 0) && (prefetch_level < PREFETCH_NUM_LEVELS))
+            prefetch_level++;
+        if ((change < 0) && (prefetch_level > 1))
+            prefetch_level--;
+    }
+
+  //Record the level chosen for the next interval.
+
+    if (prefetch_num_intervals == prefetch_level_history_size) {
+        prefetch_level_history_size = prefetch_level_history_size ? 2 * prefetch_level_history_size : 256;
+        prefetch_level_history = realloc(prefetch_level_history, prefetch_level_history_size);
+    }
+    prefetch_level_history[prefetch_num_intervals++] = prefetch_level;
+
+    prefetch_interval_accesses = 0;
+    prefetch_interval_issued = 0;
+    prefetch_interval_useful = 0;
+    prefetch_interval_late = 0;
+    prefetch_interval_misses = 0;
+    prefetch_interval_pollution = 0;
+    for (int i = 0; i < PREFETCH_POLLUTION_FILTER_BITS / 64; i++)
+        prefetch_pollution_filter[i] = 0;
+}
+
+
+/************************************************
+
+       prefetch_demand_access()
+
+This procedure accounts for a demand read of the L2 cache and
+passes it on to the attached prefetchers.
+
+***********************************************/
+
+void prefetch_demand_access(uint32_t address, uint8_t outcome, uint8_t source,
+			    const MEMORY_REQUEST_INFO *info)
+{
+    if (source == PREFETCH_SOURCE_SOFTWARE) {
+        outcome = PREFETCH_OUTCOME_HIT;
+    }
+    if ((outcome == PREFETCH_OUTCOME_PREFETCH_HIT) || (outcome == PREFETCH_OUTCOME_LATE)) {
+        prefetch_useful[source]++;
+        prefetch_interval_useful++;
+    }
+    else if (outcome == PREFETCH_OUTCOME_MISS) {
+        prefetch_demand_misses++;
+        prefetch_interval_misses++;
+        if (prefetch_pollution_contains(address)) {
+            prefetch_pollution_misses++;
+            prefetch_interval_pollution++;
+        }
+    }
+
+    for (int s = 1; s <= prefetch_num_prefetchers; s++)
+        prefetchers[s]->train(address, outcome, info);
+
+    if (++prefetch_interval_accesses == PREFETCH_INTERVAL)
+        prefetch_end_interval();
+}
+
+
+/************************************************
+
+       prefetch_line_evicted()
+
+This procedure accounts for a line evicted from the L2 cache
+and passes it on to the attached prefetchers.
+
+***********************************************/
+
+void prefetch_line_evicted(uint32_t address, uint8_t status)
+{
+    uint8_t source = (status & L2_PREFETCH_SOURCE_STATUS_MASK) >> L2_PREFETCH_SOURCE_STATUS_SHIFT;
+    if (source && (source != PREFETCH_SOURCE_SOFTWARE))
+        prefetch_useless[source]++;
+
+  //A demand line evicted by a prefetch goes into the pollution filter.
+
+    if (prefetch_filling && !source)
+        prefetch_pollution_insert(address);
+
+    for (int s = 1; s <= prefetch_num_prefetchers; s++) {
+        if (prefetchers[s]->evicted)
+            prefetchers[s]->evicted(address);
+    }
+}
+
+
+/************************************************
+
+       prefetch_report()
+
+This procedure prints the prefetch statistics.
+
+***********************************************/
+
+void prefetch_report()
+{
+    printf("Prefetching: %llu demand L2 misses, %llu (%.2f%%) caused by prefetch pollution\n",
+           (unsigned long long) prefetch_demand_misses, (unsigned long long) prefetch_pollution_misses,
+           prefetch_demand_misses ? 100.0 * prefetch_pollution_misses / prefetch_demand_misses : 0.0);
+
+    for (int s = 1; s <= prefetch_num_prefetchers; s++) {
+        uint64_t covered = prefetch_useful[s] + prefetch_demand_misses;
+        printf("  %s: %llu issued, %llu useful (%llu late), %llu useless, %llu dropped; "
+               "accuracy = %.4f, coverage = %.4f\n",
+               prefetchers[s]->name,
+               (unsigned long long) prefetch_issued[s], (unsigned long long) prefetch_useful[s],
+               (unsigned long long) prefetch_late[s], (unsigned long long) prefetch_useless[s],
+               (unsigned long long) prefetch_dropped[s],
+               prefetch_issued[s] ? (double) prefetch_useful[s] / prefetch_issued[s] : 0.0,
+               covered ? (double) prefetch_useful[s] / covered : 0.0);
+        if (prefetchers[s]->report)
+            prefetchers[s]->report();
+    }
+
+  //Print the level over time as runs of intervals at the same level.
+
+    printf("  Aggressiveness level over %u intervals of %d L2 accesses (%s):",
+           prefetch_num_intervals, PREFETCH_INTERVAL, prefetch_throttling_enabled ? "throttled" : "fixed");
+    uint32_t run_start = 0;
+    for (uint32_t i = 1; i <= prefetch_num_intervals; i++) {
+        if ((i == prefetch_num_intervals) || (prefetch_level_history[i] != prefetch_level_history[run_start])) {
+            printf(" %u x%u", prefetch_level_history[run_start], i - run_start);
+            run_start = i;
+        }
+    }
+    printf("\n");
+}
@@ -0,0 +1,214 @@
+#ifndef PREFETCH_H
+#define PREFETCH_H
+
+#include "memory_request.h"
+
+/************************************************************
+
+    Prefetching into the L2 cache, with feedback-directed
+    throttling.
+
+Prefetchers are attached to the memory subsystem with
+prefetch_attach(). Each one is told about every demand read of
+the L2 cache (i.e. every L1 miss) and about every line evicted from
+the L2 cache, and issues prefetches with prefetch_issue(). The
+number of a prefetcher (1 to PREFETCH_MAX_PREFETCHERS) is its
+"prefetch source", which is kept with each prefetched line in the
+L2 cache until the line is used by a demand access or evicted, so
+that every prefetch is accounted to the prefetcher that issued it.
+
+A prefetch is not filled into the L2 cache immediately: it waits in
+a small prefetch queue for PREFETCH_FILL_DELAY demand L2 accesses,
+standing in for the memory latency. A demand miss on a line that is
+still in the queue is a late prefetch.
+
+Throttling: the run is divided into intervals of PREFETCH_INTERVAL
+demand L2 accesses. At the end of each interval, the prefetch
+accuracy, lateness and pollution (demand misses on lines evicted by
+prefetches, detected with a pollution filter) are used to move the
+aggressiveness level up or down. The level determines the prefetch
+degree (how many prefetches may be issued per demand access) and
+distance (how far ahead of the demand stream they may go), which
+all attached prefetchers use.
+
+************************************************************/
+
+#define PREFETCH_MAX_PREFETCHERS 6
+
+//Prefetch source 7 is reserved for software prefetches, which
+//are accounted separately (see memory_subsystem.h).
+#define PREFETCH_SOURCE_SOFTWARE 7
+
+//Outcome of a demand read of the L2 cache, as seen by prefetchers.
+#define PREFETCH_OUTCOME_HIT 0            //hit on a demand line
+#define PREFETCH_OUTCOME_MISS 1           //miss
+#define PREFETCH_OUTCOME_PREFETCH_HIT 2   //first hit on a prefetched line
+#define PREFETCH_OUTCOME_LATE 3           //the line was still being prefetched
+
+//Aggressiveness levels 1 (very conservative) to 5 (very aggressive).
+#define PREFETCH_NUM_LEVELS 5
+#define PREFETCH_INITIAL_LEVEL 3
+
+//Prefetch queue: number of entries, and the number of demand L2
+//accesses it takes for a prefetch to be filled.
+#define PREFETCH_QUEUE_ENTRIES 32
+#define PREFETCH_FILL_DELAY 4
+
+//Number of demand L2 accesses per throttling interval.
+#define PREFETCH_INTERVAL 8192
+
+
+/***************************************************
+This struct describes a prefetcher. It has the
+following fields:
+  name: printed in the report.
+  initialize: called when the prefetcher is attached, with its
+              prefetch source number.
+  train: called after every demand read of the L2 cache, with
+         the address, its outcome (PREFETCH_OUTCOME_...) and the
+         metadata of the request (see memory_request.h), which
+         may be NULL.
+  evicted: called with the address of every line evicted from
+           the L2 cache. May be NULL.
+  report: called by prefetch_report() to print statistics
+          specific to the prefetcher. May be NULL.
+****************************************************/
+
+typedef struct {
+  const char *name;
+  void (*initialize)(uint8_t source);
+  void (*train)(uint32_t address, uint8_t outcome, const MEMORY_REQUEST_INFO *info);
+  void (*evicted)(uint32_t address);
+  void (*report)();
+} PREFETCHER;
+
+
+//Set to TRUE by prefetch_initialize().
+extern BOOL prefetch_enabled;
+
+//TRUE while a prefetch is being filled from main memory into L2.
+extern BOOL prefetch_filling;
+
+
+/************************************************
+
+       prefetch_initialize()
+
+This procedure detaches all prefetchers, empties the prefetch
+queue, clears the statistics and enables prefetching.
+Prefetches beyond memory_size_in_bytes are dropped.
+
+***********************************************/
+
+void prefetch_initialize(uint32_t memory_size_in_bytes);
+
+
+/************************************************
+
+       prefetch_clear()
+
+This procedure empties the prefetch queue and the pollution
+filter, and re-initializes the attached prefetchers, which forget
+what they have learned, keeping the prefetchers attached, the
+aggressiveness level and the statistics. It is called when the
+caches are emptied or replaced (see memory_subsystem_initialize()
+and checkpoint_restore()), so that prefetches meant for the old
+contents are not filled into the new ones.
+
+***********************************************/
+
+void prefetch_clear();
+
+
+/************************************************
+
+       prefetch_attach()
+
+This procedure attaches a prefetcher and returns its prefetch
+source number.
+
+***********************************************/
+
+uint8_t prefetch_attach(const PREFETCHER *prefetcher);
+
+
+/************************************************
+
+       prefetch_set_throttling()
+
+This procedure sets the aggressiveness level and whether
+it is adjusted at the end of each interval (if not, the
+level stays fixed).
+
+***********************************************/
+
+void prefetch_set_throttling(BOOL enabled, uint8_t level);
+
+
+/************************************************
+
+       prefetch_degree(), prefetch_distance()
+
+These procedures return the prefetch degree and distance
+(in cache lines) of the current aggressiveness level.
+
+***********************************************/
+
+uint32_t prefetch_degree();
+uint32_t prefetch_distance();
+
+
+/************************************************
+
+       prefetch_issue()
+
+This procedure is called by a prefetcher to prefetch the cache
+line containing the specified address into the L2 cache. The
+prefetch is dropped if the line is already in the L2 cache or the
+prefetch queue, if it is outside of main memory, or if the
+prefetch queue is full.
+
+***********************************************/
+
+void prefetch_issue(uint32_t address, uint8_t source);
+
+
+/************************************************************
+The following procedures are called by memory_handle_l1_miss()
+and memory_handle_l2_miss() (see memory_subsystem.c).
+************************************************************/
+
+//Called before every demand read of the L2 cache. Advances the
+//prefetch clock and fills the prefetches that are due.
+void prefetch_advance();
+
+//Called on an L2 miss. If the line is in the prefetch queue, it is
+//filled right away and TRUE is returned. It counts as a late
+//prefetch if the miss is a demand miss (demand is TRUE), rather
+//than a software prefetch.
+BOOL prefetch_wait_for_fill(uint32_t address, BOOL demand);
+
+//Called after every demand read of the L2 cache with its outcome,
+//the prefetch source of the line for a (late) prefetch hit, and
+//the metadata of the request (or NULL).
+void prefetch_demand_access(uint32_t address, uint8_t outcome, uint8_t source,
+			    const MEMORY_REQUEST_INFO *info);
+
+//Called when a line is evicted from the L2 cache, with the status
+//byte returned by l2_insert_line().
+void prefetch_line_evicted(uint32_t address, uint8_t status);
+
+
+/************************************************
+
+       prefetch_report()
+
+This procedure prints, for each prefetcher, the number of prefetches
+issued, useful, late and useless, its accuracy and coverage, as well
+as the pollution and the aggressiveness level over time.
+
+***********************************************/
+
+void prefetch_report();
+
+#endif
@@ -0,0 +1,177 @@
+/************************************************************
+
+   This file contains the self-profiling of the simulator
+   (see self_profile.h).
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "memory_subsystem_constants.h"
+#include "self_profile.h"
+
+BOOL self_profile_enabled = FALSE;
+uint32_t self_profile_sample_period;
+
+BOOL self_profile_sampling = FALSE;
+uint8_t self_profile_component;
+uint64_t self_profile_last;
+uint64_t self_profile_ticks[SELF_PROFILE_NUM_COMPONENTS];
+uint64_t self_profile_intervals[SELF_PROFILE_NUM_COMPONENTS];
+
+uint64_t self_profile_accesses;
+uint64_t self_profile_timed_accesses;
+uint32_t self_profile_countdown;
+
+//The host clock and the ticks when the profile was started, to
+//convert ticks to seconds.
+double self_profile_start_time;
+uint64_t self_profile_start_ticks;
+
+//The ticks it takes to read the clock, taken out of every interval
+//timed.
+uint64_t self_profile_overhead;
+
+//The number of accesses from the end of a timed access to the next
+//one, and the state of the generator that draws it. The access
+//right after a timed one ends the gap outside of the memory
+//subsystem, which is then pending.
+uint32_t self_profile_gap;
+uint32_t self_profile_random = 0x2545f491;
+BOOL self_profile_outside_pending;
+
+const char *self_profile_component_names[SELF_PROFILE_NUM_COMPONENTS] = {
+    "L1 path",
+    "memory_handle_l1_miss()",
+    "memory_handle_l2_miss()",
+    "main memory",
+    "outside (trace I/O, driver)"
+};
+
+
+static double self_profile_host_time()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+
+void self_profile_initialize(uint32_t sample_period)
+{
+    if (sample_period == 0) {
+        printf("Error: the self-profiling sample period must not be 0\n");
+        exit(1);
+    }
+    self_profile_sample_period = sample_period;
+    self_profile_countdown = sample_period;
+    self_profile_sampling = FALSE;
+    self_profile_outside_pending = FALSE;
+    for (int component = 0; component < SELF_PROFILE_NUM_COMPONENTS; component++) {
+        self_profile_ticks[component] = 0;
+        self_profile_intervals[component] = 0;
+    }
+
+  //The clock overhead is the shortest time between two readings.
+
+    self_profile_overhead = ~0ull;
+    for (int i = 0; i < 1000; i++) {
+        uint64_t first = SELF_PROFILE_NOW();
+        uint64_t second = SELF_PROFILE_NOW();
+        if (second - first < self_profile_overhead)
+            self_profile_overhead = second - first;
+    }
+    self_profile_accesses = 0;
+    self_profile_timed_accesses = 0;
+    self_profile_start_time = self_profile_host_time();
+    self_profile_start_ticks = SELF_PROFILE_NOW();
+    self_profile_enabled = TRUE;
+}
+
+
+BOOL self_profile_start_timing()
+{
+    uint64_t now = SELF_PROFILE_NOW();
+
+    if (self_profile_outside_pending) {
+        self_profile_ticks[SELF_PROFILE_OUTSIDE] += now - self_profile_last;
+        self_profile_intervals[SELF_PROFILE_OUTSIDE]++;
+        self_profile_outside_pending = FALSE;
+        if (self_profile_gap > 1) {
+            self_profile_countdown = self_profile_gap - 1;
+            return FALSE;
+        }
+    }
+    self_profile_timed_accesses++;
+    self_profile_sampling = TRUE;
+    self_profile_component = SELF_PROFILE_L1;
+    self_profile_last = SELF_PROFILE_NOW();
+    return TRUE;
+}
+
+
+void self_profile_end_access()
+{
+    self_profile_ticks[self_profile_component] += SELF_PROFILE_NOW() - self_profile_last;
+    self_profile_intervals[self_profile_component]++;
+    self_profile_sampling = FALSE;
+
+  //Draw the gap to the next timed access, and time the
+  //start of the next access.
+
+    self_profile_random ^= self_profile_random << 13;
+    self_profile_random ^= self_profile_random >> 17;
+    self_profile_random ^= self_profile_random << 5;
+    self_profile_gap = 1 + self_profile_random % (2 * self_profile_sample_period - 1);
+    self_profile_countdown = 1;
+    self_profile_outside_pending = TRUE;
+    self_profile_last = SELF_PROFILE_NOW();
+}
+
+
+//Returns the host time since the profile was started, and the
+//number of ticks per second over that time.
+
+static double self_profile_elapsed(double *ticks_per_second)
+{
+    double elapsed = self_profile_host_time() - self_profile_start_time;
+    uint64_t ticks = SELF_PROFILE_NOW() - self_profile_start_ticks;
+    *ticks_per_second = (elapsed > 0) ? ticks / elapsed : 1e9;
+    return elapsed;
+}
+
+
+double self_profile_seconds(uint8_t component)
+{
+    double ticks_per_second;
+    self_profile_elapsed(&ticks_per_second);
+    uint64_t overhead = self_profile_intervals[component] * self_profile_overhead;
+    if ((self_profile_timed_accesses == 0) || (self_profile_ticks[component] <= overhead))
+        return 0.0;
+    return (self_profile_ticks[component] - overhead) *
+           ((double) self_profile_accesses / self_profile_timed_accesses) / ticks_per_second;
+}
+
+
+void self_profile_report()
+{
+    double ticks_per_second;
+    double elapsed = self_profile_elapsed(&ticks_per_second);
+    double total = 0.0;
+
+    for (int component = 0; component < SELF_PROFILE_NUM_COMPONENTS; component++)
+        total += self_profile_seconds(component);
+    printf("Self-profile: %llu accesses in %.3f host seconds, %.2f million accesses per host second\n",
+           (unsigned long long) self_profile_accesses, elapsed,
+           (elapsed > 0) ? self_profile_accesses / elapsed / 1e6 : 0.0);
+    printf("  %llu accesses timed (1 in %u on average), host time per component (%.3f s in all):\n",
+           (unsigned long long) self_profile_timed_accesses, self_profile_sample_period, total);
+    for (int component = 0; component < SELF_PROFILE_NUM_COMPONENTS; component++) {
+        double seconds = self_profile_seconds(component);
+        printf("    %-28s %8.3f s (%5.2f%%)\n", self_profile_component_names[component], seconds,
+               (total > 0) ? 100.0 * seconds / total : 0.0);
+    }
+}
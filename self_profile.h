@@ -0,0 +1,166 @@
+/************************************************************
+
+    Self-profiling: where the simulator spends its host time.
+
+One memory access in every sample_period, on average, is timed with
+the host's time stamp counter (rdtsc) or, on other hosts,
+clock_gettime(). The gap between two timed accesses is random, from
+1 to 2 * sample_period - 1 accesses, so that the timed accesses
+don't fall in step with a regular access pattern (e.g. always on
+the same word of a line). The time of a timed access is split
+among the components of the memory subsystem it goes through: the
+L1 path (everything from memory_access() down, other than the
+following), memory_handle_l1_miss(), memory_handle_l2_miss() and
+main memory (memory_main_memory_access(), which includes
+main_memory_access() and the channels, tiers and compressed tier).
+The time of a component does not include that of the components it
+calls, and the time taken by reading the clock itself is taken out.
+
+The time from the end of a timed access to the start of the next
+access, spent outside of the memory subsystem (e.g. reading and
+parsing the trace, see trace.h), is timed too.
+
+At the end of the run, self_profile_report() scales the time of the
+timed accesses up to all of them, and prints the accesses simulated
+per host second and the host time of each component.
+
+The countdown to the next timed access is in memory_access() and
+memory_access_with_info() (see memory_subsystem.h), ahead of the L1
+hit fast path, which stays enabled: the accesses that are not timed
+only cost a countdown more, and a timed access goes through
+memory_access_timed(), which takes the fast path if it applies.
+
+************************************************************/
+
+#ifndef SELF_PROFILE_H
+#define SELF_PROFILE_H
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define SELF_PROFILE_NOW() __rdtsc()
+#else
+#include <time.h>
+static inline uint64_t self_profile_clock()
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000 + now.tv_nsec;
+}
+#define SELF_PROFILE_NOW() self_profile_clock()
+#endif
+
+//The components of the memory subsystem.
+#define SELF_PROFILE_L1 0
+#define SELF_PROFILE_L1_MISS 1
+#define SELF_PROFILE_L2_MISS 2
+#define SELF_PROFILE_MAIN_MEMORY 3
+#define SELF_PROFILE_OUTSIDE 4
+#define SELF_PROFILE_NUM_COMPONENTS 5
+
+//Set by self_profile_initialize().
+extern BOOL self_profile_enabled;
+extern uint32_t self_profile_sample_period;
+
+//The state of the access being timed, if any: self_profile_sampling
+//is TRUE while it is, self_profile_component is the component it is
+//in, since self_profile_last (in ticks).
+extern BOOL self_profile_sampling;
+extern uint8_t self_profile_component;
+extern uint64_t self_profile_last;
+extern uint64_t self_profile_ticks[SELF_PROFILE_NUM_COMPONENTS];
+extern uint64_t self_profile_intervals[SELF_PROFILE_NUM_COMPONENTS];
+
+extern uint64_t self_profile_accesses;
+extern uint64_t self_profile_timed_accesses;
+extern uint32_t self_profile_countdown;
+
+
+/************************************************
+
+       self_profile_initialize()
+
+This procedure clears the profile, starts the host clock for the
+report, and enables self-profiling, with one access in every
+sample_period timed.
+
+***********************************************/
+
+void self_profile_initialize(uint32_t sample_period);
+
+
+/************************************************
+
+       self_profile_start_access(), self_profile_end_access()
+
+self_profile_start_access() is called by memory_access() at the
+start of every access. It returns TRUE if the access is to be timed,
+in which case self_profile_end_access() is called at its end. The
+access after a timed one goes to self_profile_start_timing() too, to
+time the gap between them.
+
+***********************************************/
+
+BOOL self_profile_start_timing();
+
+static inline BOOL self_profile_start_access()
+{
+    self_profile_accesses++;
+    if (--self_profile_countdown)
+        return FALSE;
+    return self_profile_start_timing();
+}
+
+void self_profile_end_access();
+
+
+/************************************************
+
+       self_profile_enter(), self_profile_leave()
+
+self_profile_enter() is called on entering a component, and returns
+the component being left, to be passed to self_profile_leave() on
+returning to it. Outside of a timed access, they do nothing.
+
+***********************************************/
+
+static inline uint8_t self_profile_enter(uint8_t component)
+{
+    uint8_t outer = self_profile_component;
+    if (self_profile_sampling) {
+        uint64_t now = SELF_PROFILE_NOW();
+        self_profile_ticks[outer] += now - self_profile_last;
+        self_profile_intervals[outer]++;
+        self_profile_last = now;
+        self_profile_component = component;
+    }
+    return outer;
+}
+
+static inline void self_profile_leave(uint8_t outer)
+{
+    if (self_profile_sampling) {
+        uint64_t now = SELF_PROFILE_NOW();
+        self_profile_ticks[self_profile_component] += now - self_profile_last;
+        self_profile_intervals[self_profile_component]++;
+        self_profile_last = now;
+        self_profile_component = outer;
+    }
+}
+
+
+/************************************************
+
+       self_profile_seconds(), self_profile_report()
+
+self_profile_seconds() returns the estimated host time, in seconds,
+spent in the specified component since self_profile_initialize().
+self_profile_report() prints the host time and the accesses
+simulated per host second, then the estimated host time of each
+component (including the time outside of the memory subsystem).
+
+***********************************************/
+
+double self_profile_seconds(uint8_t component);
+void self_profile_report();
+
+#endif
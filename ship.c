@@ -0,0 +1,219 @@
+/************************************************************
+
+   This file contains the SHiP insertion policy (see ship.h).
+
+   The per-line state mirrors the L2 cache: each of the
+   L2_NUM_CACHE_SETS sets has L2_LINES_PER_SET entries, holding the
+   lines of that set that were inserted on a demand read. A line
+   leaves it when it is evicted from the L2 cache, and the whole of
+   it is cleared when the L2 cache is (see ship_clear_lines()). An
+   entry for a line that left L2 without either (e.g. invalidated
+   by a restore) is taken back on the next fill of its set.
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "l2_cache.h"
+#include "ship.h"
+
+/***************************************************
+This struct defines the SHiP state of an L2 line. It
+has the following fields:
+  line: the line address (address / 64).
+  signature: the signature of the fill.
+  reused: set on the first hit to the line.
+  distant: the prediction made at the fill.
+****************************************************/
+
+typedef struct {
+  BOOL valid;
+  uint32_t line;
+  uint16_t signature;
+  BOOL reused;
+  BOOL distant;
+} SHIP_LINE;
+
+SHIP_LINE ship_lines[L2_NUM_CACHE_SETS][L2_LINES_PER_SET];
+uint8_t ship_shct[SHIP_SHCT_ENTRIES];
+uint32_t ship_iseq_history[SHIP_ISEQ_LENGTH];
+
+BOOL ship_enabled = FALSE;
+uint8_t ship_signature_kind;
+
+uint64_t ship_fills;
+uint64_t ship_fills_distant;
+uint64_t ship_distant_reused;
+uint64_t ship_distant_not_reused;
+uint64_t ship_other_not_reused;
+
+
+void ship_clear_lines()
+{
+    for (int set = 0; set < L2_NUM_CACHE_SETS; set++) {
+        for (int way = 0; way < L2_LINES_PER_SET; way++)
+            ship_lines[set][way].valid = FALSE;
+    }
+    for (int i = 0; i < SHIP_ISEQ_LENGTH; i++)
+        ship_iseq_history[i] = 0;
+}
+
+
+void ship_initialize(uint8_t signature_kind)
+{
+    ship_clear_lines();
+    for (int i = 0; i < SHIP_SHCT_ENTRIES; i++)
+        ship_shct[i] = 1;
+
+    ship_fills = 0;
+    ship_fills_distant = 0;
+    ship_distant_reused = 0;
+    ship_distant_not_reused = 0;
+    ship_other_not_reused = 0;
+
+    ship_signature_kind = signature_kind;
+    ship_enabled = TRUE;
+}
+
+
+//Returns the SHiP state of the line containing the address,
+//or NULL if there is none.
+
+static SHIP_LINE *ship_find_line(uint32_t address)
+{
+    uint32_t line = address / BYTES_PER_CACHE_LINE;
+    SHIP_LINE *set = ship_lines[line % L2_NUM_CACHE_SETS];
+
+    for (int way = 0; way < L2_LINES_PER_SET; way++) {
+        if (set[way].valid && (set[way].line == line))
+            return &set[way];
+    }
+    return NULL;
+}
+
+
+static uint16_t ship_hash(uint32_t key)
+{
+    return (key * 0x9e3779b1) >> (32 - SHIP_SIGNATURE_BITS);
+}
+
+
+uint16_t ship_access(uint32_t address, const MEMORY_REQUEST_INFO *info)
+{
+    uint32_t pc = info ? info->pc : 0;
+
+    if (ship_signature_kind == SHIP_SIGNATURE_ISEQ) {
+        uint32_t key = pc;
+        for (int i = SHIP_ISEQ_LENGTH - 1; i > 0; i--) {
+            ship_iseq_history[i] = ship_iseq_history[i - 1];
+            key = (key * 31) ^ ship_iseq_history[i];
+        }
+        ship_iseq_history[0] = pc;
+        if (pc)
+            return ship_hash(key);
+    }
+    else if ((ship_signature_kind == SHIP_SIGNATURE_PC) && pc) {
+        return ship_hash(pc);
+    }
+    return ship_hash(address >> SHIP_REGION_SHIFT);
+}
+
+
+void ship_hit(uint32_t address)
+{
+    SHIP_LINE *entry = ship_find_line(address);
+    if ((entry == NULL) || entry->reused)
+        return;
+
+  //First re-reference since the fill: the signature is reused, and
+  //the line gets the normal priority back.
+
+    entry->reused = TRUE;
+    if (ship_shct[entry->signature] < SHIP_COUNTER_MAX)
+        ship_shct[entry->signature]++;
+    if (entry->distant) {
+        ship_distant_reused++;
+        l2_set_dead(address, FALSE);
+    }
+}
+
+
+void ship_fill(uint32_t address, uint16_t signature)
+{
+    uint32_t line = address / BYTES_PER_CACHE_LINE;
+    SHIP_LINE *set = ship_lines[line % L2_NUM_CACHE_SETS];
+    SHIP_LINE *entry = ship_find_line(address);
+
+    for (int way = 0; (entry == NULL) && (way < L2_LINES_PER_SET); way++) {
+        if (!set[way].valid)
+            entry = &set[way];
+    }
+
+  //With every entry of the set taken, one of them is for a line
+  //that is no longer in the L2 cache.
+
+    for (int way = 0; (entry == NULL) && (way < L2_LINES_PER_SET); way++) {
+        if (!l2_probe(set[way].line * BYTES_PER_CACHE_LINE))
+            entry = &set[way];
+    }
+    if (entry == NULL)
+        return;
+
+    entry->valid = TRUE;
+    entry->line = line;
+    entry->signature = signature;
+    entry->reused = FALSE;
+    entry->distant = (ship_shct[signature] == 0);
+
+    ship_fills++;
+    if (entry->distant)
+        ship_fills_distant++;
+    l2_set_dead(address, entry->distant);
+}
+
+
+void ship_evicted(uint32_t address)
+{
+    SHIP_LINE *entry = ship_find_line(address);
+    if (entry == NULL)
+        return;
+
+    entry->valid = FALSE;
+    if (entry->reused)
+        return;
+    if (ship_shct[entry->signature] > 0)
+        ship_shct[entry->signature]--;
+    if (entry->distant)
+        ship_distant_not_reused++;
+    else
+        ship_other_not_reused++;
+}
+
+
+/************************************************
+
+       ship_report()
+
+This procedure prints the SHiP statistics.
+
+***********************************************/
+
+void ship_report()
+{
+    static const char *kinds[] = {"PC", "memory region", "instruction sequence"};
+    uint64_t distant = ship_distant_reused + ship_distant_not_reused;
+    uint64_t not_reused = ship_distant_not_reused + ship_other_not_reused;
+
+    printf("SHiP (%s signatures): %llu of %llu L2 fills predicted distant\n",
+           kinds[ship_signature_kind],
+           (unsigned long long) ship_fills_distant, (unsigned long long) ship_fills);
+    printf("  of the evicted lines: accuracy = %.4f (%llu of %llu distant predictions), "
+           "coverage = %.4f (of %llu lines not reused)\n",
+           distant ? (double) ship_distant_not_reused / distant : 0.0,
+           (unsigned long long) ship_distant_not_reused, (unsigned long long) distant,
+           not_reused ? (double) ship_distant_not_reused / not_reused : 0.0,
+           (unsigned long long) not_reused);
+}
@@ -0,0 +1,113 @@
+/************************************************************
+
+    Signature-based hit prediction (SHiP) for L2 insertion.
+
+Each demand fill of the L2 cache is given a signature, and the
+signature history counter table (SHCT) learns, for each signature,
+whether the lines it inserts are re-referenced before they are
+evicted: the counter of a line's signature is incremented on the
+first hit to the line, and decremented if the line is evicted
+without having been hit.
+
+A fill whose signature has a counter of 0 is predicted to have a
+distant re-reference and is inserted at the lowest priority (it is
+marked in the L2 cache with l2_set_dead(), so that it is evicted
+before any other line of its set, until it is hit). Other fills are
+inserted as with NRU alone.
+
+There are three kinds of signatures:
+  SHIP_SIGNATURE_PC: the PC of the request.
+  SHIP_SIGNATURE_MEMORY: the region of memory (of 2^SHIP_REGION_SHIFT
+                         bytes) the line is in.
+  SHIP_SIGNATURE_ISEQ: the sequence of the PCs of the last
+                       SHIP_ISEQ_LENGTH demand reads of the L2 cache,
+                       up to and including this one.
+The PC-based signatures need the request metadata (see
+memory_request.h); a request without a PC uses the memory region.
+
+The signature and outcome (hit or not since the fill) of each line
+are kept by this module, alongside the L2 cache, for the lines
+inserted on a demand read. SHiP and the dead-block predictor
+(dead_block.h) both use the L2 dead bit, so only one of them can
+be enabled.
+
+************************************************************/
+
+#include "memory_request.h"
+
+//Kinds of signatures.
+#define SHIP_SIGNATURE_PC 0
+#define SHIP_SIGNATURE_MEMORY 1
+#define SHIP_SIGNATURE_ISEQ 2
+
+//16K 3-bit counters.
+#define SHIP_SIGNATURE_BITS 14
+#define SHIP_SHCT_ENTRIES (1 << SHIP_SIGNATURE_BITS)
+#define SHIP_COUNTER_MAX 7
+
+#define SHIP_REGION_SHIFT 14
+#define SHIP_ISEQ_LENGTH 4
+
+//Set to TRUE by ship_initialize().
+extern BOOL ship_enabled;
+
+
+/************************************************
+
+       ship_initialize()
+
+This procedure clears the counters, the per-line state and the
+statistics, and enables SHiP with the specified kind of signature.
+
+***********************************************/
+
+void ship_initialize(uint8_t signature_kind);
+
+
+/************************************************
+
+       ship_clear_lines()
+
+This procedure clears the per-line state and the instruction
+sequence history, keeping what the counters have learned. It is
+called whenever the L2 cache is cleared or restored, by
+memory_subsystem_initialize() and checkpoint_restore().
+
+***********************************************/
+
+void ship_clear_lines();
+
+
+/************************************************************
+The following procedures are called by memory_handle_l1_miss(),
+memory_handle_l2_miss() and memory_handle_cache_hint() (see
+memory_subsystem.c).
+************************************************************/
+
+//Called on each demand read of the L2 cache, before it is
+//performed. Returns the signature of the request.
+uint16_t ship_access(uint32_t address, const MEMORY_REQUEST_INFO *info);
+
+//Called on each hit of a demand read of the L2 cache.
+void ship_hit(uint32_t address);
+
+//Called after the line containing the address has been filled into
+//the L2 cache on a demand read. Records its signature and marks it
+//dead in the L2 cache if it is predicted to have a distant
+//re-reference.
+void ship_fill(uint32_t address, uint16_t signature);
+
+//Called with the address of each line evicted from the L2 cache.
+void ship_evicted(uint32_t address);
+
+
+/************************************************
+
+       ship_report()
+
+This procedure prints the number of fills predicted to have a
+distant re-reference and the accuracy of those predictions.
+
+***********************************************/
+
+void ship_report();
@@ -0,0 +1,173 @@
+/************************************************************
+
+   This file contains the SMS prefetcher (see sms_prefetcher.h).
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "prefetch.h"
+#include "sms_prefetcher.h"
+
+#define SMS_LINE_OFFSET(address) (((address) >> 6) & (SMS_REGION_LINES - 1))
+
+/***************************************************
+This struct defines an entry of the active generation
+table. It has the following fields:
+  region: the region number (address >> SMS_REGION_SHIFT).
+  trigger_offset: the line offset of the trigger access.
+  pht_index: where the footprint is stored in the pattern
+             history table.
+  footprint: bit i is set if line i of the region has
+             been accessed during the generation.
+  last_use: for LRU replacement.
+****************************************************/
+
+typedef struct {
+  BOOL valid;
+  uint32_t region;
+  uint8_t trigger_offset;
+  uint16_t pht_index;
+  uint32_t footprint;
+  uint64_t last_use;
+} SMS_AGT_ENTRY;
+
+SMS_AGT_ENTRY sms_agt[SMS_AGT_ENTRIES];
+
+//The pattern history table: a footprint per trigger offset (and PC),
+//0 if none has been recorded.
+uint32_t sms_pht[SMS_PHT_ENTRIES];
+
+uint64_t sms_time;
+uint8_t sms_source;
+
+uint64_t sms_triggers;
+uint64_t sms_pattern_hits;
+uint64_t sms_generations;
+
+
+static void sms_initialize(uint8_t source)
+{
+    sms_source = source;
+    sms_time = 0;
+    for (int i = 0; i < SMS_AGT_ENTRIES; i++)
+        sms_agt[i].valid = FALSE;
+    for (int i = 0; i < SMS_PHT_ENTRIES; i++)
+        sms_pht[i] = 0;
+    sms_triggers = 0;
+    sms_pattern_hits = 0;
+    sms_generations = 0;
+}
+
+
+//Ends the generation of an active region, storing its footprint
+//in the pattern history table. A footprint of a single line (the
+//trigger) has nothing to prefetch and is not stored.
+
+static void sms_end_generation(SMS_AGT_ENTRY *entry)
+{
+    entry->valid = FALSE;
+    sms_generations++;
+    if (entry->footprint & ~(1u << entry->trigger_offset))
+        sms_pht[entry->pht_index] = entry->footprint;
+}
+
+
+//Returns the pattern history table index of a trigger access. The
+//PC, if any, selects the slot and the trigger offset the entry in it.
+
+static uint16_t sms_pht_index(uint8_t offset, const MEMORY_REQUEST_INFO *info)
+{
+    uint32_t pc = info ? info->pc : 0;
+    uint32_t slot = ((pc >> 2) * 0x9e3779b1) >> 29;
+    return (slot * SMS_REGION_LINES + offset) % SMS_PHT_ENTRIES;
+}
+
+
+static void sms_train(uint32_t address, uint8_t outcome, const MEMORY_REQUEST_INFO *info)
+{
+    uint32_t region = address >> SMS_REGION_SHIFT;
+    uint8_t offset = SMS_LINE_OFFSET(address);
+    int victim = 0;
+
+    sms_time++;
+    for (int i = 0; i < SMS_AGT_ENTRIES; i++) {
+        if (sms_agt[i].valid && (sms_agt[i].region == region)) {
+            sms_agt[i].footprint |= 1u << offset;
+            sms_agt[i].last_use = sms_time;
+            return;
+        }
+        if (!sms_agt[i].valid)
+            victim = i;
+        else if (sms_agt[victim].valid && (sms_agt[i].last_use < sms_agt[victim].last_use))
+            victim = i;
+    }
+
+  //This is a trigger access: start a new generation.
+
+    sms_triggers++;
+    if (sms_agt[victim].valid)
+        sms_end_generation(&sms_agt[victim]);
+    sms_agt[victim].valid = TRUE;
+    sms_agt[victim].region = region;
+    sms_agt[victim].trigger_offset = offset;
+    sms_agt[victim].pht_index = sms_pht_index(offset, info);
+    sms_agt[victim].footprint = 1u << offset;
+    sms_agt[victim].last_use = sms_time;
+
+  //Replay the footprint recorded for this trigger, starting
+  //with the lines nearest the trigger.
+
+    uint32_t footprint = sms_pht[sms_agt[victim].pht_index] & ~(1u << offset);
+    if (footprint == 0)
+        return;
+    sms_pattern_hits++;
+
+    uint32_t limit = prefetch_distance();
+    uint32_t region_address = region << SMS_REGION_SHIFT;
+    for (int d = 1; (d < SMS_REGION_LINES) && limit; d++) {
+        int candidates[2] = {offset + d, offset - d};
+        for (int c = 0; (c < 2) && limit; c++) {
+            int line = candidates[c];
+            if ((line >= 0) && (line < SMS_REGION_LINES) && (footprint & (1u << line))) {
+                prefetch_issue(region_address + line * BYTES_PER_CACHE_LINE, sms_source);
+                limit--;
+            }
+        }
+    }
+}
+
+
+//The eviction of any line of an active region ends its generation.
+
+static void sms_evicted(uint32_t address)
+{
+    uint32_t region = address >> SMS_REGION_SHIFT;
+    for (int i = 0; i < SMS_AGT_ENTRIES; i++) {
+        if (sms_agt[i].valid && (sms_agt[i].region == region)) {
+            sms_end_generation(&sms_agt[i]);
+            return;
+        }
+    }
+}
+
+
+static void sms_report()
+{
+    printf("    %llu triggers, %llu (%.2f%%) with a recorded pattern; %llu generations ended\n",
+           (unsigned long long) sms_triggers, (unsigned long long) sms_pattern_hits,
+           sms_triggers ? 100.0 * sms_pattern_hits / sms_triggers : 0.0,
+           (unsigned long long) sms_generations);
+}
+
+
+const PREFETCHER sms_prefetcher = {
+    "sms",
+    sms_initialize,
+    sms_train,
+    sms_evicted,
+    sms_report
+};
@@ -0,0 +1,37 @@
+/************************************************************
+
+    Spatial Memory Streaming (SMS) prefetcher.
+
+Memory is divided into spatial regions of SMS_REGION_LINES cache
+lines. A generation of a region starts with a demand access to a
+region that is not active (the trigger access) and lasts until one
+of the region's lines is evicted from the L2 cache, or the region
+is pushed out of the active generation table. During a generation,
+the active generation table records the footprint of the region:
+a bitmap of the lines accessed.
+
+When a generation ends, its footprint is stored in the pattern
+history table, indexed by the offset of the trigger access within
+the region and, if the request carries one (see memory_request.h),
+the PC of the trigger access. When a new generation starts with a
+trigger at the same offset (and PC), in any region, the footprint
+is replayed: the lines it contains are prefetched into the L2
+cache. The number of lines prefetched per trigger is limited to
+prefetch_distance(), so the prefetch throttling (see prefetch.h)
+applies.
+
+It is attached with prefetch_attach(&sms_prefetcher).
+
+************************************************************/
+
+//2KB regions, with one bit per line in a 32-bit footprint.
+#define SMS_REGION_SHIFT 11
+#define SMS_REGION_LINES (1 << (SMS_REGION_SHIFT - 6))
+
+#define SMS_AGT_ENTRIES 32
+
+//One pattern per trigger offset, for each of 8 PC slots. Requests
+//without a PC all use the first slot.
+#define SMS_PHT_ENTRIES (8 * SMS_REGION_LINES)
+
+extern const PREFETCHER sms_prefetcher;
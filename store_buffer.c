@@ -0,0 +1,240 @@
+/************************************************************
+
+   This file contains the store buffer (see store_buffer.h).
+
+   The store buffer is a circular FIFO of entries, searched in full
+   (it is small) to coalesce a store or forward a read. A line has
+   at most one entry that is not being drained.
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "store_buffer.h"
+
+//This is defined in memory_subsystem.c. It performs a read or write
+//on the L1 cache, handling a miss, and returns its latency.
+uint32_t memory_perform_access(uint32_t address, uint32_t write_data,
+			       uint8_t control, uint32_t *read_data,
+			       const MEMORY_REQUEST_INFO *info);
+
+/***************************************************
+This struct defines an entry of the store buffer. It
+has the following fields:
+  line: the line address (address / 64).
+  word_mask: bit i is set if word i of the line has
+             been written.
+  data: the words written.
+  time: the cycle at which the entry was allocated.
+****************************************************/
+
+typedef struct {
+  uint32_t line;
+  uint32_t word_mask;
+  uint32_t data[WORDS_PER_CACHE_LINE];
+  uint64_t time;
+} STORE_BUFFER_ENTRY;
+
+STORE_BUFFER_ENTRY store_buffer[STORE_BUFFER_MAX_ENTRIES];
+uint32_t store_buffer_entries;
+uint32_t store_buffer_head;
+uint32_t store_buffer_count;
+
+//Whether the oldest entry is being drained, and the cycle at which
+//the drain in progress (or the last one) completes.
+BOOL store_buffer_draining;
+uint64_t store_buffer_drain_done;
+
+BOOL store_buffer_enabled = FALSE;
+
+uint64_t store_buffer_stores;
+uint64_t store_buffer_coalesced;
+uint64_t store_buffer_forwarded;
+uint64_t store_buffer_drains;
+uint64_t store_buffer_drain_cycles;
+uint64_t store_buffer_stall_cycles;
+
+
+void store_buffer_initialize(uint32_t entries)
+{
+    if ((entries == 0) || (entries > STORE_BUFFER_MAX_ENTRIES)) {
+        printf("Error: the store buffer must have 1 to %d entries\n", STORE_BUFFER_MAX_ENTRIES);
+        exit(1);
+    }
+    store_buffer_entries = entries;
+    store_buffer_head = 0;
+    store_buffer_count = 0;
+    store_buffer_draining = FALSE;
+    store_buffer_drain_done = memory_cycles;
+
+    store_buffer_stores = 0;
+    store_buffer_coalesced = 0;
+    store_buffer_forwarded = 0;
+    store_buffer_drains = 0;
+    store_buffer_drain_cycles = 0;
+    store_buffer_stall_cycles = 0;
+
+    store_buffer_enabled = TRUE;
+}
+
+
+//Returns the ith oldest entry.
+
+static STORE_BUFFER_ENTRY *store_buffer_entry(uint32_t i)
+{
+    return &store_buffer[(store_buffer_head + i) % store_buffer_entries];
+}
+
+
+//Starts the drain of the oldest entry: its stores are performed on
+//the L1 cache now, but it stays in the store buffer (and can still
+//forward them) until store_buffer_drain_done.
+
+static void store_buffer_start_drain()
+{
+    STORE_BUFFER_ENTRY *entry = store_buffer_entry(0);
+    uint64_t start = (entry->time > store_buffer_drain_done) ? entry->time : store_buffer_drain_done;
+    uint32_t latency = 0;
+    uint32_t read_data;
+
+    for (int i = 0; i < WORDS_PER_CACHE_LINE; i++) {
+        if (entry->word_mask & (1u << i)) {
+            uint32_t word_latency = memory_perform_access(entry->line * BYTES_PER_CACHE_LINE + i * BYTES_PER_WORD,
+                                                          entry->data[i], WRITE_ENABLE_MASK, &read_data, NULL);
+            if (latency == 0)
+                latency = word_latency;
+        }
+    }
+
+    store_buffer_draining = TRUE;
+    store_buffer_drain_done = start + latency;
+    store_buffer_drains++;
+    store_buffer_drain_cycles += latency;
+}
+
+
+//Removes the oldest entry, once its drain has completed.
+
+static void store_buffer_remove_oldest()
+{
+    store_buffer_draining = FALSE;
+    store_buffer_head = (store_buffer_head + 1) % store_buffer_entries;
+    store_buffer_count--;
+}
+
+
+//Waits (stalls) until the oldest entry has drained, and removes it.
+
+static void store_buffer_wait_for_oldest()
+{
+    if (!store_buffer_draining)
+        store_buffer_start_drain();
+    if (memory_cycles < store_buffer_drain_done) {
+        store_buffer_stall_cycles += store_buffer_drain_done - memory_cycles;
+        memory_cycles = store_buffer_drain_done;
+    }
+    store_buffer_remove_oldest();
+}
+
+
+void store_buffer_advance()
+{
+    while (store_buffer_count) {
+        if (!store_buffer_draining) {
+            if (store_buffer_drain_done > memory_cycles)
+                return;
+            store_buffer_start_drain();
+        }
+        if (store_buffer_drain_done > memory_cycles)
+            return;
+        store_buffer_remove_oldest();
+    }
+}
+
+
+void store_buffer_write(uint32_t address, uint32_t write_data)
+{
+    uint32_t line = address / BYTES_PER_CACHE_LINE;
+    uint32_t word = (address % BYTES_PER_CACHE_LINE) / BYTES_PER_WORD;
+    STORE_BUFFER_ENTRY *entry = NULL;
+
+  //A store is coalesced into the entry of its line, unless that
+  //entry is already being drained.
+
+    store_buffer_stores++;
+    for (uint32_t i = store_buffer_draining ? 1 : 0; i < store_buffer_count; i++) {
+        if (store_buffer_entry(i)->line == line)
+            entry = store_buffer_entry(i);
+    }
+    if (entry) {
+        store_buffer_coalesced++;
+    }
+    else {
+        if (store_buffer_count == store_buffer_entries)
+            store_buffer_wait_for_oldest();
+        entry = store_buffer_entry(store_buffer_count);
+        store_buffer_count++;
+        entry->line = line;
+        entry->word_mask = 0;
+        entry->time = memory_cycles;
+    }
+    entry->word_mask |= 1u << word;
+    entry->data[word] = write_data;
+    memory_cycles += STORE_BUFFER_RETIRE_LATENCY;
+}
+
+
+BOOL store_buffer_forward(uint32_t address, uint32_t *read_data)
+{
+    uint32_t line = address / BYTES_PER_CACHE_LINE;
+    uint32_t word = (address % BYTES_PER_CACHE_LINE) / BYTES_PER_WORD;
+
+  //The youngest store to the word is forwarded.
+
+    for (uint32_t i = store_buffer_count; i > 0; i--) {
+        STORE_BUFFER_ENTRY *entry = store_buffer_entry(i - 1);
+        if ((entry->line == line) && (entry->word_mask & (1u << word))) {
+            *read_data = entry->data[word];
+            store_buffer_forwarded++;
+            memory_cycles += L1_HIT_LATENCY;
+            return TRUE;
+        }
+    }
+    return FALSE;
+}
+
+
+void store_buffer_drain()
+{
+    while (store_buffer_count)
+        store_buffer_wait_for_oldest();
+}
+
+
+/************************************************
+
+       store_buffer_report()
+
+This procedure prints the store buffer statistics.
+
+***********************************************/
+
+void store_buffer_report()
+{
+    uint64_t hidden = store_buffer_drain_cycles - store_buffer_stall_cycles;
+
+    printf("Store buffer (%u entries): %llu stores, %llu (%.2f%%) coalesced, %llu reads forwarded\n",
+           store_buffer_entries, (unsigned long long) store_buffer_stores,
+           (unsigned long long) store_buffer_coalesced,
+           store_buffer_stores ? 100.0 * store_buffer_coalesced / store_buffer_stores : 0.0,
+           (unsigned long long) store_buffer_forwarded);
+    printf("  %llu entries drained in %llu cycles, %llu cycles stalled waiting for drains, "
+           "%llu cycles (%.2f%%) of store latency hidden\n",
+           (unsigned long long) store_buffer_drains, (unsigned long long) store_buffer_drain_cycles,
+           (unsigned long long) store_buffer_stall_cycles, (unsigned long long) hidden,
+           store_buffer_drain_cycles ? 100.0 * hidden / store_buffer_drain_cycles : 0.0);
+}
@@ -0,0 +1,90 @@
+/************************************************************
+
+    Store buffer in front of the L1 cache.
+
+While the store buffer is enabled, a write retires into the store
+buffer instead of blocking on the L1 cache (and a possible miss).
+Each entry holds the stores to one cache line: a write to a line
+that already has an entry is coalesced into it, otherwise it takes
+a new entry. Entries drain into the L1 cache in FIFO order, one at
+a time, in the background. A read of a word that is in the store
+buffer is forwarded from it, without accessing the caches; any
+other read goes to the L1 cache as usual (the store buffer only
+holds the words that were written).
+
+Timing follows the latency model (see memory_subsystem.h): a store
+takes STORE_BUFFER_RETIRE_LATENCY cycles, and a forwarded read
+L1_HIT_LATENCY cycles. The drain of an entry starts when the
+previous one has completed and takes the latency of the first write
+of the entry into the L1 cache (the rest of the line is then in L1).
+An entry stays in the store buffer until its drain has completed,
+and stores are only coalesced into entries not yet being drained.
+When a store finds the store buffer full, it stalls until the
+oldest entry has drained. The latency of the drains that was not
+spent stalling is the store latency hidden by the store buffer.
+
+************************************************************/
+
+#define STORE_BUFFER_MAX_ENTRIES 64
+#define STORE_BUFFER_RETIRE_LATENCY 1
+
+//Set by store_buffer_initialize().
+extern BOOL store_buffer_enabled;
+extern uint32_t store_buffer_entries;
+
+
+/************************************************
+
+       store_buffer_initialize()
+
+This procedure empties the store buffer, sets its number of entries
+(1 to STORE_BUFFER_MAX_ENTRIES), clears the statistics and enables
+the store buffer.
+
+***********************************************/
+
+void store_buffer_initialize(uint32_t entries);
+
+
+/************************************************************
+The following procedures are called by memory_access_slow()
+(see memory_subsystem.c), which advances memory_cycles.
+************************************************************/
+
+//Drains the entries whose drain can have started by memory_cycles.
+void store_buffer_advance();
+
+//Retires a write into the store buffer, stalling if it is full.
+void store_buffer_write(uint32_t address, uint32_t write_data);
+
+//If the word at the address is in the store buffer, copies it to
+//read_data and returns TRUE.
+BOOL store_buffer_forward(uint32_t address, uint32_t *read_data);
+
+
+/************************************************
+
+       store_buffer_drain()
+
+This procedure drains every entry of the store buffer into the L1
+cache, advancing memory_cycles until the last one has completed.
+It is called before a demote or evict hint, and may be called to
+have all the stores performed, e.g. at the end of a run.
+
+***********************************************/
+
+void store_buffer_drain();
+
+
+/************************************************
+
+       store_buffer_report()
+
+This procedure prints the number of stores, coalesced stores and
+forwarded reads, the drain latency, the cycles stalled waiting for
+drains (on a full store buffer or in store_buffer_drain()) and the
+store latency hidden.
+
+***********************************************/
+
+void store_buffer_report();
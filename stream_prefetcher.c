@@ -0,0 +1,120 @@
+/************************************************************
+
+   This file contains the stream prefetcher (see stream_prefetcher.h).
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "prefetch.h"
+#include "stream_prefetcher.h"
+
+/***************************************************
+This struct defines a stream. It has the following
+fields:
+  last_line: the line number (address / 64) of the last
+             demand access to the stream.
+  next_line: the next line to be prefetched.
+  direction: 1 (ascending) or -1 (descending), or 0 if the
+             stream hasn't been trained yet.
+  last_use: for LRU replacement.
+****************************************************/
+
+typedef struct {
+  BOOL valid;
+  int64_t last_line;
+  int64_t next_line;
+  int direction;
+  uint64_t last_use;
+} STREAM_ENTRY;
+
+STREAM_ENTRY streams[STREAM_PREFETCHER_ENTRIES];
+uint64_t stream_time;
+uint8_t stream_source;
+
+
+static void stream_initialize(uint8_t source)
+{
+    stream_source = source;
+    stream_time = 0;
+    for (int i = 0; i < STREAM_PREFETCHER_ENTRIES; i++)
+        streams[i].valid = FALSE;
+}
+
+
+static void stream_train(uint32_t address, uint8_t outcome, const MEMORY_REQUEST_INFO *info)
+{
+    int64_t line = address / BYTES_PER_CACHE_LINE;
+    STREAM_ENTRY *stream = NULL;
+    int victim = 0;
+
+  //Hits on lines that were not prefetched don't say anything
+  //about whether the streams are running ahead of the demand.
+
+    if (outcome == PREFETCH_OUTCOME_HIT)
+        return;
+
+    stream_time++;
+    for (int i = 0; i < STREAM_PREFETCHER_ENTRIES; i++) {
+        if (!streams[i].valid) {
+            victim = i;
+            continue;
+        }
+        if ((line >= streams[i].last_line - STREAM_PREFETCHER_WINDOW) &&
+            (line <= streams[i].last_line + STREAM_PREFETCHER_WINDOW)) {
+            stream = &streams[i];
+            break;
+        }
+        if (streams[victim].valid && (streams[i].last_use < streams[victim].last_use))
+            victim = i;
+    }
+
+  //A miss outside of all the streams starts a new one.
+
+    if (stream == NULL) {
+        if (outcome == PREFETCH_OUTCOME_MISS) {
+            streams[victim].valid = TRUE;
+            streams[victim].last_line = line;
+            streams[victim].direction = 0;
+            streams[victim].last_use = stream_time;
+        }
+        return;
+    }
+
+    stream->last_use = stream_time;
+    int64_t delta = line - stream->last_line;
+    if (delta == 0)
+        return;
+
+  //The first access after allocation sets the direction, and so does
+  //an access going the other way.
+
+    int direction = (delta > 0) ? 1 : -1;
+    if (direction != stream->direction) {
+        stream->direction = direction;
+        stream->next_line = line + direction;
+    }
+    stream->last_line = line;
+    if ((stream->next_line - line) * direction <= 0)
+        stream->next_line = line + direction;
+
+    int64_t distance = prefetch_distance();
+    for (uint32_t n = 0; n < prefetch_degree(); n++) {
+        if (((stream->next_line - line) * direction > distance) || (stream->next_line < 0))
+            break;
+        prefetch_issue((uint32_t) (stream->next_line * BYTES_PER_CACHE_LINE), stream_source);
+        stream->next_line += direction;
+    }
+}
+
+
+const PREFETCHER stream_prefetcher = {
+    "stream",
+    stream_initialize,
+    stream_train,
+    NULL,
+    NULL
+};
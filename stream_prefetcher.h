@@ -0,0 +1,24 @@
+/************************************************************
+
+    Stream prefetcher.
+
+The stream prefetcher tracks up to STREAM_PREFETCHER_ENTRIES streams
+of L2 demand accesses (with LRU replacement). A stream is allocated
+on a miss and trained by the next access within
+STREAM_PREFETCHER_WINDOW lines of it, which sets its direction
+(ascending or descending). A trained stream then prefetches up to
+prefetch_degree() lines per access, staying within
+prefetch_distance() lines ahead of the last demand access, so that
+its aggressiveness is set by the prefetch throttling (see prefetch.h).
+
+It is attached with prefetch_attach(&stream_prefetcher).
+
+************************************************************/
+
+#define STREAM_PREFETCHER_ENTRIES 16
+
+//Accesses more than this many lines away from a stream
+//do not belong to it.
+#define STREAM_PREFETCHER_WINDOW 16
+
+extern const PREFETCHER stream_prefetcher;
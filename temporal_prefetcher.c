@@ -0,0 +1,137 @@
+/************************************************************
+
+   This file contains the temporal prefetcher (see
+   temporal_prefetcher.h).
+
+   Positions in the history buffer are sequence numbers: the n-th
+   miss recorded is at position n, stored in entry n % ghb_entries.
+   A position is still in the buffer if it is one of the last
+   ghb_entries recorded.
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "prefetch.h"
+#include "temporal_prefetcher.h"
+
+/***************************************************
+This struct defines an entry of the index table. It
+has the following fields:
+  line: the line address (address / 64) of the miss,
+        or 0xffffffff if the entry is empty.
+  position: the latest position of the miss in the
+            history buffer.
+****************************************************/
+
+typedef struct {
+  uint32_t line;
+  uint32_t position;
+} TEMPORAL_INDEX_ENTRY;
+
+uint32_t temporal_max_metadata_bytes = TEMPORAL_PREFETCHER_DEFAULT_METADATA_BYTES;
+
+//The history buffer holds line addresses.
+uint32_t *temporal_ghb;
+uint32_t temporal_ghb_entries;
+uint32_t temporal_next_position;
+
+//The index table is direct-mapped, with a power-of-2 number of entries.
+TEMPORAL_INDEX_ENTRY *temporal_index;
+uint32_t temporal_index_entries;
+
+uint8_t temporal_source;
+
+uint64_t temporal_lookups;
+uint64_t temporal_index_hits;
+
+
+void temporal_prefetcher_configure(uint32_t max_metadata_bytes)
+{
+    temporal_max_metadata_bytes = max_metadata_bytes;
+}
+
+
+static void temporal_initialize(uint8_t source)
+{
+    temporal_source = source;
+
+    temporal_ghb_entries = temporal_max_metadata_bytes / 2 / sizeof(uint32_t);
+    temporal_index_entries = 1;
+    while (2 * temporal_index_entries * sizeof(TEMPORAL_INDEX_ENTRY) <= temporal_max_metadata_bytes / 2)
+        temporal_index_entries *= 2;
+    if (temporal_ghb_entries < 2) {
+        printf("Error: the temporal prefetcher needs at least %d bytes of metadata\n",
+               (int) (4 * sizeof(uint32_t)));
+        exit(1);
+    }
+
+    free(temporal_ghb);
+    free(temporal_index);
+    temporal_ghb = malloc(temporal_ghb_entries * sizeof(uint32_t));
+    temporal_index = malloc(temporal_index_entries * sizeof(TEMPORAL_INDEX_ENTRY));
+    if ((temporal_ghb == NULL) || (temporal_index == NULL)) {
+        printf("Error: malloc failed in temporal prefetcher\n");
+        exit(1);
+    }
+    for (uint32_t i = 0; i < temporal_index_entries; i++)
+        temporal_index[i].line = 0xffffffff;
+    temporal_next_position = 0;
+
+    temporal_lookups = 0;
+    temporal_index_hits = 0;
+}
+
+
+static void temporal_train(uint32_t address, uint8_t outcome, const MEMORY_REQUEST_INFO *info)
+{
+    uint32_t line = address / BYTES_PER_CACHE_LINE;
+
+    if (outcome == PREFETCH_OUTCOME_HIT)
+        return;
+
+  //Look up the previous occurrence of this miss, and prefetch
+  //the misses that followed it, if they are still in the buffer.
+
+    temporal_lookups++;
+    TEMPORAL_INDEX_ENTRY *entry = &temporal_index[(line * 0x9e3779b1) & (temporal_index_entries - 1)];
+    if ((entry->line == line) && (temporal_next_position - entry->position < temporal_ghb_entries)) {
+        temporal_index_hits++;
+        uint32_t lookahead = prefetch_distance() / 4;
+        for (uint32_t position = entry->position + 1;
+             (position != temporal_next_position) && (position - entry->position <= lookahead);
+             position++) {
+            prefetch_issue(temporal_ghb[position % temporal_ghb_entries] * BYTES_PER_CACHE_LINE, temporal_source);
+        }
+    }
+
+  //Record the miss.
+
+    temporal_ghb[temporal_next_position % temporal_ghb_entries] = line;
+    entry->line = line;
+    entry->position = temporal_next_position;
+    temporal_next_position++;
+}
+
+
+static void temporal_report()
+{
+    uint32_t metadata_bytes = temporal_ghb_entries * sizeof(uint32_t) + temporal_index_entries * sizeof(TEMPORAL_INDEX_ENTRY);
+    printf("    metadata: %u bytes (limit %u): %u history entries, %u index entries\n",
+           metadata_bytes, temporal_max_metadata_bytes, temporal_ghb_entries, temporal_index_entries);
+    printf("    %llu lookups, %llu (%.2f%%) found a recorded successor\n",
+           (unsigned long long) temporal_lookups, (unsigned long long) temporal_index_hits,
+           temporal_lookups ? 100.0 * temporal_index_hits / temporal_lookups : 0.0);
+}
+
+
+const PREFETCHER temporal_prefetcher = {
+    "temporal",
+    temporal_initialize,
+    temporal_train,
+    NULL,
+    temporal_report
+};
@@ -0,0 +1,37 @@
+/************************************************************
+
+    Temporal (STMS-style) prefetcher.
+
+The temporal prefetcher records the sequence of L2 demand misses
+(including hits on prefetched lines, which would have been misses)
+in a circular global history buffer (GHB), and keeps an index table
+mapping the address of a miss to its latest position in the buffer.
+On a miss whose address is found in the index table, the misses
+that followed it last time are prefetched: up to
+prefetch_distance() / 4 of them, so that the prefetch throttling
+(see prefetch.h) applies.
+
+The buffer and the table are bounded by a metadata budget, set with
+temporal_prefetcher_configure() before the prefetcher is attached
+with prefetch_attach(&temporal_prefetcher). Half of the budget goes
+to the buffer (4 bytes per entry) and half to the index table (8
+bytes per entry). The metadata size is printed by prefetch_report().
+
+************************************************************/
+
+#define TEMPORAL_PREFETCHER_DEFAULT_METADATA_BYTES (256 * 1024)
+
+extern const PREFETCHER temporal_prefetcher;
+
+
+/************************************************
+
+       temporal_prefetcher_configure()
+
+This procedure sets the maximum number of bytes of metadata
+(history buffer and index table) of the temporal prefetcher.
+It takes effect the next time the prefetcher is attached.
+
+***********************************************/
+
+void temporal_prefetcher_configure(uint32_t max_metadata_bytes);
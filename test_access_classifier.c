@@ -0,0 +1,77 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "access_classifier.h"
+
+#define REGION_SIZE (1 << ACCESS_CLASSIFIER_REGION_SHIFT)
+
+void check_class(uint32_t address, uint8_t expected, const char *name)
+{
+  uint8_t access_class = access_classifier_region_class(address);
+  if (access_class != expected) {
+    printf("Error: region at %x should be %s, is class %u\n", address, name, access_class);
+    exit(1);
+  }
+}
+
+int main()
+{
+  uint32_t i, address;
+
+  access_classifier_initialize();
+
+  printf("Pass 1: Sequential misses over several regions\n");
+
+  for (address = 0x100000; address < 0x100000 + 4 * REGION_SIZE; address += BYTES_PER_CACHE_LINE)
+    access_classifier_miss(address);
+  check_class(0x100000, ACCESS_CLASS_SEQUENTIAL, "sequential");
+  check_class(0x100000 + 3 * REGION_SIZE, ACCESS_CLASS_SEQUENTIAL, "sequential");
+
+  //only the first miss of the stream has no history
+  if (access_classifier_class_misses(ACCESS_CLASS_SEQUENTIAL) < 4 * 64 - 3) {
+    printf("Error: almost all misses should be sequential\n");
+    exit(1);
+  }
+
+  printf("Pass 2: Misses with a stride of 5 lines, descending\n");
+
+  for (address = 0x200000 + 2 * REGION_SIZE; address > 0x200000; address -= 5 * BYTES_PER_CACHE_LINE)
+    access_classifier_miss(address);
+  check_class(0x200000 + REGION_SIZE, ACCESS_CLASS_STRIDED, "strided");
+
+  printf("Pass 3: Pointer chasing\n");
+
+  //each miss is on the value returned by the previous load
+  srand(97);
+  address = 0x300000;
+  for (i = 0; i < 20; i++) {
+    access_classifier_miss(address);
+    address = 0x300000 + ((rand() % REGION_SIZE) & ~0x3);
+    access_classifier_note_load(address);
+  }
+  check_class(0x300000, ACCESS_CLASS_POINTER_CHASING, "pointer-chasing");
+
+  printf("Pass 4: Random misses within a region\n");
+
+  srand(98);
+  for (i = 0; i < 40; i++)
+    access_classifier_miss(0x400000 + ((rand() % REGION_SIZE) & ~0x3));
+  check_class(0x400000, ACCESS_CLASS_RANDOM, "random");
+
+  access_classifier_report();
+
+  printf("Pass 5: The table is bounded, least recently used regions are replaced\n");
+
+  for (i = 0; i < ACCESS_CLASSIFIER_TABLE_ENTRIES; i++)
+    access_classifier_miss(0x1000000 + i * 2 * REGION_SIZE);
+  check_class(0x100000, ACCESS_CLASS_UNKNOWN, "no longer in the table");
+  if (access_classifier_region_class(0x1000000 + (ACCESS_CLASSIFIER_TABLE_ENTRIES - 1) * 2 * REGION_SIZE)
+      != ACCESS_CLASS_UNKNOWN) {
+    printf("Error: a region with a single miss should have no class yet\n");
+    exit(1);
+  }
+
+  printf("Passed\n");
+}
@@ -0,0 +1,17 @@
+/************************************************************
+
+    The check used by the tests.
+
+check() prints the specified message as an error and exits if the
+condition does not hold, like the checks written out in the older
+tests.
+
+************************************************************/
+
+static inline void check(BOOL condition, const char *message)
+{
+  if (!condition) {
+    printf("Error: %s\n", message);
+    exit(1);
+  }
+}
@@ -0,0 +1,122 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "checkpoint.h"
+#include "test_check.h"
+
+// We'll test with an 8MB (2^23) memory
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 23)
+
+//The first segment writes this much of memory, each following
+//segment works in a SEGMENT_SIZE region of it.
+#define WARM_SIZE (1 << 22)
+#define SEGMENT_SIZE (1 << 15)
+#define SEGMENT_ACCESSES 50000
+
+extern uint32_t num_l1_misses;
+extern uint32_t num_l2_misses;
+
+//The result of running a segment: its misses and a checksum of
+//the data it read.
+typedef struct {
+  uint32_t l1_misses;
+  uint32_t l2_misses;
+  uint32_t checksum;
+} SEGMENT_RESULT;
+
+SEGMENT_RESULT run_segment(uint32_t segment)
+{
+  SEGMENT_RESULT result = {num_l1_misses, num_l2_misses, 0};
+  uint32_t base = (segment * 23 * SEGMENT_SIZE) % WARM_SIZE;
+  uint32_t seed = segment;
+  uint32_t read_data;
+
+  for (int i = 0; i < SEGMENT_ACCESSES; i++) {
+    seed = seed * 1103515245 + 12345;
+    uint32_t address = base + ((seed >> 8) % SEGMENT_SIZE & ~0x3);
+    if ((seed >> 4) % 4 == 0) {
+      memory_access(address, seed, WRITE_ENABLE_MASK, NULL);
+    }
+    else {
+      memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+      result.checksum = result.checksum * 31 + read_data;
+    }
+  }
+  result.l1_misses = num_l1_misses - result.l1_misses;
+  result.l2_misses = num_l2_misses - result.l2_misses;
+  return result;
+}
+
+void check_same(SEGMENT_RESULT a, SEGMENT_RESULT b, const char *message)
+{
+  check((a.l1_misses == b.l1_misses) && (a.l2_misses == b.l2_misses) && (a.checksum == b.checksum), message);
+}
+
+int main()
+{
+  FILE *checkpoints[3];
+  long sizes[3];
+  SEGMENT_RESULT segment3, segment4, result;
+
+  printf("Pass 1: Writing a full checkpoint and two deltas\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  for (uint32_t address = 0; address < WARM_SIZE; address += 4)
+    memory_access(address, address, WRITE_ENABLE_MASK, NULL);
+  run_segment(1);
+  for (int i = 0; i < 3; i++) {
+    checkpoints[i] = tmpfile();
+    check(checkpoint_write(checkpoints[i], i == 0) == (uint32_t) i, "the checkpoints should be numbered in order");
+    sizes[i] = ftell(checkpoints[i]);
+    if (i == 0)
+      run_segment(2);
+    else if (i == 1)
+      segment3 = run_segment(3);
+  }
+  segment4 = run_segment(4);
+  printf("Full checkpoint: %ld bytes, deltas: %ld and %ld bytes\n", sizes[0], sizes[1], sizes[2]);
+  printf("Segment 3: %u L1 misses, %u L2 misses; segment 4: %u L1 misses, %u L2 misses\n",
+         segment3.l1_misses, segment3.l2_misses, segment4.l1_misses, segment4.l2_misses);
+  check((sizes[1] < sizes[0] / 8) && (sizes[2] < sizes[0] / 8), "the deltas should only hold what the segments changed");
+
+  printf("Pass 2: Restoring the first delta and rerunning segment 3\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  for (int i = 0; i < 3; i++)
+    rewind(checkpoints[i]);
+  checkpoint_restore(checkpoints, 2);
+  result = run_segment(3);
+  check_same(result, segment3, "segment 3 should run as it did from the restored state");
+
+  //Continuing the chain gives the same delta as the first time.
+
+  FILE *delta = tmpfile();
+  check(checkpoint_write(delta, FALSE) == 2, "the chain should continue from the restored checkpoint");
+  check(ftell(delta) == sizes[2], "the delta should be the same as the first time");
+  fclose(delta);
+
+  printf("Pass 3: Restoring the whole chain and rerunning segment 4\n");
+
+  run_segment(5);
+  for (int i = 0; i < 3; i++)
+    rewind(checkpoints[i]);
+  checkpoint_restore(checkpoints, 3);
+  result = run_segment(4);
+  check_same(result, segment4, "segment 4 should run as it did from the restored state");
+
+  printf("Pass 4: Restoring the full checkpoint alone\n");
+
+  for (int i = 0; i < 3; i++)
+    rewind(checkpoints[i]);
+  checkpoint_restore(checkpoints, 1);
+  run_segment(2);
+  result = run_segment(3);
+  check_same(result, segment3, "the full checkpoint should rebuild the same state");
+
+  for (int i = 0; i < 3; i++)
+    fclose(checkpoints[i]);
+  printf("Passed\n");
+}
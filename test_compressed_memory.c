@@ -0,0 +1,106 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "lz.h"
+#include "compressed_memory.h"
+#include "test_check.h"
+
+// We'll test with a 32MB (2^25) memory
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 25)
+
+//The cold region holds compressible data, except for its last
+//RANDOM_SIZE bytes. The hot region is then used until the cold
+//region is compressed.
+#define COLD_SIZE (1 << 23)
+#define RANDOM_SIZE (1 << 20)
+#define HOT_BASE (1 << 24)
+#define HOT_SIZE (1 << 21)
+#define HOT_SWEEPS 8
+
+#define POOL_SIZE (1 << 23)
+#define INACTIVE_EPOCHS 4
+#define EPOCH_LENGTH 32768
+
+//The compressible contents of the cold region: small records.
+uint32_t cold_value(uint32_t address)
+{
+  return (address & 0x3c) ? (address >> 6) % 100 : 0xcafe0000;
+}
+
+uint32_t random_value(uint32_t address)
+{
+  uint32_t x = address * 2654435761u;
+  x ^= x >> 15;
+  return x * 2246822519u;
+}
+
+void check_roundtrip(const uint8_t *data, uint32_t size, BOOL compressible)
+{
+  static uint8_t compressed[1 << 16], decompressed[1 << 16];
+  uint32_t compressed_size = lz_compress(data, size, compressed, compressible ? size : sizeof(compressed));
+  check(compressed_size != 0, "the data should fit");
+  check(lz_decompress(compressed, compressed_size, decompressed, sizeof(decompressed)) == size,
+        "the data should decompress to its size");
+  check(!memcmp(data, decompressed, size), "the data should decompress to itself");
+}
+
+int main()
+{
+  static uint8_t data[1 << 15], compressed[1 << 15];
+  uint32_t read_data;
+
+  printf("Pass 1: The LZ codec\n");
+
+  for (uint32_t size = 0; size < 40; size++) {
+    for (uint32_t i = 0; i < size; i++)
+      data[i] = i % 3;
+    check_roundtrip(data, size, FALSE);
+  }
+  memset(data, 0, sizeof(data));
+  check_roundtrip(data, sizeof(data), TRUE);
+  for (uint32_t i = 0; i < sizeof(data); i++)
+    data[i] = random_value(i) >> 24;
+  check_roundtrip(data, sizeof(data), FALSE);
+  check(lz_compress(data, sizeof(data), compressed, sizeof(data) * 3 / 4) == 0, "random data should not compress");
+  for (uint32_t i = 0; i < sizeof(data); i++)
+    data[i] = (i % 1000 < 700) ? random_value(i % 1000) >> 24 : 'x';
+  check_roundtrip(data, sizeof(data), TRUE);
+
+  printf("Pass 2: Compressing the cold pages\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_enable_latency_model();
+  memory_enable_compression(POOL_SIZE, INACTIVE_EPOCHS, EPOCH_LENGTH);
+  for (uint32_t address = 0; address < COLD_SIZE; address += 4) {
+    uint32_t value = (address < COLD_SIZE - RANDOM_SIZE) ? cold_value(address) : random_value(address);
+    memory_access(address, value, WRITE_ENABLE_MASK, NULL);
+  }
+  for (int sweep = 0; sweep < HOT_SWEEPS; sweep++) {
+    for (uint32_t address = HOT_BASE; address < HOT_BASE + HOT_SIZE; address += BYTES_PER_CACHE_LINE)
+      memory_access(address, sweep, WRITE_ENABLE_MASK, NULL);
+  }
+  compressed_memory_report();
+  check(compressed_memory_is_compressed(0), "the cold pages should be compressed");
+  check(!compressed_memory_is_compressed(COLD_SIZE - 1), "the random pages should not be compressed");
+  check(!compressed_memory_is_compressed(HOT_BASE), "the hot pages should not be compressed");
+  check(compressed_memory_saved() > (COLD_SIZE - RANDOM_SIZE) / 2, "compression should save more than half of the cold region");
+
+  printf("Pass 3: Reading the cold region back\n");
+
+  uint64_t cycles = memory_cycles;
+  for (uint32_t address = 0; address < COLD_SIZE; address += 4) {
+    uint32_t value = (address < COLD_SIZE - RANDOM_SIZE) ? cold_value(address) : random_value(address);
+    memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+    check(read_data == value, "the cold region should read back unchanged");
+  }
+  compressed_memory_report();
+  check(!compressed_memory_is_compressed(0), "a page read should be decompressed");
+  check(memory_cycles - cycles > (uint64_t) (COLD_SIZE - RANDOM_SIZE) / COMPRESSED_MEMORY_PAGE_SIZE * COMPRESSED_MEMORY_DECOMPRESS_LATENCY,
+        "the reads of compressed pages should take the decompression latency");
+
+  printf("Passed\n");
+}
@@ -0,0 +1,76 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "dead_block.h"
+
+// We'll test with a 16MB (2^24) memory
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 24)
+
+//A hot region that fits in the L2 cache, and a region scanned
+//through, much larger than the L2 cache.
+#define HOT_BASE 0
+#define HOT_SIZE (768 * 1024)
+#define SCAN_BASE (1 << 20)
+#define SCAN_SIZE (12 << 20)
+
+extern uint32_t num_l2_misses;
+
+//Reads a line of the hot region for every two lines of the scanned
+//region, with a clock interrupt every 8K accesses, and returns the
+//number of L2 misses.
+uint32_t run(int passes)
+{
+  uint32_t read_data;
+  uint32_t hot = 0;
+  uint32_t misses_before = num_l2_misses;
+  uint32_t num_accesses = 0;
+
+  for (int pass = 0; pass < passes; pass++) {
+    for (uint32_t scan = 0; scan < SCAN_SIZE; scan += 2 * BYTES_PER_CACHE_LINE) {
+      memory_access(SCAN_BASE + scan, 0, READ_ENABLE_MASK, &read_data);
+      memory_access(SCAN_BASE + scan + BYTES_PER_CACHE_LINE, 0, READ_ENABLE_MASK, &read_data);
+      memory_access(HOT_BASE + hot, 0, READ_ENABLE_MASK, &read_data);
+      hot = (hot + BYTES_PER_CACHE_LINE) % HOT_SIZE;
+      num_accesses += 3;
+      if ((num_accesses & 0x1fff) < 3)
+        memory_handle_clock_interrupt();
+    }
+  }
+  return num_l2_misses - misses_before;
+}
+
+int main()
+{
+  printf("Pass 1: A scan through a hot region, without dead-block prediction\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  uint32_t baseline = run(4);
+  printf("L2 misses = %u\n", baseline);
+
+  printf("Pass 2: With low-priority insertion of lines predicted dead\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_enable_dead_block(DEAD_BLOCK_LOW_PRIORITY);
+  uint32_t low_priority = run(4);
+  printf("L2 misses = %u\n", low_priority);
+  dead_block_report();
+
+  printf("Pass 3: With bypassing of lines predicted dead\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_enable_dead_block(DEAD_BLOCK_BYPASS);
+  uint32_t bypass = run(4);
+  printf("L2 misses = %u\n", bypass);
+  dead_block_report();
+
+  //The hot region should stay in L2, so that only the scan misses.
+  if ((low_priority >= baseline) || (bypass >= baseline)) {
+    printf("Error: dead-block prediction should reduce the number of L2 misses\n");
+    exit(1);
+  }
+
+  printf("Passed\n");
+}
@@ -0,0 +1,219 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "main_memory.h"
+#include "l2_cache.h"
+#include "ship.h"
+#include "filtered_trace.h"
+#include "test_check.h"
+
+// We'll test with an 8MB (2^23) memory
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 23)
+
+//The number of operations of the mixed workload, and the number of
+//passes over each array of the sweep.
+#define NUM_OPERATIONS 4000000
+#define NUM_SWEEPS 16
+
+//The number of times the sweep, and its replay, are timed; the
+//fastest time of each is kept.
+#define NUM_TIMINGS 5
+
+extern uint32_t num_l1_misses;
+extern uint32_t num_l2_misses;
+extern uint32_t num_sw_prefetch_memory_fills;
+
+double seconds()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+//Runs a mix of sequential and random reads and writes, from a few
+//PCs, with software prefetches, demotes, evicts and clock
+//interrupts.
+
+void mixed_workload()
+{
+  uint32_t state = 12345;
+  uint32_t read_data;
+  MEMORY_REQUEST_INFO info = {0, 0, MEMORY_ACCESS_DATA, 4};
+
+  for (uint32_t i = 0; i < NUM_OPERATIONS; i++) {
+    state = state * 1103515245 + 12345;
+    uint32_t random_address = (state >> 4) & (MAIN_MEMORY_SIZE_IN_BYTES - 4);
+    if (i % 4) {
+      info.pc = 0x400000 + 4 * (i % 4);
+      uint32_t address = (i * 4) & ((1 << 22) - 4);
+      memory_access_with_info(address, i, (i & 8) ? WRITE_ENABLE_MASK : READ_ENABLE_MASK, &read_data, &info);
+    }
+    else {
+      info.pc = 0x500000 + 4 * ((state >> 28) & 3);
+      memory_access_with_info(random_address, i, (state & 0x100) ? WRITE_ENABLE_MASK : READ_ENABLE_MASK,
+                              &read_data, &info);
+    }
+    if (i % 10000 == 0)
+      memory_handle_clock_interrupt();
+    if (i % 997 == 0)
+      memory_access(random_address ^ 0x1000, 0, SW_PREFETCH_L1_MASK, NULL);
+    if (i % 1009 == 0)
+      memory_access(random_address ^ 0x2000, 0, SW_PREFETCH_L2_MASK, NULL);
+    if (i % 1013 == 0)
+      memory_access(random_address, 0, DEMOTE_MASK, NULL);
+    if (i % 1019 == 0)
+      memory_access((i * 4) & ((1 << 22) - 4), 0, EVICT_MASK, NULL);
+  }
+}
+
+//The accesses of a sweep that reads, then writes, each of three
+//arrays a word at a time, the first two fitting in L1, the last in
+//L2. They are made once, so that neither the full simulation nor
+//the replay is timed with the parsing of a trace.
+
+#define NUM_SWEEP_ACCESSES (2 * NUM_SWEEPS * (((1 << 12) + (1 << 13) + (1 << 17)) / 4))
+
+uint32_t sweep_addresses[NUM_SWEEP_ACCESSES];
+uint8_t sweep_controls[NUM_SWEEP_ACCESSES];
+
+void make_sweep()
+{
+  uint32_t sizes[3] = {1 << 12, 1 << 13, 1 << 17};
+  uint32_t n = 0;
+
+  for (int array = 0; array < 3; array++) {
+    uint32_t base = array << 20;
+    for (int sweep = 0; sweep < NUM_SWEEPS; sweep++) {
+      for (uint32_t address = base; address < base + sizes[array]; address += 4) {
+        sweep_addresses[n] = address;
+        sweep_controls[n++] = READ_ENABLE_MASK;
+      }
+      for (uint32_t address = base; address < base + sizes[array]; address += 4) {
+        sweep_addresses[n] = address;
+        sweep_controls[n++] = WRITE_ENABLE_MASK;
+      }
+    }
+  }
+}
+
+void run_sweep()
+{
+  uint32_t read_data;
+  for (uint32_t i = 0; i < NUM_SWEEP_ACCESSES; i++)
+    memory_access(sweep_addresses[i], sweep_addresses[i], sweep_controls[i], &read_data);
+}
+
+//Returns a checksum of main memory and of which lines are in L2.
+
+uint32_t state_checksum()
+{
+  uint32_t checksum = 0;
+  uint32_t line[WORDS_PER_CACHE_LINE];
+
+  for (uint32_t address = 0; address < MAIN_MEMORY_SIZE_IN_BYTES; address += BYTES_PER_CACHE_LINE) {
+    main_memory_access(address, NULL, READ_ENABLE_MASK, line);
+    for (int i = 0; i < WORDS_PER_CACHE_LINE; i++)
+      checksum = checksum * 31 + line[i];
+    if (l2_probe(address))
+      checksum = checksum * 31 + address;
+  }
+  return checksum;
+}
+
+int main()
+{
+  printf("Pass 1: Recording the L1-filtered trace of a mixed workload\n");
+
+  FILE *trace = tmpfile();
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  filtered_trace_start(trace);
+  mixed_workload();
+  uint64_t events = filtered_trace_finish();
+  uint32_t l1_misses = num_l1_misses;
+  uint32_t l2_misses = num_l2_misses;
+  uint32_t memory_fills = num_sw_prefetch_memory_fills;
+  uint32_t checksum = state_checksum();
+  printf("%llu events, L1 misses = %u, L2 misses = %u\n", (unsigned long long) events, l1_misses, l2_misses);
+  check(events > l1_misses, "the trace should hold the L1 misses and more");
+  check(l2_misses > 0, "the workload should miss in L2");
+
+  printf("Pass 2: Replaying it on L2 only\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  rewind(trace);
+  check(filtered_trace_replay(trace) == events, "every event should be replayed");
+  check(num_l1_misses == l1_misses, "the replay should count the same L1 misses");
+  check(num_l2_misses == l2_misses, "the replay should have the same L2 misses");
+  check(num_sw_prefetch_memory_fills == memory_fills, "the replay should fetch the same prefetched lines");
+  check(state_checksum() == checksum, "the replay should leave L2 and main memory in the same state");
+
+  printf("Pass 3: A sweep simulated in full, then its L1-filtered trace replayed\n");
+
+  //The trace is recorded by a first run, and then read into memory,
+  //so that the runs without recording and the replays are timed
+  //without any file I/O.
+
+  FILE *sweep_trace = tmpfile();
+  make_sweep();
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  filtered_trace_start(sweep_trace);
+  run_sweep();
+  events = filtered_trace_finish();
+  long trace_size = ftell(sweep_trace);
+  char *trace_buffer = malloc(trace_size);
+  rewind(sweep_trace);
+  check(fread(trace_buffer, 1, trace_size, sweep_trace) == trace_size, "the trace should be read back");
+
+  l2_misses = num_l2_misses;
+
+  double full_seconds = 1e9;
+  double replay_seconds = 1e9;
+  for (int timing = 0; timing < NUM_TIMINGS; timing++) {
+    memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+    double start = seconds();
+    run_sweep();
+    double elapsed = seconds() - start;
+    if (elapsed < full_seconds)
+      full_seconds = elapsed;
+    check(num_l2_misses == l2_misses, "the run should have the same L2 misses without recording");
+
+    FILE *buffer_trace = fmemopen(trace_buffer, trace_size, "rb");
+    memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+    start = seconds();
+    filtered_trace_replay(buffer_trace);
+    elapsed = seconds() - start;
+    if (elapsed < replay_seconds)
+      replay_seconds = elapsed;
+    check(num_l2_misses == l2_misses, "the replay should have the same L2 misses");
+    fclose(buffer_trace);
+  }
+  printf("%u accesses: %.4f s; %llu events: %.4f s (%.1f times faster)\n",
+         NUM_SWEEP_ACCESSES, full_seconds, (unsigned long long) events, replay_seconds,
+         full_seconds / replay_seconds);
+  check(replay_seconds < full_seconds, "the replay should be faster than the full simulation");
+
+  printf("Pass 4: The mixed workload with SHiP, simulated in full and replayed\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_enable_ship(SHIP_SIGNATURE_PC);
+  mixed_workload();
+  l2_misses = num_l2_misses;
+  checksum = state_checksum();
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_enable_ship(SHIP_SIGNATURE_PC);
+  rewind(trace);
+  filtered_trace_replay(trace);
+  printf("L2 misses = %u\n", num_l2_misses);
+  check(num_l2_misses == l2_misses, "the replay with SHiP should have the same L2 misses");
+  check(state_checksum() == checksum, "the replay with SHiP should leave L2 and main memory in the same state");
+
+  fclose(trace);
+  fclose(sweep_trace);
+  free(trace_buffer);
+  printf("Passed\n");
+}
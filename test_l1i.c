@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "l1i_cache.h"
+#include "test_check.h"
+
+// We'll test with an 8MB (2^23) memory
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 23)
+
+//Pass 3: a loop over 32KB of code, with each iteration
+//reading 48KB of data.
+#define CODE_BASE 0x400000
+#define CODE_SIZE (32 * 1024)
+#define DATA_BASE 0x100000
+#define DATA_SIZE (48 * 1024)
+
+extern uint32_t num_l1_misses;
+extern uint32_t num_l2_misses;
+
+//Reads a word from the L1I, inserting its line (filled with the
+//line address) on a miss. Returns TRUE on a hit.
+BOOL fetch(uint32_t address)
+{
+  uint32_t line[WORDS_PER_CACHE_LINE];
+  uint32_t read_data;
+
+  if (l1i_cache_access(address, &read_data)) {
+    check(read_data == address / BYTES_PER_CACHE_LINE, "wrong data read from the L1I");
+    return TRUE;
+  }
+  for (int i = 0; i < WORDS_PER_CACHE_LINE; i++)
+    line[i] = address / BYTES_PER_CACHE_LINE;
+  l1i_insert_line(address, line);
+  check(l1i_cache_access(address, &read_data), "the line should be in the L1I once inserted");
+  return FALSE;
+}
+
+//Fetches every word of the code and reads every word of the data,
+//iterations times, checking the values read.
+void run(int iterations)
+{
+  MEMORY_REQUEST_INFO fetch_info = {0, 0, MEMORY_ACCESS_INSTRUCTION, 4};
+  uint32_t read_data;
+
+  for (int iteration = 0; iteration < iterations; iteration++) {
+    for (uint32_t offset = 0; offset < CODE_SIZE; offset += 4) {
+      fetch_info.pc = CODE_BASE + offset;
+      memory_access_with_info(CODE_BASE + offset, 0, READ_ENABLE_MASK, &read_data, &fetch_info);
+      check(read_data == ~offset, "wrong instruction fetched");
+      if (offset % 32 == 0) {
+        uint32_t data_offset = (offset * 3 / 2) % DATA_SIZE;
+        for (int i = 0; i < 12; i++) {
+          memory_access(DATA_BASE + data_offset + 4 * i, 0, READ_ENABLE_MASK, &read_data);
+          check(read_data == data_offset + 4 * i, "wrong data read");
+        }
+      }
+    }
+  }
+}
+
+//Writes the code and the data, writing the code back to main
+//memory since the L1I does not see the L1D.
+void write_code_and_data()
+{
+  for (uint32_t offset = 0; offset < CODE_SIZE; offset += 4)
+    memory_access(CODE_BASE + offset, ~offset, WRITE_ENABLE_MASK, NULL);
+  for (uint32_t offset = 0; offset < CODE_SIZE; offset += BYTES_PER_CACHE_LINE)
+    memory_access(CODE_BASE + offset, 0, EVICT_MASK, NULL);
+  for (uint32_t offset = 0; offset < DATA_SIZE; offset += 4)
+    memory_access(DATA_BASE + offset, offset, WRITE_ENABLE_MASK, NULL);
+}
+
+int main()
+{
+  printf("Pass 1: A 4-way LRU L1I\n");
+
+  //With 32KB and 4 lines per set, addresses 8KB apart map to the same set.
+  l1i_initialize(32 * 1024, 4, L1I_POLICY_LRU);
+  for (int i = 0; i < 4; i++)
+    check(!fetch(i * 8192), "the L1I should be empty");
+  check(fetch(0), "the line should still be in the L1I");
+  check(!fetch(4 * 8192), "a fifth line in the set should miss");
+  check(fetch(0), "the most recently used line should not be replaced");
+  check(!fetch(8192), "the least recently used line should be replaced");
+  check((l1i_accesses == 8) && (l1i_misses == 6), "the accesses and misses should be counted");
+
+  printf("Pass 2: A 4-way FIFO L1I\n");
+
+  l1i_initialize(32 * 1024, 4, L1I_POLICY_FIFO);
+  for (int i = 0; i < 4; i++)
+    fetch(i * 8192);
+  check(fetch(0), "the line should still be in the L1I");
+  check(!fetch(4 * 8192), "a fifth line in the set should miss");
+  check(!fetch(0), "the first line inserted should be replaced, although just used");
+  l1i_report();
+  l1i_enabled = FALSE;
+
+  printf("Pass 3: Code and data competing for a unified L1\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  write_code_and_data();
+  uint32_t l1_misses = num_l1_misses;
+  run(8);
+  uint32_t unified = num_l1_misses - l1_misses;
+  printf("L1 misses = %u\n", unified);
+
+  printf("Pass 4: The same, with a 32KB 4-way L1I\n");
+
+  memory_enable_split_l1(32 * 1024, 4, L1I_POLICY_LRU);
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  write_code_and_data();
+  l1_misses = num_l1_misses;
+  run(8);
+  printf("L1D misses = %u\n", num_l1_misses - l1_misses);
+  l1i_report();
+
+  //Only the first iteration misses in either cache.
+  check(l1i_misses == CODE_SIZE / BYTES_PER_CACHE_LINE, "the code should miss only once in the L1I");
+  check(num_l1_misses - l1_misses + l1i_misses < unified, "the split L1 should have fewer misses");
+
+  printf("Passed\n");
+}
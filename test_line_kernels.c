@@ -0,0 +1,103 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "memory_subsystem_constants.h"
+#include "line_kernels.h"
+#include "test_check.h"
+
+//Pass 2 copies this many lines with each version of the kernels.
+#define NUM_COPIES 20000000
+
+const char *versions[] = {"portable", "sse2", "avx2", "avx512"};
+#define NUM_VERSIONS 4
+
+//Lines at every word offset, so that the kernels are also
+//tested on lines that are not aligned.
+uint32_t buffer_a[4 * WORDS_PER_CACHE_LINE] __attribute__((aligned(BYTES_PER_CACHE_LINE)));
+uint32_t buffer_b[4 * WORDS_PER_CACHE_LINE] __attribute__((aligned(BYTES_PER_CACHE_LINE)));
+
+void test_version()
+{
+  for (int offset = 0; offset < WORDS_PER_CACHE_LINE; offset++) {
+    uint32_t *a = &buffer_a[offset];
+    uint32_t *b = &buffer_b[offset];
+
+    for (int i = 0; i < 4 * WORDS_PER_CACHE_LINE; i++) {
+      buffer_a[i] = i * 2654435761u + 1;
+      buffer_b[i] = 0xdeadbeef;
+    }
+    line_copy(b, a);
+    for (int i = 0; i < 4 * WORDS_PER_CACHE_LINE; i++) {
+      if ((i >= offset) && (i < offset + WORDS_PER_CACHE_LINE))
+        check(buffer_b[i] == buffer_a[i], "line_copy() should copy the line");
+      else
+        check(buffer_b[i] == 0xdeadbeef, "line_copy() should not write outside of the line");
+    }
+    check(line_equal(a, b), "a line should be equal to its copy");
+    check(!line_is_zero(a), "a nonzero line is not zero");
+
+    //A difference in any bit of any word is seen.
+    for (int i = 0; i < WORDS_PER_CACHE_LINE; i++) {
+      for (int bit = 0; bit < 32; bit += 31) {
+        b[i] ^= 1u << bit;
+        check(!line_equal(a, b), "lines differing in a single bit should not be equal");
+        b[i] ^= 1u << bit;
+      }
+    }
+
+    for (int i = 0; i < WORDS_PER_CACHE_LINE; i++)
+      a[i] = 0;
+    check(line_is_zero(a), "a zero line should be zero");
+    for (int i = 0; i < WORDS_PER_CACHE_LINE; i++) {
+      a[i] = 1u << 31;
+      check(!line_is_zero(a), "a line with a single bit set is not zero");
+      a[i] = 0;
+    }
+  }
+}
+
+double seconds()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+int main()
+{
+  printf("Selected at startup: %s\n", line_kernels->name);
+  const char *best = line_kernels->name;
+
+  printf("Pass 1: Testing each version of the kernels the host supports\n");
+
+  for (int v = 0; v < NUM_VERSIONS; v++) {
+    if (!line_kernels_select(versions[v])) {
+      printf("%s: not supported\n", versions[v]);
+      continue;
+    }
+    check(!strcmp(line_kernels->name, versions[v]), "the version selected should be the one asked for");
+    test_version();
+    printf("%s: correct\n", versions[v]);
+  }
+  check(!line_kernels_select("mmx"), "there is no such version");
+
+  printf("Pass 2: Copying lines between two 64-byte aligned buffers\n");
+
+  for (int v = 0; v < NUM_VERSIONS; v++) {
+    if (!line_kernels_select(versions[v]))
+      continue;
+    double start = seconds();
+    for (uint32_t i = 0; i < NUM_COPIES; i++) {
+      line_copy(&buffer_b[(i & 3) * WORDS_PER_CACHE_LINE], &buffer_a[((i + 1) & 3) * WORDS_PER_CACHE_LINE]);
+      buffer_a[i & 63] += i;
+    }
+    printf("%s: %.0f million lines per second\n", versions[v], NUM_COPIES / (seconds() - start) / 1e6);
+  }
+
+  line_kernels_select(NULL);
+  check(!strcmp(line_kernels->name, best), "the best version should be selected again");
+  printf("Passed\n");
+}
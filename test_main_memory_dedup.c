@@ -0,0 +1,128 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "main_memory.h"
+#include "checkpoint.h"
+#include "test_check.h"
+
+//A 1GB (2^30) simulated memory, deduplicated.
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 30)
+
+//A 16KB table is replicated every 4MB of memory.
+#define TABLE_SIZE (1 << 14)
+#define TABLE_STRIDE (1 << 22)
+#define NUM_COPIES (MAIN_MEMORY_SIZE_IN_BYTES / TABLE_STRIDE)
+
+//A sweep through this much memory writes everything in the caches back.
+#define SWEEP_SIZE (1 << 22)
+
+extern uint64_t main_memory_dedup_copies;
+
+//Reads SWEEP_SIZE of memory, starting at the specified address, so
+//that every line written before is in main memory.
+
+void sweep(uint32_t start)
+{
+  uint32_t read_data;
+  for (uint32_t address = 0; address < SWEEP_SIZE; address += BYTES_PER_CACHE_LINE)
+    memory_access(start + address, 0, READ_ENABLE_MASK, &read_data);
+}
+
+uint32_t table_word(uint32_t offset)
+{
+  return (offset / 4) * 2654435761u;
+}
+
+int main()
+{
+  uint32_t read_data;
+  struct rusage usage;
+
+  printf("Pass 1: Writing %d copies of a table all over a 1GB deduplicated memory\n", NUM_COPIES);
+
+  main_memory_deduplicate(TRUE);
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  check(main_memory_dedup_ratio() == MAIN_MEMORY_SIZE_IN_BYTES / BYTES_PER_CACHE_LINE,
+        "all of memory should start out as a single zero line");
+  for (uint32_t copy = 0; copy < NUM_COPIES; copy++) {
+    for (uint32_t offset = 0; offset < TABLE_SIZE; offset += 4)
+      memory_access(copy * TABLE_STRIDE + offset, table_word(offset), WRITE_ENABLE_MASK, NULL);
+  }
+  sweep(TABLE_STRIDE / 2);
+  for (uint32_t copy = 0; copy < NUM_COPIES; copy++) {
+    for (uint32_t offset = 0; offset < TABLE_SIZE; offset += 4) {
+      memory_access(copy * TABLE_STRIDE + offset, 0, READ_ENABLE_MASK, &read_data);
+      check(read_data == table_word(offset), "every copy of the table should be read back");
+    }
+  }
+  memory_access(TABLE_STRIDE + TABLE_SIZE, 0, READ_ENABLE_MASK, &read_data);
+  check(read_data == 0, "the rest of memory should be zero");
+  main_memory_report();
+
+  //The zero line and one slot per line of the table.
+  check(main_memory_dedup_ratio() == (double) (MAIN_MEMORY_SIZE_IN_BYTES / BYTES_PER_CACHE_LINE)
+                                     / (1 + TABLE_SIZE / BYTES_PER_CACHE_LINE),
+        "the copies of the table should share their lines");
+
+  printf("Pass 2: Copy on write\n");
+
+  uint64_t copies = main_memory_dedup_copies;
+  memory_access(7 * TABLE_STRIDE + 64, 0xdeadbeef, WRITE_ENABLE_MASK, NULL);
+  sweep(TABLE_STRIDE / 2);
+  check(main_memory_dedup_copies == copies + 1, "writing a shared line should copy it");
+  memory_access(7 * TABLE_STRIDE + 64, 0, READ_ENABLE_MASK, &read_data);
+  check(read_data == 0xdeadbeef, "the line written should have the new contents");
+  for (uint32_t copy = 6; copy <= 8; copy += 2) {
+    memory_access(copy * TABLE_STRIDE + 64, 0, READ_ENABLE_MASK, &read_data);
+    check(read_data == table_word(64), "the other copies of the line should be unchanged");
+  }
+
+  //Writing the original contents back shares the line again.
+  memory_access(7 * TABLE_STRIDE + 64, table_word(64), WRITE_ENABLE_MASK, NULL);
+  sweep(TABLE_STRIDE / 2);
+  check(main_memory_dedup_ratio() == (double) (MAIN_MEMORY_SIZE_IN_BYTES / BYTES_PER_CACHE_LINE)
+                                     / (1 + TABLE_SIZE / BYTES_PER_CACHE_LINE),
+        "the private copy should be freed when it matches the others again");
+
+  printf("Pass 3: Host memory\n");
+
+  getrusage(RUSAGE_SELF, &usage);
+  printf("Peak resident size: %ld KB\n", usage.ru_maxrss);
+  check(usage.ru_maxrss < (MAIN_MEMORY_SIZE_IN_BYTES >> 10) / 8, "only the distinct lines should take up host memory");
+
+  printf("Pass 4: Checkpoint and restore\n");
+
+  FILE *checkpoint = tmpfile();
+  checkpoint_write(checkpoint, TRUE);
+  for (uint32_t offset = 0; offset < TABLE_SIZE; offset += 4)
+    memory_access(3 * TABLE_STRIDE + offset, ~table_word(offset), WRITE_ENABLE_MASK, NULL);
+  memory_access(5 * TABLE_STRIDE + TABLE_SIZE, 1, WRITE_ENABLE_MASK, NULL);
+  sweep(TABLE_STRIDE / 2);
+  rewind(checkpoint);
+  checkpoint_restore(&checkpoint, 1);
+  for (uint32_t offset = 0; offset < TABLE_SIZE; offset += 4) {
+    memory_access(3 * TABLE_STRIDE + offset, 0, READ_ENABLE_MASK, &read_data);
+    check(read_data == table_word(offset), "the table should be restored");
+  }
+  memory_access(5 * TABLE_STRIDE + TABLE_SIZE, 0, READ_ENABLE_MASK, &read_data);
+  check(read_data == 0, "the words written after the checkpoint should be gone");
+  check(main_memory_dedup_ratio() == (double) (MAIN_MEMORY_SIZE_IN_BYTES / BYTES_PER_CACHE_LINE)
+                                     / (1 + TABLE_SIZE / BYTES_PER_CACHE_LINE),
+        "the restored memory should be deduplicated again");
+  fclose(checkpoint);
+
+  printf("Pass 5: Back to allocated memory\n");
+
+  main_memory_deduplicate(FALSE);
+  memory_subsystem_initialize(1 << 23);
+  memory_access(0, 1, WRITE_ENABLE_MASK, NULL);
+  memory_access(0, 0, READ_ENABLE_MASK, &read_data);
+  check(read_data == 1, "allocated memory should still work");
+  check(main_memory_dedup_ratio() == 1.0, "allocated memory should not be deduplicated");
+
+  printf("Passed\n");
+}
@@ -0,0 +1,96 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "main_memory.h"
+#include "test_check.h"
+
+//A 1GB (2^30) simulated memory, backed by a sparse file.
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 30)
+
+//The image preloaded in pass 3.
+#define IMAGE_SIZE_IN_BYTES (1 << 18)
+
+//Pass 4 reads this much of memory sequentially.
+#define SEQUENTIAL_SIZE (1 << 23)
+
+int main()
+{
+  char path[64], image_path[64];
+  uint32_t read_data;
+  struct stat st;
+
+  sprintf(path, "/tmp/test_main_memory_file.%d", (int) getpid());
+  sprintf(image_path, "/tmp/test_main_memory_image.%d", (int) getpid());
+
+  printf("Pass 1: Writing all over a 1GB file-backed memory\n");
+
+  main_memory_use_file(path, NULL);
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  check(stat(path, &st) == 0, "the memory file should have been created");
+  check(st.st_size == MAIN_MEMORY_SIZE_IN_BYTES, "the memory file should be the size of main memory");
+
+  //One word every 1MB, at a different offset each time, then
+  //enough of a sweep to write them all back to memory.
+
+  for (uint32_t address = 0; address < MAIN_MEMORY_SIZE_IN_BYTES; address += 1 << 20)
+    memory_access(address + ((address >> 14) & 0xffc), address ^ 0x5a5a5a5a, WRITE_ENABLE_MASK, NULL);
+  for (uint32_t address = 0; address < (1 << 22); address += BYTES_PER_CACHE_LINE)
+    memory_access(MAIN_MEMORY_SIZE_IN_BYTES - (1 << 22) + address, 0, READ_ENABLE_MASK, &read_data);
+  for (uint32_t address = 0; address < MAIN_MEMORY_SIZE_IN_BYTES; address += 1 << 20) {
+    memory_access(address + ((address >> 14) & 0xffc), 0, READ_ENABLE_MASK, &read_data);
+    check(read_data == (address ^ 0x5a5a5a5a), "the words written should be read back");
+  }
+
+  printf("Pass 2: The memory file is sparse\n");
+
+  stat(path, &st);
+  printf("%lld KB of the memory file on disk\n", (long long) st.st_blocks / 2);
+  check((uint64_t) st.st_blocks * 512 < MAIN_MEMORY_SIZE_IN_BYTES / 16, "only the pages written should take up disk space");
+  main_memory_report();
+
+  printf("Pass 3: Preloading a memory image\n");
+
+  FILE *image = fopen(image_path, "wb");
+  for (uint32_t word = 0; word < IMAGE_SIZE_IN_BYTES / 4; word++) {
+    uint32_t value = word * 2654435761u;
+    fwrite(&value, 4, 1, image);
+  }
+  fclose(image);
+  main_memory_use_file(path, image_path);
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  for (uint32_t address = 0; address < 2 * IMAGE_SIZE_IN_BYTES; address += 4) {
+    memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+    if (address < IMAGE_SIZE_IN_BYTES)
+      check(read_data == (address / 4) * 2654435761u, "main memory should start with the image");
+    else
+      check(read_data == 0, "main memory should be zero beyond the image");
+  }
+  memory_access(1 << 29, 0, READ_ENABLE_MASK, &read_data);
+  check(read_data == 0, "the previous contents of the file should be gone");
+
+  printf("Pass 4: A sequential phase\n");
+
+  main_memory_advise(MAIN_MEMORY_ADVICE_SEQUENTIAL);
+  for (uint32_t address = 0; address < SEQUENTIAL_SIZE; address += 4)
+    memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+  main_memory_advise(MAIN_MEMORY_ADVICE_RANDOM);
+  main_memory_report();
+
+  printf("Pass 5: Back to allocated memory\n");
+
+  main_memory_use_file(NULL, NULL);
+  memory_subsystem_initialize(1 << 23);
+  memory_access(0, 1, WRITE_ENABLE_MASK, NULL);
+  memory_access(0, 0, READ_ENABLE_MASK, &read_data);
+  check(read_data == 1, "allocated memory should still work");
+  main_memory_report();
+
+  unlink(path);
+  unlink(image_path);
+  printf("Passed\n");
+}
@@ -0,0 +1,95 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "memory_channels.h"
+#include "prefetch.h"
+#include "stream_prefetcher.h"
+#include "test_check.h"
+
+// We'll test with a 32MB (2^25) memory
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 25)
+
+#define NUM_CHANNELS 4
+
+//The streams read this much of memory.
+#define STREAM_SIZE (1 << 23)
+
+//A stride of a page per channel.
+#define STRIDE (NUM_CHANNELS * MEMORY_CHANNEL_PAGE_SIZE)
+
+extern uint32_t num_l2_misses;
+
+//Reads STREAM_SIZE bytes sequentially, a word per cache line,
+//with the stream prefetcher, and returns the cycles it took.
+uint64_t run_stream(uint8_t interleave)
+{
+  uint32_t read_data;
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_enable_prefetching();
+  prefetch_attach(&stream_prefetcher);
+  memory_enable_channels(NUM_CHANNELS, interleave);
+  for (uint32_t address = 0; address < STREAM_SIZE; address += BYTES_PER_CACHE_LINE)
+    memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+  printf("Cycles = %llu\n", (unsigned long long) memory_cycles);
+  memory_channels_report(memory_cycles);
+  return memory_cycles;
+}
+
+//Reads and writes a word every STRIDE bytes, and returns the
+//imbalance of the channels.
+double run_strided(uint8_t interleave)
+{
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_enable_channels(NUM_CHANNELS, interleave);
+  for (int pass = 0; pass < 2; pass++) {
+    for (uint32_t address = 0; address < MAIN_MEMORY_SIZE_IN_BYTES; address += STRIDE)
+      memory_access(address + (address >> 12 & 0xfc0), address, WRITE_ENABLE_MASK, NULL);
+  }
+  memory_channels_report(memory_cycles);
+  return memory_channels_imbalance();
+}
+
+int main()
+{
+  printf("Pass 1: Interleaving functions\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_enable_channels(NUM_CHANNELS, MEMORY_INTERLEAVE_LINE);
+  for (uint32_t line = 0; line < 64; line++)
+    check(memory_channel_of(line * BYTES_PER_CACHE_LINE) == line % NUM_CHANNELS, "consecutive lines should go to consecutive channels");
+  memory_enable_channels(NUM_CHANNELS, MEMORY_INTERLEAVE_PAGE);
+  for (uint32_t address = 0; address < 16 * MEMORY_CHANNEL_PAGE_SIZE; address += BYTES_PER_CACHE_LINE)
+    check(memory_channel_of(address) == (address / MEMORY_CHANNEL_PAGE_SIZE) % NUM_CHANNELS, "a page should be in a single channel");
+  memory_enable_channels(NUM_CHANNELS, MEMORY_INTERLEAVE_XOR);
+  uint32_t used[NUM_CHANNELS] = {0};
+  for (uint32_t address = 0; address < 64 * STRIDE; address += STRIDE)
+    used[memory_channel_of(address)]++;
+  for (int channel = 0; channel < NUM_CHANNELS; channel++)
+    check(used[channel] == 16, "XOR interleaving should spread a page-multiple stride evenly");
+
+  printf("Pass 2: A prefetched stream, page interleaving\n");
+
+  uint64_t page_cycles = run_stream(MEMORY_INTERLEAVE_PAGE);
+
+  printf("Pass 3: The same, line interleaving\n");
+
+  uint64_t line_cycles = run_stream(MEMORY_INTERLEAVE_LINE);
+  printf("Line interleaving takes %.2f%% fewer cycles\n", 100.0 * (page_cycles - line_cycles) / page_cycles);
+  check(line_cycles < page_cycles, "the prefetches should be served in parallel with line interleaving");
+
+  printf("Pass 4: A strided stream, page interleaving\n");
+
+  double page_imbalance = run_strided(MEMORY_INTERLEAVE_PAGE);
+  check(page_imbalance > NUM_CHANNELS - 0.01, "a page-multiple stride should go to a single channel");
+
+  printf("Pass 5: The same, XOR interleaving\n");
+
+  double xor_imbalance = run_strided(MEMORY_INTERLEAVE_XOR);
+  check(xor_imbalance < 1.1, "XOR interleaving should balance the channels");
+
+  printf("Passed\n");
+}
@@ -0,0 +1,135 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "memory_fork.h"
+#include "main_memory.h"
+#include "ship.h"
+#include "test_check.h"
+
+// We'll test with an 8MB (2^23) memory
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 23)
+
+//The warmed region fits in L1.
+#define WARM_SIZE (32 * 1024)
+
+extern uint32_t num_l1_misses;
+extern uint32_t num_l2_misses;
+
+//Branch 0 rereads the warmed region, branch 1 overwrites it and
+//branch 2 reads another region with SHiP enabled. Branch 3 fails.
+void branch(int branch_number)
+{
+  uint32_t read_data;
+  uint32_t l1_misses = num_l1_misses;
+  uint32_t l2_misses = num_l2_misses;
+
+  switch (branch_number) {
+  case 0:
+    for (uint32_t address = 0; address < WARM_SIZE; address += 4) {
+      memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+      check(read_data == address, "the branch should see the warmed memory");
+    }
+    break;
+  case 1:
+    for (uint32_t address = 0; address < WARM_SIZE; address += 4)
+      memory_access(address, 0xdead, WRITE_ENABLE_MASK, NULL);
+    break;
+  case 2:
+    memory_enable_ship(SHIP_SIGNATURE_MEMORY);
+    for (uint32_t address = 1 << 22; address < (1 << 22) + (1 << 21); address += 4)
+      memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+    break;
+  default:
+    check(FALSE, "branch 3 fails on purpose");
+  }
+  printf("L1 misses = %u, L2 misses = %u\n", num_l1_misses - l1_misses, num_l2_misses - l2_misses);
+  if (branch_number == 2)
+    ship_report();
+}
+
+//Each branch writes its own value to the first line of main memory.
+void write_branch(int branch_number)
+{
+  uint32_t line[WORDS_PER_CACHE_LINE];
+  uint32_t read_line[WORDS_PER_CACHE_LINE];
+
+  for (int i = 0; i < WORDS_PER_CACHE_LINE; i++)
+    line[i] = 0xb0 + branch_number;
+  main_memory_access(0, line, WRITE_ENABLE_MASK, NULL);
+  main_memory_access(0, NULL, READ_ENABLE_MASK, read_line);
+  check(read_line[0] == line[0], "the branch should see its own write");
+}
+
+int main()
+{
+  uint32_t read_data;
+
+  printf("Pass 1: Warming up the memory subsystem\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  for (uint32_t address = 0; address < WARM_SIZE; address += 4)
+    memory_access(address, address, WRITE_ENABLE_MASK, NULL);
+  uint32_t l1_misses = num_l1_misses;
+  uint32_t l2_misses = num_l2_misses;
+
+  printf("Pass 2: Forking four branches from the warmed state\n");
+
+  FILE *report = tmpfile();
+  int failed = memory_fork(4, branch, report);
+  check(failed == 1, "exactly one branch should have failed");
+
+  //The report has each branch's output, in order.
+  char line[256];
+  int branches = 0;
+  BOOL warm_hits = FALSE, ship = FALSE, failure = FALSE;
+  rewind(report);
+  while (fgets(line, sizeof(line), report)) {
+    fputs(line, stdout);
+    if (!strncmp(line, "=== Branch", 10))
+      branches++;
+    if ((branches == 1) && !strcmp(line, "L1 misses = 0, L2 misses = 0\n"))
+      warm_hits = TRUE;
+    if ((branches == 3) && !strncmp(line, "SHiP", 4))
+      ship = TRUE;
+    if ((branches == 4) && strstr(line, "on purpose"))
+      failure = TRUE;
+  }
+  fclose(report);
+  check(branches == 4, "the report should have a section per branch");
+  check(warm_hits, "branch 0 should hit in the warmed L1 and L2");
+  check(ship, "branch 2 should report on SHiP");
+  check(failure, "the error of branch 3 should be in the report");
+
+  printf("Pass 3: The branches did not change the parent\n");
+
+  check((num_l1_misses == l1_misses) && (num_l2_misses == l2_misses), "the parent's counters should not change");
+  check(!ship_enabled, "SHiP should not be enabled in the parent");
+  for (uint32_t address = 0; address < WARM_SIZE; address += 4) {
+    memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+    check(read_data == address, "the parent's memory should not change");
+  }
+  check(num_l1_misses == l1_misses, "the parent's L1 should not change");
+
+  printf("Pass 4: Branches writing a file-backed main memory\n");
+
+  char path[64];
+  uint32_t first_line[WORDS_PER_CACHE_LINE];
+  sprintf(path, "/tmp/test_memory_fork.%d", (int) getpid());
+  main_memory_use_file(path, NULL);
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  report = tmpfile();
+  check(memory_fork(2, write_branch, report) == 0, "the branches should not fail");
+  fclose(report);
+  main_memory_access(0, NULL, READ_ENABLE_MASK, first_line);
+  check(first_line[0] == 0, "the branches should not write the parent's file-backed memory");
+  main_memory_use_file(NULL, NULL);
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  unlink(path);
+
+  printf("Passed\n");
+}
@@ -3,6 +3,7 @@
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
+#include <time.h>
 
 #include "memory_subsystem_constants.h"
 #include "memory_subsystem.h"
@@ -48,6 +49,9 @@ int main()
 
   uint32_t read_data;
 
+  //Pass 2 is mostly L1 hits, so its speed is that of the L1 hit path.
+  clock_t start_time = clock();
+
   for(address = 0; address < MAIN_MEMORY_SIZE_IN_BYTES; address+=4) {
     memory_access(address, 0, READ_ENABLE_MASK, &read_data);
     num_memory_accesses++;
@@ -62,6 +66,8 @@ int main()
   printf("In Pass 2, number of memory accesses = %d\n", num_memory_accesses);
   printf("In Pass 2, number of L1 misses = %d\n", num_l1_misses);
   printf("In Pass 2, number of L2 misses = %d\n", num_l2_misses);
+  printf("In Pass 2, simulated accesses per second = %.0f\n",
+	 num_memory_accesses / ((double) (clock() - start_time) / CLOCKS_PER_SEC));
 
   printf("Pass 3: Randomly reading and writing words in memory (poor cache performance)\n");
 
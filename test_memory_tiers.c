@@ -0,0 +1,89 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "memory_tiers.h"
+#include "test_check.h"
+
+// We'll test with a 32MB (2^25) memory
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 25)
+
+//A 1MB fast tier.
+#define FAST_SIZE (1 << 20)
+
+//The start of the cold region is touched first, so that it fills
+//the fast tier. The hot region then gets most of the L2 misses.
+#define COLD_SIZE (1 << 24)
+#define HOT_BASE (1 << 24)
+#define HOT_SIZE (1 << 19)
+
+#define ROUNDS 8
+#define COLD_READS_PER_ROUND 16384
+
+#define THRESHOLD 8
+#define EPOCH_LENGTH 4096
+
+typedef struct {
+  double fast_fraction;
+  uint64_t cycles;
+} TIER_RESULT;
+
+TIER_RESULT run(uint8_t policy)
+{
+  uint32_t read_data;
+  uint32_t seed = 1;
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_enable_tiers(FAST_SIZE, policy, THRESHOLD, EPOCH_LENGTH);
+  for (uint32_t address = 0; address < FAST_SIZE; address += BYTES_PER_CACHE_LINE)
+    memory_access(address, address, WRITE_ENABLE_MASK, NULL);
+
+  //Each round reads the hot region once, then random lines of the
+  //cold region, which push the hot region out of the L2 cache.
+
+  for (int round = 0; round < ROUNDS; round++) {
+    for (uint32_t address = HOT_BASE; address < HOT_BASE + HOT_SIZE; address += BYTES_PER_CACHE_LINE)
+      memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+    for (int i = 0; i < COLD_READS_PER_ROUND; i++) {
+      seed = seed * 1103515245 + 12345;
+      memory_access((seed >> 4) % COLD_SIZE & ~0x3f, 0, READ_ENABLE_MASK, &read_data);
+    }
+  }
+  printf("Cycles = %llu\n", (unsigned long long) memory_cycles);
+  memory_tiers_report();
+  TIER_RESULT result = {memory_tiers_fast_fraction(), memory_cycles};
+  return result;
+}
+
+int main()
+{
+  printf("Pass 1: No migration\n");
+
+  TIER_RESULT none = run(MEMORY_TIER_POLICY_NONE);
+  check(memory_tier_of(0) == MEMORY_TIER_FAST, "the first pages touched should be placed in the fast tier");
+  check(memory_tier_of(FAST_SIZE) == MEMORY_TIER_SLOW, "the rest should be placed in the slow tier");
+  check(memory_tier_of(HOT_BASE) == MEMORY_TIER_SLOW, "the hot pages should stay in the slow tier");
+
+  printf("Pass 2: Threshold promotion\n");
+
+  TIER_RESULT threshold = run(MEMORY_TIER_POLICY_THRESHOLD);
+  check(memory_tier_of(HOT_BASE) == MEMORY_TIER_FAST, "the hot pages should have been promoted");
+  check(threshold.fast_fraction > none.fast_fraction + 0.1, "more reads should be served by the fast tier");
+  check(threshold.cycles < none.cycles, "promoting the hot pages should save cycles");
+
+  printf("Pass 3: Epoch-based promotion\n");
+
+  TIER_RESULT epoch = run(MEMORY_TIER_POLICY_EPOCH);
+  check(epoch.fast_fraction > none.fast_fraction + 0.1, "more reads should be served by the fast tier");
+  check(epoch.cycles < none.cycles, "promoting the hot pages should save cycles");
+
+  printf("Pass 4: LRU promotion\n");
+
+  TIER_RESULT lru = run(MEMORY_TIER_POLICY_LRU);
+  check(lru.fast_fraction > threshold.fast_fraction, "every read of a slow page should promote it");
+  check(lru.cycles > threshold.cycles, "promoting the cold pages too should cost more in migration traffic");
+
+  printf("Passed\n");
+}
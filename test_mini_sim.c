@@ -0,0 +1,152 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <math.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "dead_block.h"
+#include "mini_sim.h"
+
+#define KB (1 << 10)
+#define MB (1 << 20)
+
+extern uint32_t num_l2_misses;
+
+int main()
+{
+  uint32_t address;
+  uint32_t i;
+  double ratio, std_error;
+
+  printf("Pass 1: Reading a region that fits in the cache twice\n");
+
+  mini_sim_initialize();
+  int fits = mini_sim_add_config(64*KB, 4, MINI_SIM_POLICY_LRU, 1, MINI_SIM_LEVEL_L2);
+
+  for (i = 0; i < 2; i++)
+    for (address = 0; address < 32*KB; address += BYTES_PER_CACHE_LINE)
+      mini_sim_access(address, READ_ENABLE_MASK, MINI_SIM_LEVEL_L2, TRUE);
+
+  //only the first pass should miss
+  ratio = mini_sim_get_miss_ratio(fits, &std_error);
+  if (ratio != 0.5) {
+    printf("Error: miss ratio should be 0.5, is %f\n", ratio);
+    exit(1);
+  }
+
+  printf("Pass 2: Cycling through a region twice the size of an LRU cache\n");
+
+  mini_sim_initialize();
+  int thrash = mini_sim_add_config(64*KB, 4, MINI_SIM_POLICY_LRU, 1, MINI_SIM_LEVEL_L2);
+
+  for (i = 0; i < 4; i++)
+    for (address = 0; address < 128*KB; address += BYTES_PER_CACHE_LINE)
+      mini_sim_access(address, READ_ENABLE_MASK, MINI_SIM_LEVEL_L2, TRUE);
+
+  ratio = mini_sim_get_miss_ratio(thrash, &std_error);
+  if (ratio != 1.0) {
+    printf("Error: every access should miss, miss ratio is %f\n", ratio);
+    exit(1);
+  }
+
+  printf("Pass 3: Comparing sampled and full simulations of random accesses\n");
+
+  mini_sim_initialize();
+  int full = mini_sim_add_config(1*MB, 4, MINI_SIM_POLICY_NRU, 1, MINI_SIM_LEVEL_L2);
+  int sampled = mini_sim_add_config(1*MB, 4, MINI_SIM_POLICY_NRU, 16, MINI_SIM_LEVEL_L2);
+  int full_lru = mini_sim_add_config(1*MB, 4, MINI_SIM_POLICY_LRU, 1, MINI_SIM_LEVEL_L2);
+  int sampled_lru = mini_sim_add_config(1*MB, 4, MINI_SIM_POLICY_LRU, 16, MINI_SIM_LEVEL_L2);
+
+  srand(1357);
+  for (i = 1; i <= (1 << 21); i++) {
+    //90% of the accesses go to a 512KB hot region, the rest to 4MB
+    if (rand() % 10)
+      address = (rand() % (512*KB)) & ~0x3;
+    else
+      address = (rand() % (4*MB)) & ~0x3;
+    mini_sim_access(address, (rand() % 4) ? READ_ENABLE_MASK : WRITE_ENABLE_MASK, MINI_SIM_LEVEL_L2, TRUE);
+    if (!(i & 0x1fff))
+      mini_sim_clear_r_bits();
+  }
+
+  mini_sim_report();
+
+  int pairs[2][2] = {{full, sampled}, {full_lru, sampled_lru}};
+  for (i = 0; i < 2; i++) {
+    double full_ratio = mini_sim_get_miss_ratio(pairs[i][0], &std_error);
+    ratio = mini_sim_get_miss_ratio(pairs[i][1], &std_error);
+    if ((std_error <= 0.0) || (fabs(ratio - full_ratio) > 4 * std_error)) {
+      printf("Error: sampled miss ratio %f +/- %f is too far from the full miss ratio %f\n",
+	     ratio, std_error, full_ratio);
+      exit(1);
+    }
+  }
+
+  printf("Pass 4: An L3 configuration only sees the accesses that leave L2\n");
+
+  mini_sim_initialize();
+  int l2 = mini_sim_add_config(64*KB, 4, MINI_SIM_POLICY_LRU, 1, MINI_SIM_LEVEL_L2);
+  int l3 = mini_sim_add_config(1*MB, 8, MINI_SIM_POLICY_LRU, 1, MINI_SIM_LEVEL_L3);
+
+  //A 512KB region is read twice from L2, missing every time, and
+  //so twice from L3, which it fits in.
+  for (i = 0; i < 2; i++) {
+    for (address = 0; address < 512*KB; address += 64) {
+      mini_sim_access(address, READ_ENABLE_MASK, MINI_SIM_LEVEL_L2, TRUE);
+      mini_sim_access(address, READ_ENABLE_MASK, MINI_SIM_LEVEL_L3, TRUE);
+    }
+  }
+  //A 32KB region is read 8 times from L2, missing only the first
+  //time, so L3 sees it once, and misses.
+  for (i = 0; i < 8; i++) {
+    for (address = 1*MB; address < 1*MB + 32*KB; address += 64) {
+      mini_sim_access(address, READ_ENABLE_MASK, MINI_SIM_LEVEL_L2, TRUE);
+      if (i == 0)
+        mini_sim_access(address, READ_ENABLE_MASK, MINI_SIM_LEVEL_L3, TRUE);
+    }
+  }
+
+  mini_sim_report();
+  double l2_ratio = mini_sim_get_miss_ratio(l2, &std_error);
+  double l3_ratio = mini_sim_get_miss_ratio(l3, &std_error);
+  //L2: 16896 misses of 20480 accesses. L3: 8704 misses of 16896.
+  if ((fabs(l2_ratio - 16896.0 / 20480) > 0.0001) || (fabs(l3_ratio - 8704.0 / 16896) > 0.0001)) {
+    printf("Error: L2 and L3 miss ratios are %f and %f\n", l2_ratio, l3_ratio);
+    exit(1);
+  }
+
+  printf("Pass 5: An L3 configuration behind L2, with lines bypassing L2\n");
+
+  //A scan through 12MB, with a line of a 768KB hot region read for
+  //every two lines scanned, as in test_dead_block, with the lines
+  //predicted dead read around L2. A 16MB L3 holds all of the lines,
+  //so it should miss once per line, out of one read per L2 miss.
+
+  memory_subsystem_initialize(16*MB);
+  memory_enable_dead_block(DEAD_BLOCK_BYPASS);
+  mini_sim_initialize();
+  l3 = mini_sim_add_config(16*MB, 16, MINI_SIM_POLICY_LRU, 1, MINI_SIM_LEVEL_L3);
+  uint32_t read_data;
+  uint32_t hot = 0;
+  for (i = 0; i < 4; i++) {
+    for (address = 0; address < 12*MB; address += 128) {
+      memory_access(1*MB + address, 0, READ_ENABLE_MASK, &read_data);
+      memory_access(1*MB + address + 64, 0, READ_ENABLE_MASK, &read_data);
+      memory_access(hot, 0, READ_ENABLE_MASK, &read_data);
+      hot = (hot + 64) % (768*KB);
+      if (!(address & 0x3ffff))
+        memory_handle_clock_interrupt();
+    }
+  }
+  mini_sim_report();
+  dead_block_report();
+  l3_ratio = mini_sim_get_miss_ratio(l3, &std_error);
+  if (fabs(l3_ratio * num_l2_misses - (12*MB + 768*KB) / 64) > 0.5) {
+    printf("Error: L3 miss ratio %f should be %u misses out of %u L2 misses\n",
+           l3_ratio, (12*MB + 768*KB) / 64, num_l2_misses);
+    exit(1);
+  }
+
+  printf("Passed\n");
+}
@@ -0,0 +1,110 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "page_map.h"
+
+// We'll test with a 32MB (2^25) memory, so 8K 4KB frames
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 25)
+#define NUM_FRAMES (MAIN_MEMORY_SIZE_IN_BYTES >> PAGE_MAP_4K_PAGE_SHIFT)
+#define NUM_COLORS 64
+#define PAGE_SIZE (1 << PAGE_MAP_4K_PAGE_SHIFT)
+
+int main()
+{
+  uint32_t i, physical, frame;
+  static uint8_t frame_used[NUM_FRAMES];
+
+  printf("Pass 1: Sequential allocation in order of first touch\n");
+
+  page_map_initialize(MAIN_MEMORY_SIZE_IN_BYTES, PAGE_MAP_4K_PAGE_SHIFT, PAGE_MAP_SEQUENTIAL, NUM_COLORS, 1);
+
+  //touch pages far apart in the virtual address space, in reverse order
+  for (i = 0; i < 100; i++) {
+    physical = page_map_translate(0xf0000000 - i * 0x100000 + 0x123);
+    if (physical != i * PAGE_SIZE + 0x123) {
+      printf("Error: page %u should be mapped to physical address %u, is %u\n", i, i * PAGE_SIZE + 0x123, physical);
+      exit(1);
+    }
+  }
+
+  //translations are stable, whether or not they hit in the translation cache
+  for (i = 0; i < 100; i++) {
+    physical = page_map_translate(0xf0000000 - i * 0x100000 + 0x44);
+    if (physical != i * PAGE_SIZE + 0x44) {
+      printf("Error: translation of page %u changed\n", i);
+      exit(1);
+    }
+  }
+
+  printf("Pass 2: Random allocation uses every frame exactly once\n");
+
+  page_map_initialize(MAIN_MEMORY_SIZE_IN_BYTES, PAGE_MAP_4K_PAGE_SHIFT, PAGE_MAP_RANDOM, NUM_COLORS, 12345);
+
+  uint32_t in_order = 0;
+  for (i = 0; i < NUM_FRAMES; i++) {
+    frame = page_map_translate(i * PAGE_SIZE) / PAGE_SIZE;
+    if (frame_used[frame]) {
+      printf("Error: frame %u was allocated twice\n", frame);
+      exit(1);
+    }
+    frame_used[frame] = 1;
+    if (frame == i)
+      in_order++;
+  }
+  if (in_order > NUM_FRAMES / 16) {
+    printf("Error: random allocation left %u of %u frames in order\n", in_order, NUM_FRAMES);
+    exit(1);
+  }
+
+  printf("Pass 3: Page coloring preserves the color of each page\n");
+
+  page_map_initialize(MAIN_MEMORY_SIZE_IN_BYTES, PAGE_MAP_4K_PAGE_SHIFT, PAGE_MAP_PAGE_COLORING, NUM_COLORS, 1);
+
+  srand(4321);
+  for (i = 0; i < NUM_FRAMES / 2; i++) {
+    uint32_t vpn = rand() % (1 << 20);
+    frame = page_map_translate(vpn * PAGE_SIZE) / PAGE_SIZE;
+    if ((frame % NUM_COLORS) != (vpn % NUM_COLORS)) {
+      //allowed only when the color ran out of frames
+      if (i < NUM_FRAMES / 4) {
+	printf("Error: virtual page %u of color %u mapped to frame %u of color %u\n",
+	       vpn, vpn % NUM_COLORS, frame, frame % NUM_COLORS);
+	exit(1);
+      }
+    }
+  }
+
+  printf("Pass 4: Bin hopping gives successive faults successive colors\n");
+
+  page_map_initialize(MAIN_MEMORY_SIZE_IN_BYTES, PAGE_MAP_4K_PAGE_SHIFT, PAGE_MAP_BIN_HOPPING, NUM_COLORS, 1);
+
+  for (i = 0; i < 3 * NUM_COLORS; i++) {
+    //all virtual pages of the same color
+    frame = page_map_translate(i * NUM_COLORS * PAGE_SIZE) / PAGE_SIZE;
+    if (frame % NUM_COLORS != i % NUM_COLORS) {
+      printf("Error: fault %u should get a frame of color %u, got color %u\n", i, i % NUM_COLORS, frame % NUM_COLORS);
+      exit(1);
+    }
+  }
+
+  printf("Pass 5: 2MB pages\n");
+
+  page_map_initialize(MAIN_MEMORY_SIZE_IN_BYTES, PAGE_MAP_2M_PAGE_SHIFT, PAGE_MAP_SEQUENTIAL, 1, 1);
+
+  physical = page_map_translate(0x40000000 + 0x1abcde);
+  if (physical != 0x1abcde) {
+    printf("Error: first 2MB page should map to frame 0, address is %u\n", physical);
+    exit(1);
+  }
+  physical = page_map_translate(0x80000000 + 0x1abcde);
+  if (physical != (1 << PAGE_MAP_2M_PAGE_SHIFT) + 0x1abcde) {
+    printf("Error: second 2MB page should map to frame 1, address is %u\n", physical);
+    exit(1);
+  }
+
+  page_map_report();
+
+  printf("Passed\n");
+}
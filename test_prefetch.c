@@ -0,0 +1,247 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "l2_cache.h"
+#include "checkpoint.h"
+#include "prefetch.h"
+#include "stream_prefetcher.h"
+#include "sms_prefetcher.h"
+#include "temporal_prefetcher.h"
+
+// We'll test with an 8MB (2^23) memory, 8 times the size of the L2 cache
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 23)
+
+extern uint32_t num_l2_misses;
+
+//Reads every word of memory in order.
+void read_sequentially()
+{
+  uint32_t read_data;
+  for (uint32_t address = 0; address < MAIN_MEMORY_SIZE_IN_BYTES; address += 4) {
+    memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+    if (read_data != address >> 2) {
+      printf("Error: Address %x should contain %x, contains %x\n", address, address >> 2, read_data);
+      exit(1);
+    }
+  }
+}
+
+//Reads pairs of consecutive cache lines at random, which trains the
+//stream prefetcher but makes all of its prefetches useless.
+void read_random_pairs(uint32_t num_pairs)
+{
+  uint32_t read_data;
+  srand(81);
+  for (uint32_t i = 0; i < num_pairs; i++) {
+    uint32_t address = (rand() % (MAIN_MEMORY_SIZE_IN_BYTES / BYTES_PER_CACHE_LINE - 1)) * BYTES_PER_CACHE_LINE;
+    memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+    memory_access(address + BYTES_PER_CACHE_LINE, 0, READ_ENABLE_MASK, &read_data);
+  }
+}
+
+//Reads the same sparse set of lines in every spatial region, as when
+//visiting the same fields of a large record. Returns the number of
+//L2 misses.
+uint32_t read_records()
+{
+  static const uint32_t fields[] = {0, 3, 7, 12, 20, 21};
+  uint32_t read_data;
+  uint32_t misses_before = num_l2_misses;
+  for (uint32_t region = 0; region < MAIN_MEMORY_SIZE_IN_BYTES; region += 1 << SMS_REGION_SHIFT) {
+    for (int i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+      memory_access(region + fields[i] * BYTES_PER_CACHE_LINE, 0, READ_ENABLE_MASK, &read_data);
+  }
+  return num_l2_misses - misses_before;
+}
+
+//Builds a linked list through LIST_NODES cache lines in random
+//order (twice the size of the L2 cache), with the address of the
+//next node in the first word of each node.
+#define LIST_NODES (1 << 15)
+
+uint32_t build_list()
+{
+  uint32_t num_lines = MAIN_MEMORY_SIZE_IN_BYTES / BYTES_PER_CACHE_LINE;
+  uint32_t *lines = malloc(num_lines * sizeof(uint32_t));
+  for (uint32_t i = 0; i < num_lines; i++)
+    lines[i] = i;
+  srand(83);
+  for (uint32_t i = 0; i < LIST_NODES; i++) {
+    uint32_t j = i + rand() % (num_lines - i);
+    uint32_t tmp = lines[i];
+    lines[i] = lines[j];
+    lines[j] = tmp;
+  }
+  for (uint32_t i = 0; i < LIST_NODES; i++)
+    memory_access(lines[i] * BYTES_PER_CACHE_LINE, lines[(i + 1) % LIST_NODES] * BYTES_PER_CACHE_LINE,
+                  WRITE_ENABLE_MASK, NULL);
+  uint32_t head = lines[0] * BYTES_PER_CACHE_LINE;
+  free(lines);
+  return head;
+}
+
+//Follows the list once. Returns the number of L2 misses.
+uint32_t traverse_list(uint32_t head)
+{
+  uint32_t misses_before = num_l2_misses;
+  uint32_t node = head;
+  for (uint32_t i = 0; i < LIST_NODES; i++)
+    memory_access(node, 0, READ_ENABLE_MASK, &node);
+  if (node != head) {
+    printf("Error: the list should be circular\n");
+    exit(1);
+  }
+  return num_l2_misses - misses_before;
+}
+
+void fill_memory()
+{
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  for (uint32_t address = 0; address < MAIN_MEMORY_SIZE_IN_BYTES; address += 4)
+    memory_access(address, address >> 2, WRITE_ENABLE_MASK, NULL);
+}
+
+int main()
+{
+  printf("Pass 1: Sequential reads and sparse record fields without prefetching\n");
+
+  fill_memory();
+  uint32_t misses_before = num_l2_misses;
+  read_sequentially();
+  uint32_t misses_without_prefetching = num_l2_misses - misses_before;
+  printf("L2 misses = %u\n", misses_without_prefetching);
+
+  //baseline for Pass 5
+  fill_memory();
+  uint32_t record_misses_without_prefetching = read_records();
+
+  printf("Pass 2: Sequential reads with the stream prefetcher\n");
+
+  fill_memory();
+  memory_enable_prefetching();
+  prefetch_attach(&stream_prefetcher);
+  misses_before = num_l2_misses;
+  read_sequentially();
+  uint32_t misses_with_prefetching = num_l2_misses - misses_before;
+  printf("L2 misses = %u\n", misses_with_prefetching);
+  prefetch_report();
+
+  if (misses_with_prefetching * 20 > misses_without_prefetching) {
+    printf("Error: prefetching should remove at least 95%% of the misses\n");
+    exit(1);
+  }
+  if (prefetch_distance() < 16) {
+    printf("Error: accurate prefetching should not be throttled down\n");
+    exit(1);
+  }
+
+  printf("Pass 3: Useless prefetches are throttled\n");
+
+  fill_memory();
+  memory_enable_prefetching();
+  prefetch_attach(&stream_prefetcher);
+  read_random_pairs(8 * PREFETCH_INTERVAL);
+  prefetch_report();
+
+  if (prefetch_distance() != 4) {
+    printf("Error: the aggressiveness level should have dropped to 1\n");
+    exit(1);
+  }
+
+  printf("Pass 4: Without throttling, the level stays fixed\n");
+
+  fill_memory();
+  memory_enable_prefetching();
+  prefetch_attach(&stream_prefetcher);
+  prefetch_set_throttling(FALSE, PREFETCH_NUM_LEVELS);
+  read_random_pairs(8 * PREFETCH_INTERVAL);
+
+  if (prefetch_distance() != 64) {
+    printf("Error: the aggressiveness level should still be 5\n");
+    exit(1);
+  }
+
+  printf("Pass 5: Sparse record fields with the SMS prefetcher\n");
+
+  fill_memory();
+  memory_enable_prefetching();
+  prefetch_attach(&sms_prefetcher);
+  misses_with_prefetching = read_records();
+  printf("L2 misses = %u without prefetching, %u with\n", record_misses_without_prefetching, misses_with_prefetching);
+  prefetch_report();
+
+  //only the trigger access of each region should still miss
+  if (misses_with_prefetching * 4 > record_misses_without_prefetching) {
+    printf("Error: the SMS prefetcher should remove most of the misses\n");
+    exit(1);
+  }
+
+  printf("Pass 6: Repeated pointer chasing with the temporal prefetcher\n");
+
+  fill_memory();
+  memory_enable_prefetching();
+  prefetch_attach(&temporal_prefetcher);
+  uint32_t head = build_list();
+  uint32_t first_misses = traverse_list(head);
+  uint32_t second_misses = traverse_list(head);
+  printf("L2 misses = %u on the first traversal, %u on the second\n", first_misses, second_misses);
+  prefetch_report();
+
+  if (second_misses * 4 > first_misses) {
+    printf("Error: the temporal prefetcher should remove most of the misses of the second traversal\n");
+    exit(1);
+  }
+
+  printf("Pass 7: The metadata budget bounds the history\n");
+
+  //With a history too short to hold the whole traversal, nothing
+  //recorded is still there when it comes around again.
+  fill_memory();
+  memory_enable_prefetching();
+  temporal_prefetcher_configure(16 * 1024);
+  prefetch_attach(&temporal_prefetcher);
+  head = build_list();
+  first_misses = traverse_list(head);
+  second_misses = traverse_list(head);
+  prefetch_report();
+
+  if (second_misses * 10 < first_misses * 9) {
+    printf("Error: a 16KB history should not cover a traversal of %d nodes\n", LIST_NODES);
+    exit(1);
+  }
+
+  printf("Pass 8: Queued prefetches are dropped by a re-initialize or a restore\n");
+
+  //Reading 64 lines advances the prefetch clock well past the fill
+  //delay, so a prefetch left in the queue would be filled.
+  uint32_t read_data;
+  fill_memory();
+  memory_enable_prefetching();
+  prefetch_attach(&stream_prefetcher);
+  prefetch_issue(0x100000, 1);
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  for (uint32_t address = 0x200000; address < 0x200000 + 64 * BYTES_PER_CACHE_LINE; address += BYTES_PER_CACHE_LINE)
+    memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+  if (l2_probe(0x100000)) {
+    printf("Error: a prefetch queued before the re-initialize should not be filled\n");
+    exit(1);
+  }
+
+  FILE *checkpoint = tmpfile();
+  checkpoint_write(checkpoint, TRUE);
+  prefetch_issue(0x100000, 1);
+  rewind(checkpoint);
+  checkpoint_restore(&checkpoint, 1);
+  for (uint32_t address = 0x300000; address < 0x300000 + 64 * BYTES_PER_CACHE_LINE; address += BYTES_PER_CACHE_LINE)
+    memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+  if (l2_probe(0x100000)) {
+    printf("Error: a prefetch queued before the restore should not be filled\n");
+    exit(1);
+  }
+  fclose(checkpoint);
+
+  printf("Passed\n");
+}
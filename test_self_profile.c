@@ -0,0 +1,74 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "self_profile.h"
+#include "test_check.h"
+
+// We'll test with an 8MB (2^23) memory
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 23)
+
+#define SAMPLE_PERIOD 16
+
+extern uint32_t num_l1_misses;
+extern uint32_t num_l2_misses;
+
+//Writes, then reads, a region of the specified size, a word at a
+//time, and returns the number of accesses.
+
+uint32_t sweep(uint32_t size)
+{
+  uint32_t read_data;
+  for (uint32_t address = 0; address < size; address += 4)
+    memory_access(address, address, WRITE_ENABLE_MASK, NULL);
+  for (uint32_t address = 0; address < size; address += 4) {
+    memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+    check(read_data == address, "the words written should be read back");
+  }
+  return 2 * (size / 4);
+}
+
+int main()
+{
+  printf("Pass 1: Sweeping memory without self-profiling\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  sweep(MAIN_MEMORY_SIZE_IN_BYTES);
+  uint32_t l1_misses = num_l1_misses;
+  uint32_t l2_misses = num_l2_misses;
+
+  printf("Pass 2: The same, with self-profiling\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_enable_self_profile(SAMPLE_PERIOD);
+  uint32_t accesses = sweep(MAIN_MEMORY_SIZE_IN_BYTES);
+  self_profile_report();
+  check((num_l1_misses == l1_misses) && (num_l2_misses == l2_misses),
+        "self-profiling should not change the simulation");
+  check(memory_fast_path_enabled, "self-profiling should keep the L1 hit fast path");
+  check(self_profile_accesses == accesses, "every access should be counted");
+  check((self_profile_timed_accesses > accesses / SAMPLE_PERIOD * 0.9) &&
+        (self_profile_timed_accesses < accesses / SAMPLE_PERIOD * 1.1),
+        "one access in every sample period should be timed, on average");
+
+  //Every access goes through the L1 path, the sweep misses in
+  //both caches, and the sweep itself is outside of the memory
+  //subsystem.
+  for (int component = 0; component < SELF_PROFILE_NUM_COMPONENTS; component++)
+    check(self_profile_seconds(component) > 0, "time should be spent in every component");
+
+  printf("Pass 3: L1 hits only\n");
+
+  sweep(1 << 14);
+  memory_enable_self_profile(SAMPLE_PERIOD);
+  accesses = sweep(1 << 14);
+  self_profile_report();
+  check(self_profile_accesses == accesses, "every access should be counted");
+  check(self_profile_seconds(SELF_PROFILE_L1) > 0, "time should be spent in the L1 path, fast path included");
+  check((self_profile_seconds(SELF_PROFILE_L1_MISS) == 0) && (self_profile_seconds(SELF_PROFILE_L2_MISS) == 0) &&
+        (self_profile_seconds(SELF_PROFILE_MAIN_MEMORY) == 0), "L1 hits should only be timed in the L1 path");
+
+  printf("Passed\n");
+}
@@ -0,0 +1,132 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "l2_cache.h"
+#include "ship.h"
+#include "checkpoint.h"
+
+// We'll test with a 16MB (2^24) memory
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 24)
+
+//A 12MB region in which one line in 16 is hot (768KB in all, so
+//that the hot lines fit in the L2 cache) and the others are scanned
+//through. The hot lines are spread evenly over the L2 sets. The hot
+//and the scanned lines are read by different instructions, but share
+//the same memory regions.
+#define REGION_BASE (1 << 20)
+#define REGION_LINES ((12 << 20) / BYTES_PER_CACHE_LINE)
+#define HOT_STRIDE 16
+#define PC_SCAN 0x401000
+#define PC_HOT 0x402000
+
+extern uint32_t num_l2_misses;
+
+BOOL is_hot(uint32_t line)
+{
+  return (line % HOT_STRIDE) == ((line / L2_NUM_CACHE_SETS) % HOT_STRIDE);
+}
+
+//Returns the next hot (or scanned) line after the specified one.
+uint32_t next_line(uint32_t line, BOOL hot)
+{
+  do {
+    line = (line + 1) % REGION_LINES;
+  } while (is_hot(line) != hot);
+  return line;
+}
+
+//Reads a hot line for every two scanned lines, with a clock
+//interrupt every 8K accesses, and returns the number of L2 misses.
+uint32_t run(int passes)
+{
+  MEMORY_REQUEST_INFO scan_info = {PC_SCAN, 0, MEMORY_ACCESS_DATA, 4};
+  MEMORY_REQUEST_INFO hot_info = {PC_HOT, 0, MEMORY_ACCESS_DATA, 4};
+  uint32_t read_data;
+  uint32_t scan = 1;
+  uint32_t hot = 0;
+  uint32_t misses_before = num_l2_misses;
+  uint32_t num_accesses = 0;
+  uint32_t steps = passes * (REGION_LINES - REGION_LINES / HOT_STRIDE) / 2;
+
+  for (uint32_t step = 0; step < steps; step++) {
+    memory_access_with_info(REGION_BASE + scan * BYTES_PER_CACHE_LINE, 0, READ_ENABLE_MASK, &read_data, &scan_info);
+    scan = next_line(scan, FALSE);
+    memory_access_with_info(REGION_BASE + scan * BYTES_PER_CACHE_LINE, 0, READ_ENABLE_MASK, &read_data, &scan_info);
+    scan = next_line(scan, FALSE);
+    memory_access_with_info(REGION_BASE + hot * BYTES_PER_CACHE_LINE, 0, READ_ENABLE_MASK, &read_data, &hot_info);
+    hot = next_line(hot, TRUE);
+    num_accesses += 3;
+    if ((num_accesses & 0x1fff) < 3)
+      memory_handle_clock_interrupt();
+  }
+  return num_l2_misses - misses_before;
+}
+
+int main()
+{
+  printf("Pass 1: Hot lines among scanned lines, with NRU alone\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  uint32_t baseline = run(3);
+  printf("L2 misses = %u\n", baseline);
+
+  printf("Pass 2: With SHiP, PC signatures\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_enable_ship(SHIP_SIGNATURE_PC);
+  uint32_t pc = run(3);
+  printf("L2 misses = %u\n", pc);
+  ship_report();
+
+  printf("Pass 3: With SHiP, memory-region signatures\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_enable_ship(SHIP_SIGNATURE_MEMORY);
+  uint32_t memory = run(3);
+  printf("L2 misses = %u\n", memory);
+  ship_report();
+
+  printf("Pass 4: With SHiP, instruction-sequence signatures\n");
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_enable_ship(SHIP_SIGNATURE_ISEQ);
+  uint32_t iseq = run(3);
+  printf("L2 misses = %u\n", iseq);
+  ship_report();
+
+  //The PC-based signatures tell the hot lines from the scanned
+  //ones, which the memory regions cannot.
+  if ((pc >= baseline) || (iseq >= baseline)) {
+    printf("Error: SHiP with PC-based signatures should reduce the number of L2 misses\n");
+    exit(1);
+  }
+  if ((pc >= memory) || (iseq >= memory)) {
+    printf("Error: PC-based signatures should do better than memory-region signatures\n");
+    exit(1);
+  }
+
+  printf("Pass 5: SHiP kept on across a re-initialize and a checkpoint restore\n");
+
+  //The per-line state has to follow the L2 cache being cleared, or
+  //the sets fill up with lines no longer in L2.
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  uint32_t again = run(3);
+  printf("L2 misses = %u\n", again);
+  FILE *checkpoint = tmpfile();
+  checkpoint_write(checkpoint, TRUE);
+  run(1);
+  rewind(checkpoint);
+  checkpoint_restore(&checkpoint, 1);
+  run(3);
+  fclose(checkpoint);
+  if (again >= baseline) {
+    printf("Error: SHiP should still reduce the number of L2 misses after a re-initialize\n");
+    exit(1);
+  }
+
+  printf("Passed\n");
+}
@@ -0,0 +1,125 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "store_buffer.h"
+#include "test_check.h"
+
+// We'll test with an 8MB (2^23) memory
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 23)
+
+//A small array, always in L1, that is read between the stores
+//in pass 3 and 4.
+#define HOT_BASE (1 << 22)
+#define HOT_WORDS 256
+
+extern uint32_t num_l1_misses;
+extern uint32_t num_l2_misses;
+extern uint64_t store_buffer_coalesced;
+
+//Writes every word of the first half of memory, as in pass 1 of
+//test_memory_subsystem, reading reads_per_store words of the small
+//array after each store. Returns the number of cycles taken.
+uint64_t write_stream(int reads_per_store)
+{
+  uint32_t read_data;
+  uint32_t hot = 0;
+
+  for (uint32_t address = 0; address < HOT_BASE; address += 4) {
+    memory_access(address, address >> 2, WRITE_ENABLE_MASK, NULL);
+    for (int i = 0; i < reads_per_store; i++) {
+      memory_access(HOT_BASE + hot * 4, 0, READ_ENABLE_MASK, &read_data);
+      hot = (hot + 1) % HOT_WORDS;
+    }
+  }
+  if (store_buffer_enabled)
+    store_buffer_drain();
+  return memory_cycles;
+}
+
+//Checks that every word written by write_stream() holds its value.
+void check_stream()
+{
+  uint32_t read_data;
+
+  for (uint32_t address = 0; address < HOT_BASE; address += 4) {
+    memory_access(address, 0, READ_ENABLE_MASK, &read_data);
+    if (read_data != (address >> 2)) {
+      printf("Error: Value read at address %u is %u, should be %u\n", address, read_data, address >> 2);
+      exit(1);
+    }
+  }
+}
+
+int main()
+{
+  uint32_t read_data;
+
+  printf("Pass 1: A write stream, with blocking stores\n");
+
+  memory_enable_latency_model();
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  uint64_t blocking = write_stream(0);
+  uint32_t l1_misses = num_l1_misses;
+  uint32_t l2_misses = num_l2_misses;
+  printf("Cycles = %llu, L1 misses = %u, L2 misses = %u\n", (unsigned long long) blocking, l1_misses, l2_misses);
+
+  printf("Pass 2: The same write stream, with a store buffer\n");
+
+  memory_enable_store_buffer(8);
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  uint64_t buffered = write_stream(0);
+  printf("Cycles = %llu (%.2f%% fewer)\n", (unsigned long long) buffered,
+         100.0 - 100.0 * buffered / blocking);
+  store_buffer_report();
+  check((num_l1_misses == l1_misses) && (num_l2_misses == l2_misses),
+        "the store buffer should not change the number of misses");
+  check(buffered < blocking, "the store buffer should hide some of the store latency");
+  check_stream();
+
+  printf("Pass 3: A write stream with reads in between, with blocking stores\n");
+
+  store_buffer_enabled = FALSE;
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  uint64_t blocking_reads = write_stream(16);
+  printf("Cycles = %llu\n", (unsigned long long) blocking_reads);
+
+  printf("Pass 4: The same, with a store buffer\n");
+
+  memory_enable_store_buffer(8);
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  uint64_t buffered_reads = write_stream(16);
+  printf("Cycles = %llu (%.2f%% fewer)\n", (unsigned long long) buffered_reads,
+         100.0 - 100.0 * buffered_reads / blocking_reads);
+  store_buffer_report();
+
+  //With enough work between the stores, almost all of the store
+  //latency is hidden.
+  check(buffered_reads - (blocking_reads - blocking) < buffered,
+        "the reads should hide more of the store latency");
+  check_stream();
+
+  printf("Pass 5: Coalescing and store-to-load forwarding\n");
+
+  //The first store is drained right away, and the next ones are
+  //coalesced into a new entry while it completes.
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+  memory_access(0x100000, 0xa, WRITE_ENABLE_MASK, NULL);
+  memory_access(0x100004, 0xb, WRITE_ENABLE_MASK, NULL);
+  memory_access(0x100000, 0xc, WRITE_ENABLE_MASK, NULL);
+  check(store_buffer_coalesced == 1, "the third store should be coalesced");
+  l1_misses = num_l1_misses;
+  memory_access(0x100000, 0, READ_ENABLE_MASK, &read_data);
+  check(read_data == 0xc, "the read should be forwarded the last store");
+  check(num_l1_misses == l1_misses, "the forwarded read should not access the caches");
+  memory_access(0x100008, 0, READ_ENABLE_MASK, &read_data);
+  check(read_data == 0, "a word not written should be read from the cache");
+  memory_access(0x100000, 0, EVICT_MASK, NULL);
+  memory_access(0x100004, 0, READ_ENABLE_MASK, &read_data);
+  check(read_data == 0xb, "the stores should be performed before an evict");
+  store_buffer_report();
+
+  printf("Passed\n");
+}
@@ -0,0 +1,176 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "main_memory.h"
+#include "l2_cache.h"
+#include "prefetch.h"
+#include "trace.h"
+#include "test_check.h"
+
+// We'll test with an 8MB (2^23) memory
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 23)
+
+extern uint32_t num_l1_misses;
+extern uint32_t num_l2_misses;
+extern uint32_t num_sw_prefetches[4];
+extern uint32_t num_sw_prefetches_redundant;
+extern uint32_t num_sw_prefetch_memory_fills;
+extern uint32_t num_sw_prefetches_useful_l1;
+extern uint32_t num_sw_prefetches_useful_l2;
+extern uint32_t num_sw_prefetches_useless_l2;
+extern uint32_t num_sw_prefetches_hw_covered;
+extern uint32_t num_hint_writebacks;
+extern uint64_t prefetch_clock;
+extern uint64_t prefetch_demand_misses;
+extern uint64_t prefetch_useful[];
+extern uint64_t prefetch_late[];
+
+//A prefetcher that prefetches nothing, and records the metadata
+//of the last demand read of the L2 cache it was told about.
+MEMORY_REQUEST_INFO last_info;
+BOOL last_had_info;
+uint32_t num_trained;
+
+void recorder_initialize(uint8_t source)
+{
+}
+
+void recorder_train(uint32_t address, uint8_t outcome, const MEMORY_REQUEST_INFO *info)
+{
+  num_trained++;
+  last_had_info = (info != NULL);
+  if (info)
+    last_info = *info;
+}
+
+const PREFETCHER recorder = {"recorder", recorder_initialize, recorder_train, NULL, NULL};
+
+//Writes the given trace lines to a temporary file and runs it.
+uint64_t run(const char *lines)
+{
+  FILE *trace = tmpfile();
+  fputs(lines, trace);
+  rewind(trace);
+  uint64_t num_operations = trace_run(trace);
+  fclose(trace);
+  return num_operations;
+}
+
+int main()
+{
+  uint32_t read_data;
+  uint32_t cache_line[WORDS_PER_CACHE_LINE];
+
+  memory_subsystem_initialize(MAIN_MEMORY_SIZE_IN_BYTES);
+
+  printf("Pass 1: Reads, writes, comments and clock interrupts\n");
+
+  uint64_t n = run("# a comment\n"
+                   "W 1000 cafe\n"
+                   "\n"
+                   "R 1000\n"
+                   "C\n");
+  check(n == 3, "three operations should have been performed");
+  memory_access(0x1000, 0, READ_ENABLE_MASK, &read_data);
+  check(read_data == 0xcafe, "the write in the trace should have been performed");
+
+  printf("Pass 2: A software prefetch into L1 hides the miss\n");
+
+  uint32_t l1_misses = num_l1_misses, l2_misses = num_l2_misses;
+  run("P1 100000\n");
+  check((num_l1_misses == l1_misses) && (num_l2_misses == l2_misses), "a prefetch is not a miss");
+  check((num_sw_prefetches[0] == 1) && (num_sw_prefetch_memory_fills == 1), "the prefetch should fetch the line");
+  run("R 100004\n");
+  check(num_l1_misses == l1_misses, "the read should hit the prefetched line");
+  check(num_sw_prefetches_useful_l1 == 1, "the prefetch should be counted as used");
+  run("R 100008\n");
+  check(num_sw_prefetches_useful_l1 == 1, "the prefetch should be counted as used only once");
+  run("P1 100000\n");
+  check(num_sw_prefetches_redundant == 1, "a prefetch of a line in L1 is redundant");
+
+  printf("Pass 3: A software prefetch into L2 turns an L2 miss into a hit\n");
+
+  run("P2W 200000\n"
+      "R 200000\n");
+  check(num_sw_prefetches[3] == 1, "a write-intent L2 prefetch should be counted");
+  check((num_l1_misses == l1_misses + 1) && (num_l2_misses == l2_misses), "the read should miss in L1 only");
+  check(num_sw_prefetches_useful_l2 == 1, "the L2 prefetch should be counted as used");
+
+  //five lines mapping to the same 4-way L2 set, never used
+  run("P2 400000\n"
+      "P2 440000\n"
+      "P2 480000\n"
+      "P2 4c0000\n"
+      "P2 500000\n");
+  check(num_sw_prefetches_useless_l2 >= 1, "an L2 prefetch evicted unused should be counted");
+
+  printf("Pass 4: Evict writes back and removes the line from both caches\n");
+
+  run("W 300000 abcd\n"
+      "E 300000\n");
+  check(num_hint_writebacks == 1, "the dirty line should be written back");
+  check(!l2_probe(0x300000), "the line should not be in L2");
+  main_memory_access(0x300000, NULL, READ_ENABLE_MASK, cache_line);
+  check(cache_line[0] == 0xabcd, "main memory should hold the written data");
+  l1_misses = num_l1_misses;
+  memory_access(0x300000, 0, READ_ENABLE_MASK, &read_data);
+  check((num_l1_misses == l1_misses + 1) && (read_data == 0xabcd), "the line should be read back from memory");
+
+  printf("Pass 5: Demote moves the line from L1 to L2\n");
+
+  run("W 310000 1234\n"
+      "D 310000\n");
+  check(num_hint_writebacks == 2, "the dirty line should be written back to L2");
+  check(l2_probe(0x310000), "the line should be in L2");
+  l1_misses = num_l1_misses;
+  l2_misses = num_l2_misses;
+  memory_access(0x310000, 0, READ_ENABLE_MASK, &read_data);
+  check((num_l1_misses == l1_misses + 1) && (num_l2_misses == l2_misses), "the read should hit in L2");
+  check(read_data == 0x1234, "the demoted line should hold the written data");
+
+  memory_cache_hint_report();
+
+  printf("Pass 6: Request metadata reaches the L2 policies\n");
+
+  memory_enable_prefetching();
+  prefetch_attach(&recorder);
+  run("R 400000 pc=4010a8 tid=3 size=8\n");
+  check(last_had_info && (last_info.pc == 0x4010a8) && (last_info.thread_id == 3) &&
+        (last_info.size == 8) && (last_info.access_type == MEMORY_ACCESS_DATA),
+        "the metadata of the read should have been passed on");
+  run("I 410000\n");
+  check(last_had_info && (last_info.pc == 0x410000) && (last_info.access_type == MEMORY_ACCESS_INSTRUCTION),
+        "an instruction fetch should have its address as PC");
+  run("R 420000\n");
+  check(!last_had_info, "a read without metadata should pass NULL");
+
+  printf("Pass 7: Software prefetches are kept out of the hardware prefetchers\n");
+
+  uint32_t trained = num_trained;
+  uint64_t clock = prefetch_clock;
+  uint64_t demand_misses = prefetch_demand_misses;
+  run("P1 600000\n"
+      "P1 610000\n");
+  check((num_trained == trained) && (prefetch_clock == clock) && (prefetch_demand_misses == demand_misses),
+        "a software prefetch should not train or advance the hardware prefetchers");
+
+  //A line still in the prefetch queue, then a line already filled
+  //by a hardware prefetch.
+  uint8_t source = 1;
+  prefetch_issue(0x620000, source);
+  run("P1 620000\n");
+  check((num_sw_prefetches_hw_covered == 1) && (prefetch_late[source] == 0),
+        "a software prefetch of a queued line should not count as a late hardware prefetch");
+  prefetch_issue(0x630000, source);
+  for (uint32_t i = 0; !l2_probe(0x630000); i++)
+    memory_access(0x700000 + i * BYTES_PER_CACHE_LINE, 0, READ_ENABLE_MASK, &read_data);
+  run("P1 630000\n");
+  check((num_sw_prefetches_hw_covered == 2) && (prefetch_useful[source] == 0),
+        "a software prefetch of a prefetched line should not count as a useful hardware prefetch");
+  memory_cache_hint_report();
+
+  printf("Passed\n");
+}
@@ -0,0 +1,102 @@
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "working_set.h"
+
+//Normally kept by memory_subsystem.c.
+uint32_t num_l1_misses;
+uint32_t num_l2_misses;
+
+#define MAIN_MEMORY_SIZE_IN_BYTES (1 << 25)
+
+//Reads back the next row of the time series.
+
+void read_row(FILE *series, uint32_t *lines, uint32_t *pages, uint32_t *l1_misses)
+{
+  uint32_t window, page_bytes, line_bytes, l2_misses;
+  unsigned long long end_access;
+
+  if (fscanf(series, "%u,%llu,%u,%u,%u,%u,%u,%u\n", &window, &end_access, lines, pages,
+	     &line_bytes, &page_bytes, l1_misses, &l2_misses) != 8) {
+    printf("Error: missing row in the working-set time series\n");
+    exit(1);
+  }
+}
+
+int main()
+{
+  FILE *series = tmpfile();
+  uint32_t lines, pages, l1_misses;
+  uint32_t address, i;
+  char header[128];
+
+  printf("Pass 1: Windows of 4096 accesses, sequential words then a repeated page\n");
+
+  working_set_initialize(MAIN_MEMORY_SIZE_IN_BYTES, WORKING_SET_WINDOW_ACCESSES, 4096, series);
+
+  //window 0: 4096 consecutive words = 256 lines = 4 pages
+  for (address = 0; address < 4096 * BYTES_PER_WORD; address += BYTES_PER_WORD) {
+    working_set_access(address);
+    if (!(address & 0x3f))
+      num_l1_misses++;
+  }
+
+  //window 1: the first page, over and over
+  for (i = 0; i < 4096; i++)
+    working_set_access((i * BYTES_PER_WORD) & 0xfff);
+
+  //partial window 2: one word in each of 100 different pages
+  for (i = 0; i < 100; i++)
+    working_set_access(i * 8192);
+
+  working_set_report();
+
+  rewind(series);
+  fgets(header, sizeof(header), series);
+
+  read_row(series, &lines, &pages, &l1_misses);
+  if ((lines != 256) || (pages != 4) || (l1_misses != 256)) {
+    printf("Error: window 0 should have 256 lines, 4 pages and 256 L1 misses, has %u, %u and %u\n",
+	   lines, pages, l1_misses);
+    exit(1);
+  }
+  read_row(series, &lines, &pages, &l1_misses);
+  if ((lines != 64) || (pages != 1) || (l1_misses != 0)) {
+    printf("Error: window 1 should have 64 lines and 1 page, has %u and %u\n", lines, pages);
+    exit(1);
+  }
+  read_row(series, &lines, &pages, &l1_misses);
+  if ((lines != 100) || (pages != 100)) {
+    printf("Error: window 2 should have 100 lines and 100 pages, has %u and %u\n", lines, pages);
+    exit(1);
+  }
+
+  printf("Pass 2: Windows of 2 clock ticks\n");
+
+  fclose(series);
+  series = tmpfile();
+  working_set_initialize(MAIN_MEMORY_SIZE_IN_BYTES, WORKING_SET_WINDOW_CLOCK_TICKS, 2, series);
+
+  for (i = 0; i < 6; i++) {
+    //i+1 distinct lines per tick, all at the end of main memory
+    for (uint32_t j = 0; j <= i; j++)
+      working_set_access(MAIN_MEMORY_SIZE_IN_BYTES - (j + 1) * BYTES_PER_CACHE_LINE);
+    working_set_clock_tick();
+  }
+
+  rewind(series);
+  fgets(header, sizeof(header), series);
+
+  //each window holds the lines of its second tick
+  for (i = 0; i < 3; i++) {
+    read_row(series, &lines, &pages, &l1_misses);
+    if (lines != 2 * i + 2) {
+      printf("Error: clock window %u should have %u lines, has %u\n", i, 2 * i + 2, lines);
+      exit(1);
+    }
+  }
+
+  printf("Passed\n");
+}
@@ -0,0 +1,135 @@
+/************************************************************
+
+   This file contains the trace reader (see trace.h).
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "trace.h"
+
+#define TRACE_MAX_LINE 256
+
+
+//Returns the control byte for an operation, or 0 if the
+//operation is unknown.
+
+static uint8_t trace_control(const char *op)
+{
+    if (!strcmp(op, "R") || !strcmp(op, "I"))
+        return READ_ENABLE_MASK;
+    if (!strcmp(op, "W"))
+        return WRITE_ENABLE_MASK;
+    if (!strcmp(op, "P1"))
+        return SW_PREFETCH_L1_MASK;
+    if (!strcmp(op, "P1W"))
+        return SW_PREFETCH_L1_MASK | SW_PREFETCH_WRITE_MASK;
+    if (!strcmp(op, "P2"))
+        return SW_PREFETCH_L2_MASK;
+    if (!strcmp(op, "P2W"))
+        return SW_PREFETCH_L2_MASK | SW_PREFETCH_WRITE_MASK;
+    if (!strcmp(op, "D"))
+        return DEMOTE_MASK;
+    if (!strcmp(op, "E"))
+        return EVICT_MASK;
+    return 0;
+}
+
+
+//Parses a key=value metadata field into info. Returns FALSE if
+//the field is unknown.
+
+static BOOL trace_parse_info(const char *field, MEMORY_REQUEST_INFO *info)
+{
+    unsigned int value;
+
+    if (sscanf(field, "pc=%x", &value) == 1)
+        info->pc = value;
+    else if (sscanf(field, "tid=%u", &value) == 1)
+        info->thread_id = value;
+    else if (sscanf(field, "size=%u", &value) == 1)
+        info->size = value;
+    else
+        return FALSE;
+    return TRUE;
+}
+
+
+/************************************************
+
+       trace_run()
+
+This procedure performs each operation of the trace in turn.
+
+***********************************************/
+
+uint64_t trace_run(FILE *trace)
+{
+    char line[TRACE_MAX_LINE];
+    char copy[TRACE_MAX_LINE];
+    unsigned int address, data;
+    uint32_t read_data;
+    uint64_t num_operations = 0;
+    uint64_t line_number = 0;
+
+    while (fgets(line, sizeof(line), trace)) {
+        line_number++;
+        strcpy(copy, line);
+        char *op = strtok(copy, " \t\r\n");
+        if ((op == NULL) || (op[0] == '#'))
+            continue;
+
+      //The operation is followed by its address and data, if any,
+      //then by the metadata fields, if any.
+
+        int fields = 1;
+        BOOL has_info = FALSE;
+        BOOL malformed = FALSE;
+        MEMORY_REQUEST_INFO info = {0, 0, MEMORY_ACCESS_DATA, 4};
+        char *field;
+        while ((field = strtok(NULL, " \t\r\n"))) {
+            if (strchr(field, '=')) {
+                malformed |= !trace_parse_info(field, &info);
+                has_info = TRUE;
+            }
+            else if (has_info || (fields == 3)) {
+                malformed = TRUE;
+            }
+            else if (sscanf(field, "%x", (fields == 1) ? &address : &data) == 1) {
+                fields++;
+            }
+            else {
+                malformed = TRUE;
+            }
+        }
+
+        if (!strcmp(op, "C") && !malformed && (fields == 1) && !has_info) {
+            memory_handle_clock_interrupt();
+        }
+        else {
+            uint8_t control = trace_control(op);
+            if (malformed || (control == 0) || (fields < 2) ||
+                ((control == WRITE_ENABLE_MASK) && (fields < 3))) {
+                printf("Error: malformed trace line %llu: %s", (unsigned long long) line_number, line);
+                exit(1);
+            }
+            if (!strcmp(op, "I")) {
+                info.access_type = MEMORY_ACCESS_INSTRUCTION;
+                if (info.pc == 0)
+                    info.pc = address;
+                has_info = TRUE;
+            }
+            if (has_info)
+                memory_access_with_info(address, data, control, &read_data, &info);
+            else
+                memory_access(address, data, control, &read_data);
+        }
+        num_operations++;
+    }
+    return num_operations;
+}
@@ -0,0 +1,45 @@
+/************************************************************
+
+    Memory access traces.
+
+A trace is a text file with one memory operation per line:
+
+    R <address>           read a word
+    I <address>           fetch an instruction (a read)
+    W <address> <data>    write a word
+    P1 <address>          software prefetch into L1 (P1W: to be written)
+    P2 <address>          software prefetch into L2 (P2W: to be written)
+    D <address>           demote the line containing the address to L2
+    E <address>           write back and evict the line containing the address
+    C                     clock interrupt
+
+Addresses and data are in hexadecimal. Blank lines and lines
+starting with # are ignored.
+
+An operation may be followed by the metadata of the request (see
+memory_request.h), as key=value fields in any order:
+
+    pc=<address>          the PC of the instruction (hexadecimal)
+    tid=<n>               the thread ID (decimal)
+    size=<n>              the access size in bytes (decimal)
+
+e.g. "R 1f40 pc=400a1c tid=1". A line with metadata, or an I
+operation (whose PC is its address), is performed with
+memory_access_with_info(); other lines with memory_access().
+
+************************************************************/
+
+
+/************************************************
+
+       trace_run()
+
+This procedure performs each operation of the trace in turn, with
+memory_access(), memory_access_with_info() or
+memory_handle_clock_interrupt(), on the memory
+subsystem, which must have been initialized. It returns the number
+of operations performed. A malformed line is an error.
+
+***********************************************/
+
+uint64_t trace_run(FILE *trace);
@@ -0,0 +1,139 @@
+/************************************************************
+
+   trace_sim: runs a trace (see trace.h) on the memory subsystem
+   and prints the resulting statistics.
+
+   Usage: trace_sim [-l1i <KB> <ways>] [-memfile <file>] [-dedup]
+                    [-profile <period>] [-record <file> | -filtered]
+                    <memory size in MB> [trace file]
+
+   The trace is read from standard input if no file is given.
+   With -l1i, the L1 cache is split, with an L1 instruction cache
+   of the specified size and associativity (LRU) serving the
+   instruction fetches of the trace (see l1i_cache.h). With -memfile,
+   main memory is mapped from the specified file, which is created
+   as a sparse file (see main_memory.h), so the memory size can
+   exceed the host's memory. With -dedup, main memory is stored
+   deduplicated by cache line contents (see main_memory.h), which
+   also lets a mostly redundant memory exceed the host's memory.
+   With -profile, one access in every period is timed on the host,
+   and the accesses simulated per host second and the host time spent
+   in each part of the memory subsystem and in reading the trace are
+   printed (see self_profile.h). With -record, the L1-filtered trace
+   of the run is written to the specified file; with -filtered, the
+   trace is such an L1-filtered trace, which is replayed on L2 only
+   (see filtered_trace.h), with the same memory size.
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memory_subsystem_constants.h"
+#include "memory_subsystem.h"
+#include "main_memory.h"
+#include "l1i_cache.h"
+#include "trace.h"
+#include "self_profile.h"
+#include "filtered_trace.h"
+
+extern uint32_t num_l1_misses;
+extern uint32_t num_l2_misses;
+
+int main(int argc, char *argv[])
+{
+  int arg = 1;
+  uint32_t l1i_size_in_bytes = 0;
+  uint32_t l1i_lines_per_set = 0;
+  const char *memory_file = NULL;
+  BOOL deduplicate = FALSE;
+  uint32_t profile_period = 0;
+  const char *record_file = NULL;
+  BOOL filtered = FALSE;
+
+  while (arg < argc) {
+    if (!strcmp(argv[arg], "-l1i") && (argc - arg > 2)) {
+      l1i_size_in_bytes = (uint32_t) atoi(argv[arg + 1]) << 10;
+      l1i_lines_per_set = (uint32_t) atoi(argv[arg + 2]);
+      arg += 3;
+    }
+    else if (!strcmp(argv[arg], "-memfile") && (argc - arg > 1)) {
+      memory_file = argv[arg + 1];
+      arg += 2;
+    }
+    else if (!strcmp(argv[arg], "-profile") && (argc - arg > 1)) {
+      profile_period = (uint32_t) atoi(argv[arg + 1]);
+      arg += 2;
+    }
+    else if (!strcmp(argv[arg], "-record") && (argc - arg > 1)) {
+      record_file = argv[arg + 1];
+      arg += 2;
+    }
+    else if (!strcmp(argv[arg], "-filtered")) {
+      filtered = TRUE;
+      arg++;
+    }
+    else if (!strcmp(argv[arg], "-dedup")) {
+      deduplicate = TRUE;
+      arg++;
+    }
+    else {
+      break;
+    }
+  }
+  if ((argc - arg < 1) || (argc - arg > 2) || (record_file && filtered)) {
+    printf("Usage: %s [-l1i <KB> <ways>] [-memfile <file>] [-dedup] [-profile <period>] [-record <file> | -filtered] <memory size in MB> [trace file]\n", argv[0]);
+    exit(1);
+  }
+
+  uint32_t memory_size_in_bytes = (uint32_t) atoi(argv[arg]) << 20;
+  FILE *trace = stdin;
+  if (argc - arg == 2) {
+    trace = fopen(argv[arg + 1], filtered ? "rb" : "r");
+    if (trace == NULL) {
+      printf("Error: cannot open %s\n", argv[arg + 1]);
+      exit(1);
+    }
+  }
+
+  if (memory_file)
+    main_memory_use_file(memory_file, NULL);
+  main_memory_deduplicate(deduplicate);
+  memory_subsystem_initialize(memory_size_in_bytes);
+  if (l1i_size_in_bytes)
+    memory_enable_split_l1(l1i_size_in_bytes, l1i_lines_per_set, L1I_POLICY_LRU);
+  if (profile_period)
+    memory_enable_self_profile(profile_period);
+  FILE *record = NULL;
+  if (record_file) {
+    record = fopen(record_file, "wb");
+    if (record == NULL) {
+      printf("Error: cannot create %s\n", record_file);
+      exit(1);
+    }
+    filtered_trace_start(record);
+  }
+  uint64_t num_operations = filtered ? filtered_trace_replay(trace) : trace_run(trace);
+  if (record) {
+    uint64_t num_events = filtered_trace_finish();
+    fclose(record);
+    printf("Filtered trace: %llu events written to %s\n", (unsigned long long) num_events, record_file);
+  }
+
+  printf("%s = %llu\n", filtered ? "Events" : "Operations", (unsigned long long) num_operations);
+  if (l1i_enabled) {
+    printf("L1D misses = %u\n", num_l1_misses);
+    l1i_report();
+  }
+  else {
+    printf("L1 misses = %u\n", num_l1_misses);
+  }
+  printf("L2 misses = %u\n", num_l2_misses);
+  memory_cache_hint_report();
+  if (memory_file || deduplicate)
+    main_memory_report();
+  if (profile_period)
+    self_profile_report();
+}
@@ -0,0 +1,265 @@
+/************************************************************
+
+   This file contains the working-set size estimator.
+
+   There is one bit per cache line and one bit per 4KB page of
+   main memory. The first access to a line (or page) within a
+   window sets its bit and increments the count of distinct lines
+   (or pages). At the end of the window, the counts are emitted
+   and the bitmaps are cleared. The index of each bitmap word
+   that a window sets its first bit in is kept in a list, so that
+   only those words are cleared, rather than the whole bitmaps.
+
+   For a 32MB main memory, the line bitmap is 64KB and the page
+   bitmap is 1KB.
+
+************************************************************/
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "memory_subsystem_constants.h"
+#include "working_set.h"
+
+//The miss counters kept by memory_subsystem.c.
+extern uint32_t num_l1_misses;
+extern uint32_t num_l2_misses;
+
+#define WORKING_SET_LINE_SHIFT 6
+#define WORKING_SET_PAGE_SHIFT 12
+
+BOOL working_set_enabled = FALSE;
+
+uint64_t *working_set_line_bitmap;
+uint64_t *working_set_page_bitmap;
+uint32_t working_set_line_bitmap_words;
+uint32_t working_set_page_bitmap_words;
+uint32_t working_set_num_lines;
+
+//The bitmap words set in the current window.
+uint32_t *working_set_touched_line_words;
+uint32_t *working_set_touched_page_words;
+uint32_t working_set_num_touched_line_words;
+uint32_t working_set_num_touched_page_words;
+
+uint8_t working_set_window_unit;
+uint32_t working_set_window_length;
+FILE *working_set_output;
+
+//State of the current window.
+uint32_t working_set_window_position;
+uint32_t working_set_window_accesses;
+uint32_t working_set_lines;
+uint32_t working_set_pages;
+uint32_t working_set_window_l1_misses;
+uint32_t working_set_window_l2_misses;
+
+//Totals over all windows.
+uint32_t working_set_num_windows;
+uint64_t working_set_total_accesses;
+uint64_t working_set_sum_lines;
+uint64_t working_set_sum_pages;
+uint32_t working_set_peak_lines;
+uint32_t working_set_peak_pages;
+
+
+/************************************************************
+
+            working_set_initialize()
+
+This procedure allocates the bitmaps and enables the estimator.
+
+************************************************************/
+
+void working_set_initialize(uint32_t memory_size_in_bytes, uint8_t window_unit,
+			    uint32_t window_length, FILE *output)
+{
+    if (window_length == 0) {
+        printf("Error: working-set window length must be non-zero\n");
+        exit(1);
+    }
+
+  //One bit per line (page), rounded up to a whole number
+  //of 64-bit words.
+
+    uint32_t num_lines = memory_size_in_bytes >> WORKING_SET_LINE_SHIFT;
+    uint32_t num_pages = (memory_size_in_bytes + WORKING_SET_PAGE_SIZE_IN_BYTES - 1) >> WORKING_SET_PAGE_SHIFT;
+    working_set_num_lines = num_lines;
+    working_set_line_bitmap_words = (num_lines + 63) / 64;
+    working_set_page_bitmap_words = (num_pages + 63) / 64;
+
+    free(working_set_line_bitmap);
+    free(working_set_page_bitmap);
+    working_set_line_bitmap = calloc(working_set_line_bitmap_words, sizeof(uint64_t));
+    working_set_page_bitmap = calloc(working_set_page_bitmap_words, sizeof(uint64_t));
+    free(working_set_touched_line_words);
+    free(working_set_touched_page_words);
+    working_set_touched_line_words = malloc(working_set_line_bitmap_words * sizeof(uint32_t));
+    working_set_touched_page_words = malloc(working_set_page_bitmap_words * sizeof(uint32_t));
+    working_set_num_touched_line_words = 0;
+    working_set_num_touched_page_words = 0;
+
+    working_set_window_unit = window_unit;
+    working_set_window_length = window_length;
+    working_set_output = output;
+
+    working_set_window_position = 0;
+    working_set_window_accesses = 0;
+    working_set_lines = 0;
+    working_set_pages = 0;
+    working_set_window_l1_misses = num_l1_misses;
+    working_set_window_l2_misses = num_l2_misses;
+
+    working_set_num_windows = 0;
+    working_set_total_accesses = 0;
+    working_set_sum_lines = 0;
+    working_set_sum_pages = 0;
+    working_set_peak_lines = 0;
+    working_set_peak_pages = 0;
+
+    fprintf(output, "window,end_access,lines,pages,line_bytes,page_bytes,l1_misses,l2_misses\n");
+    working_set_enabled = TRUE;
+}
+
+
+//The miss counters may be reset to 0 by the caller between
+//phases, in which case the count since the reset is used.
+
+static uint32_t working_set_misses_since(uint32_t now, uint32_t start)
+{
+    return (now >= start) ? (now - start) : now;
+}
+
+
+//Emits the current window and starts a new one.
+
+static void working_set_end_window()
+{
+    uint32_t l1_misses = working_set_misses_since(num_l1_misses, working_set_window_l1_misses);
+    uint32_t l2_misses = working_set_misses_since(num_l2_misses, working_set_window_l2_misses);
+
+    fprintf(working_set_output, "%u,%llu,%u,%u,%llu,%llu,%u,%u\n",
+            working_set_num_windows,
+            (unsigned long long) working_set_total_accesses,
+            working_set_lines, working_set_pages,
+            (unsigned long long) working_set_lines * BYTES_PER_CACHE_LINE,
+            (unsigned long long) working_set_pages * WORKING_SET_PAGE_SIZE_IN_BYTES,
+            l1_misses, l2_misses);
+
+    working_set_num_windows++;
+    working_set_sum_lines += working_set_lines;
+    working_set_sum_pages += working_set_pages;
+    if (working_set_lines > working_set_peak_lines)
+        working_set_peak_lines = working_set_lines;
+    if (working_set_pages > working_set_peak_pages)
+        working_set_peak_pages = working_set_pages;
+
+    for (uint32_t i = 0; i < working_set_num_touched_line_words; i++)
+        working_set_line_bitmap[working_set_touched_line_words[i]] = 0;
+    for (uint32_t i = 0; i < working_set_num_touched_page_words; i++)
+        working_set_page_bitmap[working_set_touched_page_words[i]] = 0;
+    working_set_num_touched_line_words = 0;
+    working_set_num_touched_page_words = 0;
+    working_set_lines = 0;
+    working_set_pages = 0;
+    working_set_window_position = 0;
+    working_set_window_accesses = 0;
+    working_set_window_l1_misses = num_l1_misses;
+    working_set_window_l2_misses = num_l2_misses;
+}
+
+
+/************************************************************
+
+            working_set_access()
+
+This procedure records one access to the specified address.
+
+************************************************************/
+
+void working_set_access(uint32_t address)
+{
+    uint32_t line = address >> WORKING_SET_LINE_SHIFT;
+    uint32_t page = address >> WORKING_SET_PAGE_SHIFT;
+    uint64_t line_bit = (uint64_t) 1 << (line & 63);
+    uint64_t page_bit = (uint64_t) 1 << (page & 63);
+
+  //Addresses outside of main memory are reported as an error
+  //by main_memory_access(), they are not counted here.
+
+    if (line >= working_set_num_lines)
+        return;
+
+    if (!(working_set_line_bitmap[line >> 6] & line_bit)) {
+        if (working_set_line_bitmap[line >> 6] == 0)
+            working_set_touched_line_words[working_set_num_touched_line_words++] = line >> 6;
+        working_set_line_bitmap[line >> 6] |= line_bit;
+        working_set_lines++;
+
+      //A page can only be new if the line is.
+
+        if (!(working_set_page_bitmap[page >> 6] & page_bit)) {
+            if (working_set_page_bitmap[page >> 6] == 0)
+                working_set_touched_page_words[working_set_num_touched_page_words++] = page >> 6;
+            working_set_page_bitmap[page >> 6] |= page_bit;
+            working_set_pages++;
+        }
+    }
+
+    working_set_total_accesses++;
+    working_set_window_accesses++;
+
+    if ((working_set_window_unit == WORKING_SET_WINDOW_ACCESSES) &&
+        (++working_set_window_position == working_set_window_length)) {
+        working_set_end_window();
+    }
+}
+
+
+/************************************************************
+
+            working_set_clock_tick()
+
+This procedure is called on each clock interrupt.
+
+************************************************************/
+
+void working_set_clock_tick()
+{
+    if ((working_set_window_unit == WORKING_SET_WINDOW_CLOCK_TICKS) &&
+        (++working_set_window_position == working_set_window_length)) {
+        working_set_end_window();
+    }
+}
+
+
+/************************************************************
+
+            working_set_report()
+
+This procedure emits the partial current window, if any, and
+prints the average and peak working-set sizes.
+
+************************************************************/
+
+void working_set_report()
+{
+    if (working_set_window_accesses > 0)
+        working_set_end_window();
+
+    if (working_set_num_windows == 0) {
+        printf("Working set: no windows\n");
+        return;
+    }
+
+    printf("Working set: %u windows, average %llu lines (%llu KB) and %llu pages (%llu KB), "
+           "peak %u lines (%u KB) and %u pages (%u KB)\n",
+           working_set_num_windows,
+           (unsigned long long) (working_set_sum_lines / working_set_num_windows),
+           (unsigned long long) ((working_set_sum_lines / working_set_num_windows) * BYTES_PER_CACHE_LINE) >> 10,
+           (unsigned long long) (working_set_sum_pages / working_set_num_windows),
+           (unsigned long long) ((working_set_sum_pages / working_set_num_windows) * WORKING_SET_PAGE_SIZE_IN_BYTES) >> 10,
+           working_set_peak_lines, (working_set_peak_lines * BYTES_PER_CACHE_LINE) >> 10,
+           working_set_peak_pages, (working_set_peak_pages * WORKING_SET_PAGE_SIZE_IN_BYTES) >> 10);
+}
@@ -0,0 +1,91 @@
+/************************************************************
+
+    Working-set size estimator.
+
+The estimator divides the stream of memory accesses into
+consecutive, non-overlapping (tumbling) windows and counts, for
+each window, the number of distinct cache lines and distinct 4KB
+pages that were touched. Exact bitmaps over the main-memory
+address space are used, so the counts are exact.
+
+At the end of each window, one line of a time series is written
+to the output file, along with the number of L1 and L2 misses
+that occurred during the window:
+
+  window,end_access,lines,pages,line_bytes,page_bytes,l1_misses,l2_misses
+
+************************************************************/
+
+//A window is either a fixed number of memory accesses or a
+//fixed number of clock interrupts (i.e. calls to
+//memory_handle_clock_interrupt()), which serve as the simulated
+//notion of time.
+#define WORKING_SET_WINDOW_ACCESSES 0
+#define WORKING_SET_WINDOW_CLOCK_TICKS 1
+
+#define WORKING_SET_PAGE_SIZE_IN_BYTES 4096
+
+//Set to TRUE by working_set_initialize(). memory_subsystem.c only
+//feeds the estimator when this is set. When used with the memory
+//subsystem, enable the estimator with memory_enable_working_set(),
+//so that L1 hits are recorded too.
+extern BOOL working_set_enabled;
+
+
+/************************************************************
+
+            working_set_initialize()
+
+This procedure allocates the bitmaps and enables the estimator.
+The parameters are:
+
+memory_size_in_bytes: the size of main memory, which bounds the
+               addresses that will be seen.
+
+window_unit: WORKING_SET_WINDOW_ACCESSES or
+             WORKING_SET_WINDOW_CLOCK_TICKS.
+
+window_length: the number of accesses (or clock interrupts) per
+               window.
+
+output: the file the time series is written to.
+
+************************************************************/
+
+void working_set_initialize(uint32_t memory_size_in_bytes, uint8_t window_unit,
+			    uint32_t window_length, FILE *output);
+
+
+/************************************************************
+
+            working_set_access()
+
+This procedure records one access to the specified address.
+
+************************************************************/
+
+void working_set_access(uint32_t address);
+
+
+/************************************************************
+
+            working_set_clock_tick()
+
+This procedure is called on each clock interrupt.
+
+************************************************************/
+
+void working_set_clock_tick();
+
+
+/************************************************************
+
+            working_set_report()
+
+This procedure emits the (partial) current window, if it
+contains any accesses, and prints the average and peak working
+set sizes over all windows.
+
+************************************************************/
+
+void working_set_report();